@@ -0,0 +1,87 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "Varbitrators_per_bit.h"
+#include "Varbitrators_word_wide.h"
+#include "verilated.h"
+
+// Measures how many eval() calls per second the output arbitrators sustain
+// when their inputs change every evaluation, as they do on the GPIO path.
+// Both the word-wide arbitrators in src/ and the per-bit loops they replaced
+// (bench/arbitrators.sv) are verilated into this binary, so one run gives
+// before and after rates on the same stimulus. The checksums have to match.
+
+namespace {
+
+// Pre-generated so the RNG isn't part of the measurement
+uint32_t stimulus[256][8];
+
+struct Result {
+    double evals_per_second;
+    uint32_t checksum;
+};
+
+template <typename Model>
+Result run(Model &uut, uint64_t iterations) {
+    uint32_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t n = 0; n < iterations; n++) {
+        const uint32_t *row = stimulus[n & 0xFF];
+        for (int i = 0; i < 4; i++) {
+            uut.fsm_output[i] = row[i];
+            uut.fsm_drive[i] = row[4 + i];
+            uut.core_output[i] = row[i];
+            uut.core_drive[i] = row[4 + i];
+        }
+        uut.eval();
+        checksum ^= uut.fsm_core_output ^ uut.gpio_output;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    uut.final();
+    return {iterations / std::chrono::duration<double>(end - start).count(), checksum};
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Verilated::commandArgs(argc, argv);
+
+    const uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 10'000'000;
+
+    std::mt19937 rng(1234);
+    for (auto &row : stimulus) {
+        for (auto &word : row) {
+            word = rng();
+        }
+    }
+
+    // Core c owns pins 8c to 8c+7 in both
+    Varbitrators_per_bit *per_bit = new Varbitrators_per_bit;
+    for (int pin = 0; pin < 32; pin++) {
+        per_bit->core_select[pin] = pin / 8;
+    }
+    Varbitrators_word_wide *word_wide = new Varbitrators_word_wide;
+    for (int i = 0; i < 4; i++) {
+        word_wide->core_select[i] = 0xFFu << (8 * i);
+    }
+
+    const Result before = run(*per_bit, iterations);
+    const Result after = run(*word_wide, iterations);
+    std::printf("%-10s %12s  %s\n", "", "M evals/s", "checksum");
+    std::printf("%-10s %12.2f  %08x\n", "per-bit", before.evals_per_second / 1e6, before.checksum);
+    std::printf("%-10s %12.2f  %08x\n", "word-wide", after.evals_per_second / 1e6, after.checksum);
+    std::printf("speedup %.2fx over %llu evals\n", after.evals_per_second / before.evals_per_second,
+        static_cast<unsigned long long>(iterations));
+
+    delete per_bit;
+    delete word_wide;
+
+    if (before.checksum != after.checksum) {
+        std::fprintf(stderr, "arbitrator_bench: the two formulations disagree\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Tops for arbitrator_bench, each verilated as its own model so one binary
+// can time both formulations of the output arbitrators.
+
+// The arbitrators in src/, word-wide masks with one-hot core select
+module arbitrators_word_wide(
+    input logic [31:0] fsm_output [3:0],
+    input logic [31:0] fsm_drive [3:0],
+    output logic [31:0] fsm_core_output,
+    output logic [31:0] fsm_core_drive,
+    input logic [31:0] core_select [3:0],
+    input logic [31:0] core_output [3:0],
+    input logic [31:0] core_drive [3:0],
+    output logic [31:0] gpio_output,
+    output logic [31:0] gpio_drive
+);
+
+    fsm_output_arbitrator fsm_output_arbitrator(
+        .fsm_output(fsm_output),
+        .fsm_drive(fsm_drive),
+        .core_output(fsm_core_output),
+        .core_drive(fsm_core_drive)
+    );
+
+    core_output_arbitrator core_output_arbitrator(
+        .core_select(core_select),
+        .core_output(core_output),
+        .core_drive(core_drive),
+        .gpio_output(gpio_output),
+        .gpio_drive(gpio_drive)
+    );
+
+endmodule
+
+// The per-bit loops the arbitrators used before, with a 2-bit core index per
+// pin, kept as the baseline
+module arbitrators_per_bit(
+    input logic [31:0] fsm_output [3:0],
+    input logic [31:0] fsm_drive [3:0],
+    output logic [31:0] fsm_core_output,
+    output logic [31:0] fsm_core_drive,
+    input logic [1:0] core_select [31:0],
+    input logic [31:0] core_output [3:0],
+    input logic [31:0] core_drive [3:0],
+    output logic [31:0] gpio_output,
+    output logic [31:0] gpio_drive
+);
+
+    fsm_output_arbitrator_per_bit fsm_output_arbitrator(
+        .fsm_output(fsm_output),
+        .fsm_drive(fsm_drive),
+        .core_output(fsm_core_output),
+        .core_drive(fsm_core_drive)
+    );
+
+    core_output_arbitrator_per_bit core_output_arbitrator(
+        .core_select(core_select),
+        .core_output(core_output),
+        .core_drive(core_drive),
+        .gpio_output(gpio_output),
+        .gpio_drive(gpio_drive)
+    );
+
+endmodule
+
+module fsm_output_arbitrator_per_bit(
+    input logic [31:0] fsm_output [3:0],
+    input logic [31:0] fsm_drive [3:0],
+    output logic [31:0] core_output,
+    output logic [31:0] core_drive
+);
+
+integer i;
+always @(*) begin
+    // For each bit in the output, check if any of the FSMs are driving it
+    // Lowest index FSM gets priority, so if multiple FSMs are driving the same bit,
+    // the lowest index FSM will be selected.
+    for (i = 0; i < 32; i = i + 1) begin
+        if (fsm_drive[0][i]) begin
+            core_drive[i] = 1;
+            core_output[i] = fsm_output[0][i];
+        end else if (fsm_drive[1][i]) begin
+            core_drive[i] = 1;
+            core_output[i] = fsm_output[1][i];
+        end else if (fsm_drive[2][i]) begin
+            core_drive[i] = 1;
+            core_output[i] = fsm_output[2][i];
+        end else if (fsm_drive[3][i]) begin
+            core_drive[i] = 1;
+            core_output[i] = fsm_output[3][i];
+        end else begin
+            core_drive[i] = 0;
+            core_output[i] = 0;
+        end
+    end
+end
+
+endmodule
+
+module core_output_arbitrator_per_bit(
+    input logic [1:0] core_select [31:0],
+    input logic [31:0] core_output [3:0],
+    input logic [31:0] core_drive [3:0],
+    output logic [31:0] gpio_output,
+    output logic [31:0] gpio_drive
+);
+
+// Select which core drives gpio
+integer i;
+always @(*) begin
+    for (i = 0; i < 32; i = i + 1) begin
+        gpio_output[i] = core_output[core_select[i]][i];
+        gpio_drive[i] = core_drive[core_select[i]][i];
+    end
+end
+
+endmodule
@@ -0,0 +1,360 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Vpio_chip.h"
+#include "Vpio_chip___024root.h"
+#include "verilated.h"
+
+#include "pio_asm.h"
+#include "pio_bus.h"
+#include "pio_coverage.h"
+
+// Runs the classic pico-examples PIO programs on SM0 of core 0 and reports,
+// per program:
+// - bits/cycle: payload bits moved through the FIFOs (both directions) per clock
+// - stall cycles: SM0's TX + RX stall counters
+// - cycles/s: simulated clocks per wall-clock second, including the host side
+//
+// The host keeps the TX FIFO topped up and drains the RX FIFO every cycle, and
+// input programs get a synthetic waveform on their pins. Simulation is
+// deterministic, so bits/cycle and stall cycles only move when the RTL does.
+// They're compared against a baseline file:
+//
+//     protocol_bench [--cycles N] [--baseline FILE] [--write-baseline FILE] [--coverage FILE]
+//
+// --baseline exits non-zero if any program's bits/cycle dropped, its stall
+// cycles rose, or the baseline has no entry for it. Programs use whatever the
+// RTL implements at the time. Each workload lists the pieces it relies on that
+// the RTL doesn't have yet (IN, OUT/SET to pins, side-set, delays, WAIT PIN),
+// and its row says so: until they land its bits/cycle tracks the RTL, not the
+// protocol. A program whose IN is a no-op moves no RX data at all, and one
+// whose delays are ignored runs faster than the real protocol would.
+//
+// --coverage saves SM0's functional coverage over every program (see
+// pio_coverage.h); sampling it slows the cycles/s figures down.
+
+namespace {
+
+constexpr auto kUartTx = pio_asm::assemble<R"(
+.program uart_tx
+.side_set 1 opt
+    pull       side 1 [7]
+    set x, 7   side 0 [7]
+bitloop:
+    out pins, 1
+    jmp x-- bitloop   [6]
+)">();
+
+constexpr auto kUartRx = pio_asm::assemble<R"(
+.program uart_rx_mini
+    wait 0 pin 0
+    set x, 7 [10]
+bitloop:
+    in pins, 1
+    jmp x-- bitloop [6]
+)">();
+
+constexpr auto kSpi = pio_asm::assemble<R"(
+.program spi_cpha0
+.side_set 1
+    out pins, 1 side 0 [1]
+    in pins, 1  side 1 [1]
+)">();
+
+constexpr auto kI2c = pio_asm::assemble<R"(
+.program i2c
+.side_set 1 opt pindirs
+do_nack:
+    jmp y-- entry_point
+    irq wait 0 rel
+do_byte:
+    set x, 7
+bitloop:
+    out pindirs, 1         [7]
+    nop             side 1 [2]
+    wait 1 pin, 1          [4]
+    in pins, 1             [7]
+    jmp x-- bitloop side 0 [7]
+    out pindirs, 1         [7]
+    nop             side 1 [7]
+    wait 1 pin, 1          [7]
+    jmp pin do_nack side 0 [2]
+entry_point:
+.wrap_target
+    out x, 6
+    out y, 1
+    jmp !x do_byte
+    out null, 32
+do_exec:
+    out exec, 16
+    jmp x-- do_exec
+.wrap
+)">();
+
+constexpr auto kWs2812 = pio_asm::assemble<R"(
+.program ws2812
+.side_set 1
+.wrap_target
+bitloop:
+    out x, 1       side 0 [2]
+    jmp !x do_zero side 1 [1]
+do_one:
+    jmp bitloop    side 1 [4]
+do_zero:
+    nop            side 0 [4]
+.wrap
+)">();
+
+// Jump table on {previous, current} A/B state, count kept in Y
+constexpr auto kQuadrature = pio_asm::assemble<R"(
+.program quadrature_encoder
+.origin 0
+    jmp update
+    jmp decrement
+    jmp increment
+    jmp update
+    jmp increment
+    jmp update
+    jmp update
+    jmp decrement
+    jmp decrement
+    jmp update
+    jmp update
+    jmp increment
+    jmp update
+    jmp increment
+    jmp decrement
+    jmp update
+decrement:
+    jmp y-- update
+update:
+    mov isr, y
+    push noblock
+sample_pins:
+    out isr, 2
+    in pins, 2
+    mov osr, isr
+    mov pc, isr
+increment:
+    mov x, !y
+    jmp x-- increment_cont
+increment_cont:
+    mov y, !x
+    jmp update
+)">();
+
+constexpr auto kLogicAnalyser = pio_asm::assemble<R"(
+.program logic_analyser
+.wrap_target
+    in pins, 8
+.wrap
+)">();
+
+// SHIFTCTRL fields
+constexpr uint32_t kAutopush = 1u << 16;
+constexpr uint32_t kAutopull = 1u << 17;
+constexpr uint32_t kInShiftRight = 1u << 18;
+constexpr uint32_t kOutShiftRight = 1u << 19;
+constexpr uint32_t push_thresh(unsigned bits) { return (bits & 0x1F) << 20; }
+constexpr uint32_t pull_thresh(unsigned bits) { return (bits & 0x1F) << 25; }
+
+// 8 clocks per bit: start, 8 data bits LSB first, stop, then a bit of idle
+uint32_t uart_rx_pins(uint64_t cycle) {
+    const uint64_t bit = cycle / 8 % 12;
+    const uint8_t byte = static_cast<uint8_t>(cycle / 96);
+    if (bit == 0) return 0;
+    if (bit <= 8) return byte >> (bit - 1) & 1;
+    return 1;
+}
+
+uint32_t spi_pins(uint64_t cycle) { return cycle >> 2 & 1; }
+
+// SCL (pin 1) never stretched, SDA (pin 0) always ACKs
+uint32_t i2c_pins(uint64_t) { return 0b10; }
+
+// One quadrature step every 32 clocks, always in the same direction
+uint32_t quadrature_pins(uint64_t cycle) {
+    static constexpr uint32_t kGray[] = {0b00, 0b01, 0b11, 0b10};
+    return kGray[cycle / 32 % 4];
+}
+
+uint32_t logic_analyser_pins(uint64_t cycle) { return static_cast<uint32_t>(cycle * 0x9E3779B1u >> 24); }
+
+struct Workload {
+    std::string name;
+    std::vector<uint16_t> program;
+    uint8_t wrap_target, wrap;
+    uint32_t shiftctrl;
+    unsigned bits_per_word; // Payload bits carried by each FIFO word
+    bool tx, rx; // Host keeps the TX FIFO full / drains the RX FIFO
+    const char *unimplemented; // What it needs that the RTL lacks, nullptr for nothing
+    uint32_t (*pins)(uint64_t cycle); // Input waveform, nullptr for none
+};
+
+template <typename Program>
+Workload workload(std::string name, const Program &program, uint32_t shiftctrl, unsigned bits_per_word, bool tx,
+    bool rx, const char *unimplemented, uint32_t (*pins)(uint64_t) = nullptr) {
+    return {std::move(name), {program.instructions.begin(), program.instructions.end()}, program.wrap_target,
+        program.wrap, shiftctrl, bits_per_word, tx, rx, unimplemented, pins};
+}
+
+struct Result {
+    double bits_per_cycle;
+    uint64_t stall_cycles;
+    double cycles_per_second;
+};
+
+Result run(const Workload &w, uint64_t cycles, pio_coverage::Coverage *coverage) {
+    Vpio_chip chip;
+    PioBus<Vpio_chip> bus(chip);
+    bus.reset();
+
+    bus.load(0, 0, w.program.data(), w.program.size());
+    bus.write(0, pio_regs::sm_reg(0, pio_regs::kSmExecctrl), w.wrap << 12 | w.wrap_target << 7);
+    bus.write(0, pio_regs::sm_reg(0, pio_regs::kSmShiftctrl), w.shiftctrl);
+    bus.write(0, pio_regs::kPerfCtrl, 1u << 8); // Clear SM0's counters
+    bus.write(0, pio_regs::kCtrl, 1); // SM_ENABLE for SM0
+
+    uint64_t pushed = 0;
+    uint64_t popped = 0;
+    uint32_t data = 0x5A5A5A5A;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t cycle = 0; cycle < cycles; cycle++) {
+        if (w.pins) chip.gpio = w.pins(cycle);
+
+        const uint32_t fstat = bus.read(0, pio_regs::kFstat);
+        if (w.tx && !(fstat & pio_regs::fstat_tx_full(0))) {
+            chip.reg_write_addr = pio_regs::chip_addr(0, pio_regs::txf(0));
+            chip.reg_data_in = data;
+            chip.reg_write_en = 1;
+            data = data * 1103515245u + 12345u;
+            pushed++;
+        }
+        if (w.rx && !(fstat & pio_regs::fstat_rx_empty(0))) {
+            chip.reg_read_addr = pio_regs::chip_addr(0, pio_regs::rxf(0));
+            chip.reg_read_en = 1;
+            popped++;
+        }
+        bus.tick();
+        chip.reg_write_en = 0;
+        chip.reg_read_en = 0;
+
+        if (coverage) {
+            coverage->sample(pio_trace::State::from_words(chip.rootp->pio_chip__DOT__trace[0].data()));
+            const uint32_t flevel = bus.read(0, pio_regs::kFlevel);
+            coverage->sample_levels(pio_regs::flevel_tx(flevel, 0), pio_regs::flevel_rx(flevel, 0));
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    const uint64_t consumed = pushed - pio_regs::flevel_tx(bus.read(0, pio_regs::kFlevel), 0);
+    bus.snapshot_perf(0);
+    const uint64_t stalls = bus.perf(0, 0, pio_regs::kTxStall) + bus.perf(0, 0, pio_regs::kRxStall);
+    chip.final();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    return {static_cast<double>((consumed + popped) * w.bits_per_word) / cycles, stalls, cycles / seconds};
+}
+
+struct Baseline {
+    double bits_per_cycle;
+    uint64_t stall_cycles;
+};
+
+// Lines of "name bits_per_cycle stall_cycles", # starts a comment
+std::map<std::string, Baseline> read_baseline(const char *path) {
+    std::map<std::string, Baseline> out;
+    std::ifstream file(path);
+    if (!file) {
+        std::fprintf(stderr, "protocol_bench: can't read %s\n", path);
+        std::exit(2);
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        Baseline b;
+        if (fields >> name >> b.bits_per_cycle >> b.stall_cycles) out[name] = b;
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Verilated::commandArgs(argc, argv);
+
+    uint64_t cycles = 100'000;
+    const char *baseline_path = nullptr;
+    const char *write_path = nullptr;
+    const char *coverage_path = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "--cycles")) cycles = std::strtoull(argv[i + 1], nullptr, 0);
+        else if (!std::strcmp(argv[i], "--baseline")) baseline_path = argv[i + 1];
+        else if (!std::strcmp(argv[i], "--write-baseline")) write_path = argv[i + 1];
+        else if (!std::strcmp(argv[i], "--coverage")) coverage_path = argv[i + 1];
+    }
+
+    const std::vector<Workload> workloads = {
+        workload("uart_tx", kUartTx, kOutShiftRight, 8, true, false, "OUT PINS, side-set, delays"),
+        workload("uart_rx", kUartRx, kAutopush | kInShiftRight | push_thresh(8), 8, false, true,
+            "WAIT PIN, IN, delays", uart_rx_pins),
+        workload("spi", kSpi, kAutopull | kAutopush | pull_thresh(8) | push_thresh(8), 8, true, true,
+            "IN, OUT PINS, side-set, delays", spi_pins),
+        workload("i2c", kI2c, kAutopull | kAutopush | pull_thresh(16) | push_thresh(8), 8, true, true,
+            "IN, OUT PINDIRS, WAIT PIN, side-set, delays", i2c_pins),
+        workload("ws2812", kWs2812, kAutopull | pull_thresh(24), 24, true, false, "side-set, delays"),
+        // push noblock sends Y whatever the pins do
+        workload("quadrature", kQuadrature, 0, 32, false, true, "IN, OUT ISR", quadrature_pins),
+        workload("logic_analyser", kLogicAnalyser, kAutopush | kInShiftRight | push_thresh(32), 32, false, true,
+            "IN", logic_analyser_pins),
+    };
+
+    std::map<std::string, Baseline> baseline;
+    if (baseline_path) baseline = read_baseline(baseline_path);
+
+    std::FILE *out = write_path ? std::fopen(write_path, "w") : nullptr;
+    if (out) std::fprintf(out, "# name bits_per_cycle stall_cycles, from protocol_bench --cycles %llu\n",
+        static_cast<unsigned long long>(cycles));
+
+    pio_coverage::Coverage coverage;
+    bool regressed = false;
+    std::printf("%-16s %12s %14s %14s\n", "program", "bits/cycle", "stall cycles", "cycles/s");
+    for (const Workload &w : workloads) {
+        const Result r = run(w, cycles, coverage_path ? &coverage : nullptr);
+        std::printf("%-16s %12.5f %14llu %14.0f", w.name.c_str(), r.bits_per_cycle,
+            static_cast<unsigned long long>(r.stall_cycles), r.cycles_per_second);
+
+        auto it = baseline.find(w.name);
+        if (it != baseline.end()) {
+            const Baseline &b = it->second;
+            const bool slower = r.bits_per_cycle < b.bits_per_cycle - 1e-5;
+            const bool stalls = r.stall_cycles > b.stall_cycles;
+            std::printf("  (baseline %.5f, %llu)%s", b.bits_per_cycle,
+                static_cast<unsigned long long>(b.stall_cycles), slower || stalls ? " REGRESSED" : "");
+            regressed |= slower || stalls;
+        } else if (baseline_path) {
+            // A program the baseline doesn't cover can't pass the check
+            std::printf("  (no baseline) MISSING");
+            regressed = true;
+        }
+        if (w.unimplemented) std::printf("  [RTL lacks %s]", w.unimplemented);
+        std::printf("\n");
+
+        if (out) std::fprintf(out, "%s %.5f %llu\n", w.name.c_str(), r.bits_per_cycle,
+            static_cast<unsigned long long>(r.stall_cycles));
+    }
+
+    if (out) std::fclose(out);
+    if (coverage_path) coverage.save(coverage_path);
+    return regressed ? 1 : 0;
+}
@@ -0,0 +1,22 @@
+// libFuzzer target: runs each input on the verilated fsm and on tb/fsm_model.h
+// and traps on the first divergence. See tb/fsm_diff.h for the input format.
+//
+//     ./build/bin/fsm_fuzz -max_len=512 corpus/
+
+#include <cstdio>
+
+#include "Vtest_wrapper.h"
+#include "fsm_diff.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    // Built once and reset for every input
+    static Vtest_wrapper *uut = new Vtest_wrapper;
+    static FsmDiff<Vtest_wrapper> diff(*uut);
+
+    const std::string divergence = diff.run(data, size);
+    if (!divergence.empty()) {
+        std::fprintf(stderr, "fsm_fuzz: %s\n", divergence.c_str());
+        __builtin_trap();
+    }
+    return 0;
+}
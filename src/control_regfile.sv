@@ -11,18 +11,27 @@ module control_regfile(
     input fdebug_reg_in_t fdebug_in,
     input flevel_reg_in_t flevel_in,
     input irq_reg_in_t irq_in,
+    output logic [7:0] irq_flags, // IRQ reg
     output logic [31:0] gpio_sync_bypass, // INPUT_SYNC_BYPASS reg
     input logic [31:0] dbg_padout, // DBG_PADOUT reg
     input logic [31:0] dbg_padoe, // DBG_PADOE reg
     output logic [31:8] fsm_clkdiv [3:0], // SMx_CLKDIV reg
     output logic [31:0] fsm_execctrl [3:0], // SMx_EXECCTRL reg
-    output logic [31:16] fsm_shiftctrl [3:0], // SMx_SHIFTCTRL reg
+    output logic [31:14] fsm_shiftctrl [3:0], // SMx_SHIFTCTRL reg
     input logic [4:0] current_addr [3:0], // SMx_ADDR reg
     input logic [15:0] current_instr [3:0], // SMx_INSTR reg
     output logic [15:0] fsm_instr [3:0], // SMx_INSTR reg
     output logic [3:0] fsm_instr_flag, // Flag gets set when SMx_INSTR is written to
     output logic [31:0] fsm_pinctrl [3:0], // SMx_PINCTRL reg
-    input intr_reg_in_t intr_in
+    input intr_reg_in_t intr_in,
+    input perf_reg_in_t perf_in,
+    input sync_reg_in_t sync_in, // Chip-level SYNC_TRIGGER, see pio_chip
+    output instr_bank_out_t instr_bank_out, // INSTR_BANK reg
+    input logic instr_bank_active, // INSTR_BANK reg
+    input logic instr_bank_swap, // The instruction banks swap on this clock
+    input logic [31:0] rx_entries [3:0][0:3], // RXFx_PUTGETy reg
+    output logic [3:0] rxf_put_en, // RXFx_PUTGETy reg, write to SM x's RX FIFO entry rxf_put_index
+    output logic [1:0] rxf_put_index
     );
 
     // RW - Processor can read/write
@@ -42,6 +51,7 @@ module control_regfile(
     logic [31:0] fdebug;                      // 0x008 - WC
     logic [31:0] flevel;                      // 0x00C - RO
     logic [31:0] irq;                         // 0x030 - WC
+    // IRQ_FORCE (sets irq bits)              // 0x034 - WF
     logic [31:0] input_sync_bypass;           // 0x038 - RW
     // DBG_PADOUT (dbg_padout input)          // 0x03C - RO
     // DBG_PADOE (dbg_padoe input)            // 0x040 - RO
@@ -56,37 +66,96 @@ module control_regfile(
     logic [31:0] irq0_inte, irq1_inte;        // 0x12C, 0x138 - RW
     logic [31:0] irq0_intf, irq1_intf;        // 0x130, 0x13C - RW
     logic [31:0] irq0_ints, irq1_ints;        // 0x134, 0x140 - RO
+    // PERF_CTRL (snapshot/clear strobes)     // 0x144 - SC
+    logic [31:0] perf_snapshot [0:3][0:4];    // 0x148 - 0x194 - RO
+    logic [31:0] instr_bank;                  // 0x198 - RW/RO/SC
+    // RXFx_PUTGETy (rx_entries inputs)       // 0x19C - 0x1D8 - RWF
+
+    // Performance counters
+    // Each SM has five free-running counters. Writing PERF_CTRL.SNAPSHOT (bit 0)
+    // latches all twenty into perf_snapshot on the same cycle, which is what the
+    // SMx_PERF_* registers read back, so a set of reads is always consistent.
+    // Writing a 1 to PERF_CTRL.CLEAR (bits 11:8) zeroes the counters of that SM.
+    // Counter order within each SM's block of registers:
+    // 0 - instructions retired
+    // 1 - cycles stalled on an empty TX FIFO
+    // 2 - cycles stalled on a full RX FIFO
+    // 3 - cycles stalled on WAIT
+    // 4 - jumps taken
+    // Public so the simulation driver can credit the cycles it skips while
+    // the chip is quiescent, see PioBus::run
+    logic [31:0] perf_count [0:3][0:4] /*verilator public_flat_rw*/;
+    logic perf_ctrl_write;
+
+    assign perf_ctrl_write = write_en && write_addr == 9'h144;
+
+    // Instruction banks
+    // The instruction regfile has an active bank the SMs fetch from and a
+    // shadow bank. INSTR_BANK fields:
+    // 0     ACTIVE (RO) - the bank being executed
+    // 1     SWAP_PENDING (RO) - a swap is waiting for SWAP_SEL's condition
+    // 4     SHADOW_WRITE - INSTR_MEMx writes go to the shadow bank
+    // 9:8   SWAP_SEL - swap on the next clock (0), when SM SWAP_SM wraps (1),
+    //       or when IRQ flag SWAP_IRQ is set (2), which also clears the flag
+    // 13:12 SWAP_SM
+    // 18:16 SWAP_IRQ
+    // 31    SWAP (SC) - write 1 to request a swap. A write without it cancels
+    //       a pending one.
+    // The swap applies to every SM in the core, so a program switched this
+    // way should run on one SM, or on SMs that wrap together.
+    logic instr_bank_write;
+    logic instr_bank_pending;
+
+    assign instr_bank_write = write_en && write_addr == 9'h198;
+
+    // RX FIFO random access
+    // RXFx_PUTGETy (0x19C + 0x10 * x + 4 * y) reads and writes entry y of SM
+    // x's RX FIFO directly. As on the RP2350 the host only gets at the entries
+    // when exactly one of SHIFTCTRL_FJOIN_RX_PUT (bit 15) and FJOIN_RX_GET
+    // (bit 14) is set: it reads what the SM puts, or writes what it gets. With
+    // both set they're the SM's own scratch storage and read back as 0.
+    logic [3:0] rxf_putget_en;
+    logic [8:0] rxf_putget_offset;
+
+    assign rxf_putget_offset = write_addr - 9'h19C;
+    assign rxf_put_index = rxf_putget_offset[3:2];
 
     // HW input and output wire assignments
     assign ctrl_out.clkdiv_restart = ctrl[11:8];
     assign ctrl_out.sm_restart = ctrl[7:4];
     assign ctrl_out.sm_en = ctrl[3:0];
-    assign tx_empty = fstat_in.tx_empty;
-    assign tx_full = fstat_in.tx_full;
-    assign rx_empty = fstat_in.rx_empty;
-    assign rx_full = fstat_in.rx_full;
-    assign flevel_in.rx[3] = flevel[31:28];
-    assign flevel_in.tx[3] = flevel[27:24];
-    assign flevel_in.rx[2] = flevel[23:20];
-    assign flevel_in.tx[2] = flevel[19:16];
-    assign flevel_in.rx[1] = flevel[15:12];
-    assign flevel_in.tx[1] = flevel[11:8];
-    assign flevel_in.rx[0] = flevel[7:4];
-    assign flevel_in.tx[0] = flevel[3:0];
+    assign irq_flags = irq[7:0];
+    assign fstat = {
+        4'b0, fstat_in.tx_empty, 4'b0, fstat_in.tx_full,
+        4'b0, fstat_in.rx_empty, 4'b0, fstat_in.rx_full
+    };
+    assign flevel = {
+        flevel_in.rx[3], flevel_in.tx[3], flevel_in.rx[2], flevel_in.tx[2],
+        flevel_in.rx[1], flevel_in.tx[1], flevel_in.rx[0], flevel_in.tx[0]
+    };
     assign gpio_sync_bypass = input_sync_bypass[31:0];
+    assign instr_bank_out.shadow_write = instr_bank[4];
+    assign instr_bank_out.swap_pending = instr_bank_pending;
+    assign instr_bank_out.swap_sel = swap_sel_t'(instr_bank[9:8]);
+    assign instr_bank_out.swap_sm = instr_bank[13:12];
+    assign instr_bank_out.swap_irq = instr_bank[18:16];
 
     genvar i;
     generate
         for (i = 0; i < 4; i = i + 1) begin
             assign fsm_clkdiv[i] = sm_clkdiv[i][31:8];
             assign fsm_execctrl[i] = sm_execctrl[i];
-            assign fsm_shiftctrl[i] = sm_shiftctrl[i];
+            assign fsm_shiftctrl[i] = sm_shiftctrl[i][31:14];
+            assign rxf_putget_en[i] = sm_shiftctrl[i][15] ^ sm_shiftctrl[i][14];
+            assign rxf_put_en[i] = write_en && write_addr >= 9'h19C && write_addr <= 9'h1D8
+                && rxf_putget_offset[5:4] == 2'(i) && rxf_putget_en[i];
             assign fsm_pinctrl[i] = sm_pinctrl[i];
         end
     endgenerate
     
     // Reads from the RW/RO/WC registers
-    always @(read_addr) begin
+    always @(*) begin
+        data_out = 32'b0;
         case (read_addr)
             9'h000: data_out = ctrl;
             9'h004: data_out = fstat;
@@ -108,7 +177,7 @@ module control_regfile(
             9'h0C8: data_out = sm_clkdiv[0];
             9'h0CC: data_out = sm_execctrl[0];
             9'h0D0: data_out = sm_shiftctrl[0];
-            9'h0D4: data_out[3:0] = current_addr[0];
+            9'h0D4: data_out[4:0] = current_addr[0];
             9'h0D8: data_out[15:0] = current_instr[0];
             9'h0DC: data_out = sm_pinctrl[0];
 
@@ -116,7 +185,7 @@ module control_regfile(
             9'h0E0: data_out = sm_clkdiv[1];
             9'h0E4: data_out = sm_execctrl[1];
             9'h0E8: data_out = sm_shiftctrl[1];
-            9'h0EC: data_out[3:0] = current_addr[1];
+            9'h0EC: data_out[4:0] = current_addr[1];
             9'h0F0: data_out[15:0] = current_instr[1];
             9'h0F4: data_out = sm_pinctrl[1];
 
@@ -124,7 +193,7 @@ module control_regfile(
             9'h0F8: data_out = sm_clkdiv[2];
             9'h0FC: data_out = sm_execctrl[2];
             9'h100: data_out = sm_shiftctrl[2];
-            9'h104: data_out[3:0] = current_addr[2];
+            9'h104: data_out[4:0] = current_addr[2];
             9'h108: data_out[15:0] = current_instr[2];
             9'h10C: data_out = sm_pinctrl[2];
 
@@ -132,7 +201,7 @@ module control_regfile(
             9'h110: data_out = sm_clkdiv[3];
             9'h114: data_out = sm_execctrl[3];
             9'h118: data_out = sm_shiftctrl[3];
-            9'h11C: data_out[3:0] = current_addr[3];
+            9'h11C: data_out[4:0] = current_addr[3];
             9'h120: data_out[15:0] = current_instr[3];
             9'h124: data_out = sm_pinctrl[3];
 
@@ -152,14 +221,53 @@ module control_regfile(
             9'h13C: data_out = irq1_intf;
             9'h140: data_out = irq1_ints;
 
+            // Performance counter snapshots
+            // SM0
+            9'h148: data_out = perf_snapshot[0][0];
+            9'h14C: data_out = perf_snapshot[0][1];
+            9'h150: data_out = perf_snapshot[0][2];
+            9'h154: data_out = perf_snapshot[0][3];
+            9'h158: data_out = perf_snapshot[0][4];
+
+            // SM1
+            9'h15C: data_out = perf_snapshot[1][0];
+            9'h160: data_out = perf_snapshot[1][1];
+            9'h164: data_out = perf_snapshot[1][2];
+            9'h168: data_out = perf_snapshot[1][3];
+            9'h16C: data_out = perf_snapshot[1][4];
+
+            // SM2
+            9'h170: data_out = perf_snapshot[2][0];
+            9'h174: data_out = perf_snapshot[2][1];
+            9'h178: data_out = perf_snapshot[2][2];
+            9'h17C: data_out = perf_snapshot[2][3];
+            9'h180: data_out = perf_snapshot[2][4];
+
+            // SM3
+            9'h184: data_out = perf_snapshot[3][0];
+            9'h188: data_out = perf_snapshot[3][1];
+            9'h18C: data_out = perf_snapshot[3][2];
+            9'h190: data_out = perf_snapshot[3][3];
+            9'h194: data_out = perf_snapshot[3][4];
+
+            9'h198: data_out = {instr_bank[31:2], instr_bank_pending, instr_bank_active};
+
             default: data_out = 32'b0;
         endcase
+
+        // RXFx_PUTGETy
+        for (int i = 0; i < 4; i = i + 1) begin
+            for (int j = 0; j < 4; j = j + 1) begin
+                if (read_addr == 9'h19C + 9'(16 * i + 4 * j) && rxf_putget_en[i]) data_out = rx_entries[i][j];
+            end
+        end
     end
 
     // Writes to the SC registers
     always @(posedge clk or posedge rst) begin
         if (rst) ; // Reset logic handled by RW/WO block
-        ctrl[11:4] <= (data_in[11:4] & {8{(write_addr == 9'h000 & write_en)}});
+        ctrl[11:4] <= (data_in[11:4] & {8{(write_addr == 9'h000 & write_en)}})
+                    | {sync_in.clkdiv_restart, sync_in.sm_restart};
 
         // Not explicit SC Registers, but these flags should be set when the
         // corresponding SMx_INSTR is written to so that the FSM knows to
@@ -170,15 +278,31 @@ module control_regfile(
         fsm_instr_flag[3] <= write_addr == 9'h120 & write_en;
     end
 
+    // INSTR_BANK.SWAP latches SWAP_PENDING until the banks swap
+    always @(posedge clk or posedge rst) begin
+        if (rst) begin
+            instr_bank_pending <= 1'b0;
+        end else if (instr_bank_write) begin
+            instr_bank_pending <= data_in[31];
+        end else if (instr_bank_swap) begin
+            instr_bank_pending <= 1'b0;
+        end
+    end
+
     // Writes to the WC registers
+    // Hardware events are sticky every cycle, the processor clears them by writing a 1
     always @(posedge clk or posedge rst) begin
-        if (rst) ; // Reset logic handled by RW/WO block
-        else if (write_en) begin
+        if (rst) begin
+            fdebug <= 32'b0;
+            irq <= 32'b0;
+        end else begin
             fdebug[27:24] <= (fdebug[27:24] | fdebug_in.tx_stall[3:0]) & ~(data_in[27:24] & {4{(write_addr == 9'h008 & write_en)}});
             fdebug[19:16] <= (fdebug[19:16] | fdebug_in.tx_over[3:0]) & ~(data_in[19:16] & {4{(write_addr == 9'h008 & write_en)}});
             fdebug[11:8] <= (fdebug[11:8] | fdebug_in.rx_under[3:0]) & ~(data_in[11:8] & {4{(write_addr == 9'h008 & write_en)}});
             fdebug[3:0] <= (fdebug[3:0] | fdebug_in.rx_stall[3:0]) & ~(data_in[3:0] & {4{(write_addr == 9'h008 & write_en)}});
-            irq[7:0] <= (irq[7:0] | irq_in.irq_set[7:0]) & ~irq_in.irq_clr[7:0] & ~(data_in[7:0] & {8{(write_addr == 9'h008 & write_en)}});
+            // A state machine clearing a flag wins over one setting it on the same cycle
+            irq[7:0] <= (irq[7:0] | irq_in.irq_set[7:0] | (data_in[7:0] & {8{(write_addr == 9'h034 & write_en)}}))
+                        & ~irq_in.irq_clr[7:0] & ~(data_in[7:0] & {8{(write_addr == 9'h030 & write_en)}});
         end
     end
 
@@ -187,10 +311,6 @@ module control_regfile(
         if (rst) begin
             // TODO - write the default state of all registers
             ctrl <= 32'b0;
-            fstat <= 32'h0F000F00;
-            fdebug <= 32'b0;
-            flevel <= 32'b0;
-            irq <= 32'b0;
             input_sync_bypass <= 32'b0;
             for (int i = 0; i < 4; i = i + 1) begin
                 sm_clkdiv [i] <= 32'h00010000;
@@ -204,6 +324,7 @@ module control_regfile(
             irq1_intf <= 32'b0;
             irq0_ints <= 32'b0;
             irq1_ints <= 32'b0;
+            instr_bank <= 32'b0;
         end else if (write_en) begin
             case (write_addr)
                 9'h000: ctrl[3:0] <= data_in[3:0];
@@ -215,7 +336,7 @@ module control_regfile(
                     sm_execctrl[0][30:7] <= data_in[30:7];
                     sm_execctrl[0][4:0] <= data_in[4:0];
                 end
-                9'h0D0: sm_shiftctrl[0][31:16] <= data_in[31:16];
+                9'h0D0: sm_shiftctrl[0][31:14] <= data_in[31:14];
                 9'h0D8: fsm_instr[0][15:0] <= data_in[15:0];
                 9'h0DC: sm_pinctrl[0] <= data_in;
 
@@ -225,7 +346,7 @@ module control_regfile(
                     sm_execctrl[1][30:7] <= data_in[30:7];
                     sm_execctrl[1][4:0] <= data_in[4:0];
                 end
-                9'h0E8: sm_shiftctrl[1][31:16] <= data_in[31:16];
+                9'h0E8: sm_shiftctrl[1][31:14] <= data_in[31:14];
                 9'h0F0: fsm_instr[1][15:0] <= data_in[15:0];
                 9'h0F4: sm_pinctrl[1] <= data_in;
 
@@ -235,7 +356,7 @@ module control_regfile(
                     sm_execctrl[2][30:7] <= data_in[30:7];
                     sm_execctrl[2][4:0] <= data_in[4:0];
                 end
-                9'h100: sm_shiftctrl[2][31:16] <= data_in[31:16];
+                9'h100: sm_shiftctrl[2][31:14] <= data_in[31:14];
                 9'h108: fsm_instr[2][15:0] <= data_in[15:0];
                 9'h10C: sm_pinctrl[2] <= data_in;
 
@@ -245,7 +366,7 @@ module control_regfile(
                     sm_execctrl[3][30:7] <= data_in[30:7];
                     sm_execctrl[3][4:0] <= data_in[4:0];
                 end
-                9'h118: sm_shiftctrl[3][31:16] <= data_in[31:16];
+                9'h118: sm_shiftctrl[3][31:14] <= data_in[31:14];
                 9'h120: fsm_instr[3][15:0] <= data_in[15:0];
                 9'h124: sm_pinctrl[3] <= data_in;
 
@@ -264,8 +385,49 @@ module control_regfile(
                     irq1_intf[11:0] <= data_in[11:0];
                     irq1_ints[11:0] <= data_in[11:0] | irq0_ints[11:0];
                 end
+
+                9'h198: begin
+                    instr_bank[4] <= data_in[4];
+                    instr_bank[9:8] <= data_in[9:8];
+                    instr_bank[13:12] <= data_in[13:12];
+                    instr_bank[18:16] <= data_in[18:16];
+                end
                 default: ;
             endcase
+        end else if (|sync_in.sm_en || |sync_in.sm_disable) begin
+            // SYNC_TRIGGER lands on the same edge a CTRL write would, and the
+            // chip never forwards a register write on the same cycle
+            ctrl[3:0] <= (ctrl[3:0] | sync_in.sm_en) & ~sync_in.sm_disable;
+        end
+    end
+
+    // Performance counters and snapshots
+    always @(posedge clk or posedge rst) begin
+        if (rst) begin
+            for (int i = 0; i < 4; i = i + 1) begin
+                for (int j = 0; j < 5; j = j + 1) begin
+                    perf_count[i][j] <= 32'b0;
+                    perf_snapshot[i][j] <= 32'b0;
+                end
+            end
+        end else begin
+            for (int i = 0; i < 4; i = i + 1) begin
+                if (perf_ctrl_write && data_in[8 + i]) begin
+                    for (int j = 0; j < 5; j = j + 1) begin
+                        perf_count[i][j] <= 32'b0;
+                    end
+                end else begin
+                    perf_count[i][0] <= perf_count[i][0] + perf_in.retired[i];
+                    perf_count[i][1] <= perf_count[i][1] + perf_in.tx_stall[i];
+                    perf_count[i][2] <= perf_count[i][2] + perf_in.rx_stall[i];
+                    perf_count[i][3] <= perf_count[i][3] + perf_in.wait_stall[i];
+                    perf_count[i][4] <= perf_count[i][4] + perf_in.jump_taken[i];
+                end
+            end
+
+            if (perf_ctrl_write && data_in[0]) begin
+                perf_snapshot <= perf_count;
+            end
         end
     end
 endmodule
\ No newline at end of file
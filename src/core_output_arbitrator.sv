@@ -1,5 +1,5 @@
 module core_output_arbitrator(
-    input logic [1:0] core_select [31:0],
+    input logic [31:0] core_select [3:0], // One-hot per pin: bit i of core_select[c] set means core c owns pin i
     input logic [31:0] core_output [3:0],
     input logic [31:0] core_drive [3:0],
     output logic [31:0] gpio_output,
@@ -7,12 +7,16 @@ module core_output_arbitrator(
 );
 
 // Select which core drives gpio
-integer i;
-always @(*) begin
-    for (i = 0; i < 32; i = i + 1) begin
-        gpio_output[i] = core_output[core_select[i]][i];
-        gpio_drive[i] = core_drive[core_select[i]][i];
-    end
-end
+// The select masks are expected to be disjoint (each pin owned by exactly one core),
+// so the crossbar reduces to a masked OR across the cores.
+assign gpio_output = (core_select[0] & core_output[0])
+                   | (core_select[1] & core_output[1])
+                   | (core_select[2] & core_output[2])
+                   | (core_select[3] & core_output[3]);
 
-endmodule
\ No newline at end of file
+assign gpio_drive = (core_select[0] & core_drive[0])
+                  | (core_select[1] & core_drive[1])
+                  | (core_select[2] & core_drive[2])
+                  | (core_select[3] & core_drive[3]);
+
+endmodule
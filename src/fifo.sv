@@ -1,12 +1,25 @@
 `include "types.svh"
 
-module fifo(
+module fifo #(
+    // First-word-fall-through: the head word is always visible on data_out and
+    // pop_en only advances the read pointer. A word pushed into an empty FIFO
+    // can be popped in the same cycle.
+    parameter bit FWFT = 0
+)(
     input logic rst, clk,
     input logic[31:0] data_in,
     input logic push_en, pop_en,
     output logic [31:0] data_out,
+    output logic data_valid, // FWFT only - data_out holds a word that can be popped this cycle
     output fifo_status status,
-    output logic [2:0] fifo_count // 0-4
+    output logic [2:0] fifo_count, // 0-4
+    // Random access to the storage, for the RX FIFO's FJOIN_RX_PUT/GET modes.
+    // Entries are indexed as stored, not from the head, and a put leaves the
+    // pointers and count alone. A put wins over a push to the same entry.
+    input logic put_en,
+    input logic [1:0] put_index,
+    input logic [31:0] put_data,
+    output logic [31:0] entries [0:3]
 );
 
 assign status.empty = fifo_count == 3'b000;
@@ -17,9 +30,16 @@ logic [31:0] memory [0:3];
 logic [1:0] head, tail;
 
 logic can_push, can_pop;
+logic bypass;
 
-assign can_push = push_en && !status.full;
-assign can_pop = pop_en && !status.empty;
+// In FWFT mode a push into an empty FIFO is visible straight away
+assign bypass = FWFT && status.empty && push_en;
+assign data_valid = !status.empty || bypass;
+
+// A full FIFO still takes a push on a cycle it's popped, into the entry the
+// pop frees
+assign can_push = push_en && (!status.full || can_pop);
+assign can_pop = pop_en && data_valid;
 
 // FIFO memory and pointer logic
 always_ff @(posedge clk or posedge rst) begin
@@ -31,7 +51,6 @@ always_ff @(posedge clk or posedge rst) begin
         // Reset pointers and flags
         head <= 2'b00;
         tail <= 2'b00;
-        data_out <= 32'b0;
     end else begin
         // Push
         if (can_push) begin
@@ -40,12 +59,32 @@ always_ff @(posedge clk or posedge rst) begin
         end
         // Pop
         if (can_pop) begin
-            data_out <= memory[tail];
             tail <= tail + 1;
         end
+        // Put
+        if (put_en) begin
+            memory[put_index] <= put_data;
+        end
     end
 end
 
+assign entries = memory;
+
+// Output logic
+generate
+    if (FWFT) begin : g_fwft_out
+        assign data_out = bypass ? data_in : memory[tail];
+    end else begin : g_registered_out
+        always_ff @(posedge clk or posedge rst) begin
+            if (rst) begin
+                data_out <= 32'b0;
+            end else if (can_pop) begin
+                data_out <= memory[tail];
+            end
+        end
+    end
+endgenerate
+
 // Counter logic
 always_ff @(posedge clk or posedge rst) begin
     if (rst) begin
@@ -61,4 +100,4 @@ always_ff @(posedge clk or posedge rst) begin
     end
 end
 
-endmodule
\ No newline at end of file
+endmodule
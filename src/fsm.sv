@@ -2,70 +2,167 @@
 
 module fsm(
     input logic clk, rst,
+    // CTRL_SM_ENABLE, and the self-clearing CTRL_SM_RESTART
+    input logic enable, restart,
     input logic external_push_en, external_pop_en,
     input logic [31:0] external_data_in,
+    // Host write to RX FIFO entry external_put_index, see rx_put and rx_get
+    input logic external_put_en,
+    input logic [1:0] external_put_index,
     input logic [15:0] instruction,
+    // SMx_INSTR: the host's instruction, and its one-cycle strobe
+    input logic [15:0] external_exec_instr,
+    input logic external_exec_en,
     output logic [4:0] pc,
     output logic [31:0] external_data_out,
+    output logic [31:0] rx_entries [0:3], // RX FIFO storage, for RXFx_PUTGETy
     // Inputs from control_regfile
     input logic out_shiftdir,
     input autopull,
-    input logic [4:0] pull_thresh
+    input logic [4:0] pull_thresh,
+    // SHIFTCTRL_FJOIN_RX_PUT/GET: MOV RXFIFO[], ISR writes the RX FIFO's
+    // entries and MOV OSR, RXFIFO[] reads them
+    input logic rx_put, rx_get,
+    input logic [4:0] wrap_top, wrap_bottom, // Wrap target, and the last instruction before wrapping
+    input logic [4:0] jmp_pin,
+    input logic status_sel, // MOV STATUS compares the RX level rather than the TX level
+    input logic [3:0] status_n,
+    input logic [4:0] in_base, out_base,
+    input logic [5:0] out_count,
+    // Synchronised GPIO inputs
+    input logic [31:0] gpio_input,
+    // This FSM's number within its core, IRQ REL indices are relative to it
+    input logic [1:0] sm_index,
+    // IRQ flags, and the ones IRQ and WAIT IRQ set and clear this cycle
+    input irq_flags_t irq_flags,
+    output irq_flags_t irq_set, irq_clr,
+    // Outputs to control_regfile
+    output fsm_events_t events,
+    output fifo_status tx_status, rx_status,
+    output logic [2:0] tx_fifo_count, rx_fifo_count,
+    // Instruction trace, for the simulation driver
+    output fsm_trace_t trace,
+    // Pin values and directions this FSM is asking for
+    output logic [31:0] pin_output, pin_drive,
+    // Stalled, and stays that way until an input changes
+    output logic quiescent
     );
 
-    logic [4:0] wrap_top, wrap_bottom;
     logic [4:0] jump;
     logic jump_en, pc_en;
 
     // Scratch registers
     logic [31:0] x, y;
 
-    // Remove when control registers are wired up
-    initial begin
-        wrap_top = 5'b00000;
-        wrap_bottom = 5'b11111;
-    end
+    // Input shift register. Only MOV and PUSH use it until IN is implemented,
+    // so the input shift count is always zero.
+    logic [31:0] isr;
+
+    // MOV EXEC: the value moved runs in place of the next instruction
+    logic [15:0] instr;
+    logic [15:0] exec_instr;
+    logic exec_en;
+
+    // SMx_INSTR runs in place of the instruction at pc for one cycle, whether
+    // or not the state machine is enabled. The pc holds for that cycle, and
+    // only a jump the written instruction takes replaces the pc_en and
+    // jump_en the last instruction left, so a running program carries on
+    // where it was. A written instruction that would stall doesn't wait.
+    logic exec_jump_en; // The written instruction takes a jump
+    logic [4:0] exec_jump;
+    logic exec_jumped; // It did on the last edge, so the pc moves even if disabled
+
+    assign instr = external_exec_en ? external_exec_instr : exec_en ? exec_instr : instruction;
+
+    // rst clears everything in the chip. restart puts the state machine back
+    // where rst would, but leaves the instruction memory, the control
+    // registers, the FIFOs, the OSR contents and the output pins alone.
+    // While disabled the state machine holds; the host can still use the FIFOs
+    // and SMx_INSTR.
+    logic step, run;
+    assign step = enable || external_exec_en;
+    assign run = step && !restart;
+
+    // The edge moves the pc
+    logic pc_step;
+    assign pc_step = pc_en && (enable || exec_jumped) && !external_exec_en;
 
-    // The chip in general might need two resets:
-    // 1) One that resets everything including instruction memory and control registers
-    // 2) One that restarts the state machine, etc., but leaves instruction memory and control registers alone.
     program_counter program_counter(
         .clk(clk),
         .rst(rst),
+        .restart(restart),
         .wrap_top(wrap_top),
         .wrap_bottom(wrap_bottom),
         .jump(jump),
         .jump_en(jump_en),
-        .pc_en(pc_en),
+        .pc_en(pc_step),
         .pc(pc)
     );
 
     // FIFO Management
+    // Both FIFOs run first-word-fall-through, so the head word is on the data
+    // output without waiting a cycle for the pop. tx_valid also covers a word
+    // the host is pushing into an empty TX FIFO this cycle.
     logic rx_push_en, tx_pop_en;
     logic [31:0] rx_data_in, tx_data_out;
-    fifo_status tx_status, rx_status;
-    logic [2:0] tx_fifo_count, rx_fifo_count;
+    logic tx_valid, rx_valid;
 
-    fifo rx_fifo(
+    // RX FIFO random access, as on the RP2350. MOV RXFIFO[], ISR and MOV OSR,
+    // RXFIFO[] are PUSH and PULL with bit 4 set, and index the entries with
+    // Y[1:0], or with instr[1:0] when instr[3] is set. Without FJOIN_RX_PUT
+    // (or FJOIN_RX_GET) they do nothing. The ISR isn't cleared, and a put
+    // from the state machine wins over one from the host.
+    logic rx_random; // MOV to or from RXFIFO[]
+    logic [1:0] rx_index;
+    logic rx_put_en;
+    logic [1:0] rx_put_index;
+    logic [31:0] rx_put_data;
+
+    assign rx_random = instr[15:13] == PUSH_PULL && instr[4];
+    assign rx_index = instr[3] ? instr[1:0] : y[1:0];
+
+    always_comb begin
+        if (run && rx_random && !instr[7] && rx_put) begin
+            rx_put_en = 1;
+            rx_put_index = rx_index;
+            rx_put_data = isr;
+        end else begin
+            rx_put_en = external_put_en;
+            rx_put_index = external_put_index;
+            rx_put_data = external_data_in;
+        end
+    end
+
+    fifo #(.FWFT(1)) rx_fifo(
         .clk(clk),
         .rst(rst),
         .data_in(rx_data_in),
         .push_en(rx_push_en),
         .pop_en(external_pop_en),
         .data_out(external_data_out),
+        .data_valid(rx_valid),
         .status(rx_status),
-        .fifo_count(rx_fifo_count)
+        .fifo_count(rx_fifo_count),
+        .put_en(rx_put_en),
+        .put_index(rx_put_index),
+        .put_data(rx_put_data),
+        .entries(rx_entries)
     );
 
-    fifo tx_fifo(
+    fifo #(.FWFT(1)) tx_fifo(
         .clk(clk),
         .rst(rst),
         .data_in(external_data_in),
         .push_en(external_push_en),
         .pop_en(tx_pop_en),
         .data_out(tx_data_out),
+        .data_valid(tx_valid),
         .status(tx_status),
-        .fifo_count(tx_fifo_count)
+        .fifo_count(tx_fifo_count),
+        .put_en(1'b0),
+        .put_index(2'b0),
+        .put_data(32'b0),
+        .entries()
     );
 
     // OSR Management
@@ -79,11 +176,16 @@ module fsm(
     logic [31:0] osr_shift_out;
     // OSR CTRL
     logic osr_load;
+    logic osr_count_clr;
     logic out_shift_en;
+    logic osr_refill; // OUT shifts straight out of the TX FIFO head into an empty OSR
     logic [4:0] out_shift_count; // Instruction[4:0]
     logic [5:0] true_out_shift_count;
 
-    assign out_shift_count = instruction[4:0];
+    logic [6:0] out_shift_counter_next;
+
+    assign out_shift_count = instr[4:0];
+    assign out_shift_counter_next = out_shift_counter + true_out_shift_count;
 
     assign osr_empty = out_shift_counter >= true_pull_thresh;
 
@@ -103,82 +205,162 @@ module fsm(
         .shift_out(osr_shift_out),
         .load(osr_load),
         .shift_en(out_shift_en),
+        .refill(osr_refill),
         .shiftdir(out_shiftdir),
         .shift_count(true_out_shift_count)
     );
 
+    // MOV STATUS: all-ones while the selected FIFO holds fewer than STATUS_N words
+    logic [31:0] status;
+    assign status = {1'b0, status_sel ? rx_fifo_count : tx_fifo_count} < status_n ? '1 : '0;
+
+    // MOV source, after the operation
+    logic [31:0] mov_source;
+    logic [31:0] mov_data;
+
+    always_comb begin
+        case (instr[2:0])
+            MOV_PINS: mov_source = (gpio_input >> in_base) | (gpio_input << (6'd32 - {1'b0, in_base}));
+            MOV_X: mov_source = x;
+            MOV_Y: mov_source = y;
+            MOV_PC: mov_source = status; // STATUS as a source
+            MOV_ISR: mov_source = isr;
+            MOV_OSR: mov_source = osr_data;
+            default: mov_source = 32'b0; // NULL, and the reserved source
+        endcase
+
+        case (instr[4:3])
+            2'b01: mov_data = ~mov_source; // Invert
+            2'b10: begin
+                // Bit-reverse
+                for (int i = 0; i < 32; i = i + 1) mov_data[i] = mov_source[31 - i];
+            end
+            default: mov_data = mov_source;
+        endcase
+    end
+
+    // IRQ flag addressed by IRQ and WAIT IRQ. REL adds the FSM number to the
+    // low two bits of the index, PREV and NEXT pick a neighbouring core.
+    logic [2:0] irq_index;
+    logic irq_flag; // Its value now
+    // IRQ WAIT has set its flag and is waiting for it to clear
+    logic irq_waiting;
+    // WAIT IRQ or IRQ WAIT can't retire this cycle
+    logic irq_blocked;
+    logic [7:0] irq_set_flags, irq_clr_flags;
+
+    always_comb begin
+        irq_index = instr[4:3] == IRQ_REL ? {instr[2], instr[1:0] + sm_index} : instr[2:0];
+        case (instr[4:3])
+            IRQ_PREV: irq_flag = irq_flags.prev[irq_index];
+            IRQ_NEXT: irq_flag = irq_flags.next[irq_index];
+            default: irq_flag = irq_flags.own[irq_index];
+        endcase
+
+        irq_blocked = 0;
+        if (instr[15:13] == WAIT && instr[6:5] == WAIT_IRQ) begin
+            irq_blocked = irq_flag != instr[7];
+        end else if (instr[15:13] == IRQ && !instr[6] && instr[5]) begin
+            // Clear takes priority over Wait
+            irq_blocked = !irq_waiting || irq_flag;
+        end
+
+        // Flags change on the edge that ends this cycle, whichever core they
+        // belong to, so a WAIT on any core sees the change the cycle after
+        irq_set_flags = 8'b0;
+        irq_clr_flags = 8'b0;
+        if (run && instr[15:13] == IRQ) begin
+            if (instr[6]) irq_clr_flags[irq_index] = 1;
+            else if (!(instr[5] && irq_waiting)) irq_set_flags[irq_index] = 1; // IRQ WAIT sets its flag once
+        end else if (run && instr[15:13] == WAIT && instr[6:5] == WAIT_IRQ && instr[7] && irq_flag) begin
+            // WAIT 1 IRQ clears the flag it was waiting for
+            irq_clr_flags[irq_index] = 1;
+        end
+
+        irq_set = '0;
+        irq_clr = '0;
+        case (instr[4:3])
+            IRQ_PREV: begin
+                irq_set.prev = irq_set_flags;
+                irq_clr.prev = irq_clr_flags;
+            end
+            IRQ_NEXT: begin
+                irq_set.next = irq_set_flags;
+                irq_clr.next = irq_clr_flags;
+            end
+            default: begin
+                irq_set.own = irq_set_flags;
+                irq_clr.own = irq_clr_flags;
+            end
+        endcase
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            irq_waiting <= 0;
+        end else if (restart) begin
+            irq_waiting <= 0;
+        end else if (enable && !external_exec_en) begin
+            irq_waiting <= instr[15:13] == IRQ && !instr[6] && instr[5] && irq_blocked;
+        end
+    end
+
+    // JMP condition
+    logic jmp_cond;
+
+    always_comb begin
+        case (instr[7:5])
+            UNCOND: jmp_cond = 1; // Unconditional
+            X_ZERO: jmp_cond = x == 0; // If !X (X zero)
+            X_NZ_DEC: jmp_cond = x != 0; // If X-- (X non-zero prior to decrement), decrement in X, Y logic
+            Y_ZERO: jmp_cond = y == 0; // If !Y (Y zero)
+            Y_NZ_DEC: jmp_cond = y != 0; // If Y-- (Y non-zero prior to decrement), decrement in X, Y logic
+            X_NE_Y: jmp_cond = x != y; // If X!=Y
+            PIN: jmp_cond = gpio_input[jmp_pin]; // If the input pin selected by EXECCTRL_JMP_PIN is high
+            OSR_NOT_EMPTY: jmp_cond = !osr_empty; // If OSR is not empty
+            default: jmp_cond = 0;
+        endcase
+    end
+
+    // JMP and MOV PC, for SMx_INSTR
+    assign exec_jump_en = instr[15:13] == JMP ? jmp_cond : instr[15:13] == MOV && instr[7:5] == MOV_PC;
+    assign exec_jump = instr[15:13] == JMP ? instr[4:0] : mov_data[4:0];
+
     // Logic for: jump, jump_en, pc_en
     always_ff @(posedge clk or posedge rst) begin
         if (rst) begin
             jump <= 5'b0;
             jump_en <= 0;
             pc_en <= 0;
-        end
-        else begin
-            case (instruction[15:13])
+        end else if (restart) begin
+            jump <= 5'b0;
+            jump_en <= 0;
+            pc_en <= 0;
+        end else if (external_exec_en) begin
+            // SMx_INSTR, see exec_jump_en
+            if (exec_jump_en) begin
+                jump <= exec_jump;
+                jump_en <= 1;
+                pc_en <= 1;
+            end
+        end else if (enable) begin
+            case (instr[15:13])
                 JMP: begin
-                    jump <= instruction[4:0];
+                    jump <= instr[4:0];
+                    jump_en <= jmp_cond;
                     pc_en <= 1;
-
-                    case(instruction[7:5])
-                        UNCOND: begin
-                            // Unconditional
-                            jump_en <= 1;
-                        end
-                        X_ZERO: begin
-                            // If !X (X zero)
-                            if (x == 0) jump_en <= 1;
-                            else jump_en <= 0;
-                        end
-                        X_NZ_DEC: begin
-                            // If X-- (X non-zero prior to decrement)
-                            if (x != 0) jump_en <= 1;
-                            else jump_en <= 0;
-                            // Decrement in X, Y logic
-                        end
-                        Y_ZERO: begin
-                            // If !Y (Y zero)
-                            if (y == 0) jump_en <= 1;
-                            else jump_en <= 0;
-                        end
-                        Y_NZ_DEC: begin
-                            // If Y-- (Y non-zero prior to decrement)
-                            if (y != 0) jump_en <= 1;
-                            else jump_en <= 0;
-                            // Decrement in X, Y logic
-                        end
-                        X_NE_Y: begin
-                            // If X!=Y
-                            if (x != y) jump_en <= 1;
-                            else jump_en <= 0;
-                        end
-                        PIN: begin
-                            // If push_en is set
-                            if (1) jump_en <= 1; // TODO - wire up to EXECCTRL_JMP_PIN
-                            else jump_en <= 0;
-                        end
-                        OSR_NOT_EMPTY: begin
-                            // If OSR is not empty
-                            if (!osr_empty) jump_en <= 1;
-                            else jump_en <= 0;
-                        end
-                        default: begin
-                            jump_en <= 0;
-                        end
-                    endcase
                 end
                 WAIT: begin
-                    // Do nothing for now
-                    // We'll pretend it's a no-op instruction for the moment
+                    // TODO - WAIT GPIO and WAIT PIN are still no-ops
                     jump_en <= 0;
-                    pc_en <= 1;
+                    pc_en <= !irq_blocked;
                 end
                 // IN
 
                 // OUT
                 OUT: begin
-                    if (autopull && osr_empty) begin
-                        // STALL
+                    if (autopull && osr_empty && !tx_valid) begin
+                        // STALL until there's a word to refill the OSR with
                         jump_en <= 0;
                         pc_en <= 0;
                     end else begin
@@ -188,10 +370,13 @@ module fsm(
                 end
                 PUSH_PULL: begin
                     jump_en <= 0;
-                    if (!instruction[7]) begin
+                    if (rx_random) begin
+                        // MOV to or from RXFIFO[] never stalls
+                        pc_en <= 1;
+                    end else if (!instr[7]) begin
                         // PUSH
                         if (rx_fifo_count == 4 && !external_pop_en) begin
-                            if (instruction[5]) begin
+                            if (instr[5]) begin
                                 // Block = 1 - stall if RX FIFO is full
                                 pc_en <= 0;
                             end else begin
@@ -204,124 +389,174 @@ module fsm(
                     end
                     else begin
                         // PULL
-                        // We will need similar logic to this for the autopull
-                        if (tx_fifo_count == 0 && !external_push_en) begin
-                            if (instruction[5]) begin
-                                // Block = 1 - stall if TX FIFO is empty
-                                pc_en <= 0;
-                            end else begin
-                                // Block = 0 - pull from empty means copy scratch X to OSR
-                                pc_en <= 1;
-                            end
+                        if (instr[6] && !osr_empty) begin
+                            // IfEmpty = 1 - do nothing unless total output shift count >= pull threshold
+                            pc_en <= 1;
+                        end else if (!tx_valid && instr[5]) begin
+                            // Block = 1 - stall if TX FIFO is empty
+                            pc_en <= 0;
                         end else begin
+                            // Block = 0 - pull from empty means copy scratch X to OSR
                             pc_en <= 1;
                         end
                     end
                 end
 
-                // MOV
+                MOV: begin
+                    if (instr[7:5] == MOV_PC) begin
+                        // Unconditional jump to the value moved
+                        jump <= mov_data[4:0];
+                        jump_en <= 1;
+                        pc_en <= 1;
+                    end else if (instr[7:5] == MOV_EXEC) begin
+                        // Hold the pc for a cycle while the moved instruction runs
+                        jump_en <= 0;
+                        pc_en <= 0;
+                    end else begin
+                        jump_en <= 0;
+                        pc_en <= 1;
+                    end
+                end
 
-                // IRQ
+                IRQ: begin
+                    // Only IRQ WAIT stalls
+                    jump_en <= 0;
+                    pc_en <= !irq_blocked;
+                end
 
                 default: begin
                     jump_en <= 0;
                     pc_en <= 1;
                 end
             endcase
+        end else if (exec_jumped) begin
+            // A disabled state machine has just moved to the target of a
+            // written jump, and starts from there as it would from the wrap
+            // target after a restart
+            jump_en <= 0;
+            pc_en <= 0;
+        end
+    end
+
+    // Stall reasons, registered alongside pc_en so they line up with it
+    logic tx_stall, rx_stall, wait_stall;
+    logic tx_stall_next, rx_stall_next, wait_stall_next;
+    // The program counter held on the last edge, so the instruction being
+    // decoded now is the one that stalled
+    logic pc_held;
+
+    always_comb begin
+        // OUT with autopull, or a blocking PULL, waiting on an empty TX FIFO
+        tx_stall_next = !tx_valid && (
+            (instr[15:13] == OUT && autopull && osr_empty)
+            || (instr[15:13] == PUSH_PULL && !rx_random && instr[7] && instr[5]
+                && !(instr[6] && !osr_empty)));
+        // Blocking PUSH waiting on a full RX FIFO
+        rx_stall_next = instr[15:13] == PUSH_PULL && !rx_random && !instr[7] && instr[5]
+            && rx_fifo_count == 4 && !external_pop_en;
+        // WAIT IRQ, or IRQ WAIT, on a flag that isn't there yet
+        wait_stall_next = irq_blocked;
+    end
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            tx_stall <= 0;
+            rx_stall <= 0;
+            wait_stall <= 0;
+            pc_held <= 0;
+        end else if (restart) begin
+            tx_stall <= 0;
+            rx_stall <= 0;
+            wait_stall <= 0;
+            pc_held <= 0;
+        end else if (enable && !external_exec_en) begin
+            tx_stall <= tx_stall_next;
+            rx_stall <= rx_stall_next;
+            wait_stall <= wait_stall_next;
+            pc_held <= tx_stall || rx_stall || wait_stall;
         end
     end
 
+    // pc_en lags decode by a cycle, so the first stalled cycle can still move
+    // the pc on to a different instruction. Once the pc has held and the
+    // instruction at it has stalled again, pc, the scratch registers and the
+    // OSR are all at a fixed point while the FIFOs and pins stay put. Cycles
+    // aren't quite identical: the performance counter for the stall reason
+    // keeps counting. The reason can't change while the instruction doesn't,
+    // so a driver that skips these cycles adds them to that counter instead,
+    // see PioBus::run.
+    // A disabled state machine is trivially at a fixed point, once any
+    // SMx_INSTR has run.
+    // TODO - also require the clock divider to be idle once it's implemented
+    assign quiescent = !restart && !external_exec_en && !exec_jumped
+                    && (!enable || (pc_held && (tx_stall || rx_stall || wait_stall)
+                    && (tx_stall_next || rx_stall_next || wait_stall_next)));
+
+    // Nothing retires or stalls while disabled
+    assign events.retired = enable && pc_en;
+    assign events.jump_taken = enable && pc_en && jump_en;
+    assign events.tx_stall = enable && tx_stall;
+    assign events.rx_stall = enable && rx_stall;
+    assign events.wait_stall = enable && wait_stall;
+    // The same condition program_counter wraps on
+    assign events.wrapped = pc_step && !restart && !jump_en && pc == wrap_bottom;
+    // Host writes to a full TX FIFO the state machine isn't pulling from, or
+    // reads from an empty RX FIFO
+    assign events.tx_over = external_push_en && tx_status.full && !tx_pop_en;
+    assign events.rx_under = external_pop_en && !rx_valid;
+
+    assign trace.pc = {3'b0, pc};
+    assign trace.instruction = instr;
+    assign trace.flags_unused = 4'b0;
+    assign trace.retired = events.retired;
+    assign trace.wait_stall = wait_stall;
+    assign trace.rx_stall = rx_stall;
+    assign trace.tx_stall = tx_stall;
+    assign trace.x = x;
+    assign trace.y = y;
+    assign trace.osr = osr_data;
+
     // Logic for x, y
     always_ff @(posedge clk or posedge rst) begin
         if (rst) begin
             x <= 32'b0;
             y <= 32'b0;
-        end else begin
-            case (instruction[15:13])
+        end else if (restart) begin
+            x <= 32'b0;
+            y <= 32'b0;
+        end else if (step) begin
+            case (instr[15:13])
                 JMP: begin
-                    if (instruction[7:5] == X_NZ_DEC) begin
+                    if (instr[7:5] == X_NZ_DEC) begin
                         // If X-- (X non-zero prior to decrement)
                         x <= x - 1;
-                    end else if (instruction[7:5] == Y_NZ_DEC) begin
+                    end else if (instr[7:5] == Y_NZ_DEC) begin
                         // If Y-- (Y non-zero prior to decrement)
                         y <= y - 1;
                     end
                 end
                 OUT: begin
-                    if (instruction[7:5] == OUT_X) begin
+                    // Nothing is shifted out while stalled on autopull
+                    if (out_shift_en && instr[7:5] == OUT_X) begin
                         x <= osr_shift_out;
-                    end else if (instruction[7:5] == OUT_Y) begin
+                    end else if (out_shift_en && instr[7:5] == OUT_Y) begin
                         y <= osr_shift_out;
                     end
                 end
                 MOV: begin
-                    if (instruction[7:5] == MOV_X) begin
-                    // If X is the destination
-                        case (instruction[2:0]) // Source
-                            MOV_PINS: begin
-                                // TODO - implement
-                            end
-                            MOV_X: begin
-                                // NOOP
-                            end
-                            MOV_Y: begin
-                                x <= y;
-                            end
-                            MOV_NULL: begin
-                                x <= 32'b0;
-                            end
-                            MOV_EXEC: begin
-                                // TODO - implement
-                            end
-                            MOV_PC: begin
-                                // TODO - implement
-                            end
-                            MOV_ISR: begin
-                                // TODO - implement
-                            end
-                            MOV_OSR: begin
-                                x <= osr_data;
-                            end
-                        endcase
-                    end else if (instruction[7:5] == MOV_Y) begin
-                    // If Y is the destination
-                        case (instruction[2:0]) // Source
-                            MOV_PINS: begin
-                                // TODO - implement
-                            end
-                            MOV_X: begin
-                                y <= x;
-                            end
-                            MOV_Y: begin
-                                // NOOP
-                            end
-                            MOV_NULL: begin
-                                y <= 32'b0;
-                            end
-                            MOV_EXEC: begin
-                                // TODO - implement
-                            end
-                            MOV_PC: begin
-                                // TODO - implement
-                            end
-                            MOV_ISR: begin
-                                // TODO - implement
-                            end
-                            MOV_OSR: begin
-                                y <= osr_data;
-                            end
-                        endcase
-                    end
+                    // Sources and the operation are in mov_data
+                    if (instr[7:5] == MOV_X) x <= mov_data;
+                    else if (instr[7:5] == MOV_Y) y <= mov_data;
                 end
                 SET: begin
-                    case (instruction[7:5])
+                    case (instr[7:5])
                         SET_X: begin
                             x[31:5] <= 27'b0;
-                            x[4:0] <= instruction[4:0];
+                            x[4:0] <= instr[4:0];
                         end
                         SET_Y: begin
                             y[31:5] <= 27'b0;
-                            y[4:0] <= instruction[4:0];
+                            y[4:0] <= instr[4:0];
                         end
                         default: begin
 
@@ -335,150 +570,174 @@ module fsm(
         end
     end
 
-    // Logic for tx_pop_en, rx_push_en, out_shift_en, osr_load, out_shift_counter
-    always_ff @(posedge clk or posedge rst) begin
-        if (rst) begin
-            tx_pop_en <= 0;
-            rx_push_en <= 0;
-            osr_load <= 0;
-            osr_data_in <= 32'b0;
-            out_shift_en <= 0;
-            out_shift_counter <= 6'b0;
-        end else begin
-            case (instruction[15:13])
-                MOV: begin
-                    out_shift_en <= 0;
-                    if (instruction[7:5] == MOV_ISR) begin // Destination
-                        // TODO implement
-                        osr_load <= 0;
+    // Logic for tx_pop_en, rx_push_en, out_shift_en, osr_load, osr_data_in
+    // These are combinational so that the OSR and FIFOs update on the same edge
+    // the instruction executes, rather than a cycle later.
+    always_comb begin
+        tx_pop_en = 0;
+        rx_push_en = 0;
+        osr_load = 0;
+        osr_data_in = 32'b0;
+        osr_count_clr = 0;
+        out_shift_en = 0;
+        osr_refill = 0;
+
+        case (instr[15:13])
+            MOV: begin
+                if (instr[7:5] == MOV_OSR) begin // Destination
+                    // Always counts as a full OSR, even if the value didn't change
+                    osr_data_in = mov_data;
+                    osr_load = 1;
+                    osr_count_clr = 1;
+                end
+            end
+            OUT: begin
+                // Shift count is assigned combinationally
+                if (autopull && osr_empty) begin
+                    // Refill and shift the new word out on the same edge, so
+                    // OUT doesn't lose a cycle once the FIFO has data again.
+                    // Without a word it stalls (implemented in PC logic).
+                    if (tx_valid) begin
+                        tx_pop_en = 1;
+                        osr_data_in = tx_data_out;
+                        osr_refill = 1;
+                        out_shift_en = 1;
                     end
-                    else if (instruction[7:5] == MOV_OSR) begin // Destination
-                        out_shift_counter <= 6'b0;
-                        case (instruction[2:0]) // Source
-                            MOV_PINS: begin
-                                // TODO implement
-                                osr_load <= 0;
-                            end
-                            MOV_X: begin
-                                osr_data_in <= x;
-                                osr_load <= 1;
-                            end
-                            MOV_Y: begin
-                                osr_data_in <= y;
-                                osr_load <= 1;
-                            end
-                            MOV_NULL: begin
-                                osr_data_in <= 32'b0;
-                                osr_load <= 1;
-                            end
-                            MOV_PC: begin
-                                // TODO Implement, based on exectrl_statusctrl
-                                osr_load <= 0;
-                            end
-                            MOV_ISR: begin
-                                // TODO implement
-                                osr_load <= 0;
-                            end
-                            MOV_OSR: begin
-                                // Equivalent to a NOOP
-                                osr_load <= 0;
-                            end
-                            default: begin
-                                osr_load <= 0;
-                            end
-                        endcase
+                end else begin
+                    out_shift_en = 1;
+
+                    // Refill once this OUT reaches the pull threshold
+                    if (autopull && out_shift_counter_next >= true_pull_thresh
+                        && tx_valid) begin
+                        tx_pop_en = 1;
+                        osr_data_in = tx_data_out;
+                        osr_load = 1;
+                        osr_count_clr = 1;
                     end
                 end
-                OUT: begin
-                    // Shift count is assigned combinationally
-                    if (autopull && osr_empty) begin
-                        // STALL (implemented in PC logic)
-                        out_shift_en <= 0;
-                        if (tx_status.empty && !external_push_en) begin
-                            osr_load <= 0;
-                        end
-                        else begin
-                            osr_data_in <= tx_data_out;
-                            osr_load <= 1;
-                            out_shift_counter <= 6'b0;
-                        end
-                    end else begin
-                        osr_load <= 0;
-                        out_shift_en <= 1;
-
-                        if (out_shift_counter + true_out_shift_count >= true_pull_thresh
-                            && !(tx_status.empty && !external_push_en)) begin
-                            osr_data_in <= tx_data_out;
-                            osr_load <= 1;
-                            out_shift_counter <= 6'b0;
-                        end else begin
-                            out_shift_counter <= out_shift_counter + true_out_shift_count;
-                        end
+            end
+            PUSH_PULL: begin
+                if (rx_random) begin
+                    // MOV OSR, RXFIFO[] loads a full OSR. MOV RXFIFO[], ISR
+                    // is the RX FIFO's put, above.
+                    if (instr[7] && rx_get) begin
+                        osr_data_in = rx_entries[rx_index];
+                        osr_load = 1;
+                        osr_count_clr = 1;
                     end
-                end
-                PUSH_PULL: begin
-                    out_shift_en <= 0;
-                    if (!instruction[7]) begin
-                        // PUSH
-                        // TODO - finish implementing
-                        osr_load <= 0;
-                        if (rx_fifo_count == 4 && !external_pop_en) begin
-                            // Can't push to FIFO
-                            rx_push_en <= 0;
-                        end else begin
-                            // Can push to FIFO
-                            if (instruction[6] /* isr_input_shift_counter < pull_thresh */) begin
-                                rx_push_en <= 0;
-                            end else begin
-                                rx_push_en <= 1;
-                            end
-                        end
-                    end
-                    else begin
-                        // PULL
-                        if (tx_status.empty && !external_push_en) begin
-                            // Can't pull from FIFO
-                            tx_pop_en <= 0;
-                            if (instruction[5]) begin
-                                // Block = 1 - pull from empty means stall
-                                osr_load <= 0;
-                            end
-                            else begin
-                                // Block = 0 - pull from empty means copy scratch X to OSR
-                                osr_data_in <= x;
-                                osr_load <= 1;
-                                out_shift_counter <= 6'b0;
-                            end
-                        end else begin
-                            // Can pull from FIFO
-                            if (instruction[6] && osr_empty) begin
-                                // IfEmpty = 1 - do nothing unless total output shift count >= autopull threshold
-                                tx_pop_en <= 0;
-                                osr_load <= 0;
-                            end else begin
-                                // Pull from FIFO as normal
-                                tx_pop_en <= 1;
-                                osr_data_in <= tx_data_out;
-                                osr_load <= 1;
-                                out_shift_counter <= 6'b0;
-                            end
-                        end
+                end else if (!instr[7]) begin
+                    // PUSH
+                    // TODO - finish implementing
+                    if (rx_fifo_count == 4 && !external_pop_en) begin
+                        // Can't push to FIFO
+                    end else if (!instr[6] /* isr_input_shift_counter < pull_thresh */) begin
+                        // Can push to FIFO
+                        rx_push_en = 1;
                     end
                 end
-                default: begin
-                    osr_load <= 0;
-
-                    if (out_shift_counter + true_out_shift_count >= true_pull_thresh
-                            && !(tx_status.empty && !external_push_en)) begin
-                        osr_data_in <= tx_data_out;
-                        osr_load <= 1;
-                        out_shift_counter <= 6'b0;
-                    end else begin
-                        osr_load <= 0;
-                        out_shift_en <= 0;
+                else begin
+                    // PULL
+                    if (instr[6] && !osr_empty) begin
+                        // IfEmpty = 1 - do nothing unless total output shift count >= pull threshold
+                    end else if (tx_valid) begin
+                        // Pull from FIFO as normal
+                        tx_pop_en = 1;
+                        osr_data_in = tx_data_out;
+                        osr_load = 1;
+                        osr_count_clr = 1;
+                    end else if (!instr[5]) begin
+                        // Block = 0 - pull from empty means copy scratch X to OSR
+                        osr_data_in = x;
+                        osr_load = 1;
+                        osr_count_clr = 1;
                     end
+                    // Block = 1 - pull from empty means stall (implemented in PC logic)
                 end
-            endcase
+            end
+            default: begin
+                // Autopull refills an empty OSR in the background
+                if (autopull && osr_empty && tx_valid) begin
+                    tx_pop_en = 1;
+                    osr_data_in = tx_data_out;
+                    osr_load = 1;
+                    osr_count_clr = 1;
+                end
+            end
+        endcase
+
+        // A disabled or restarting state machine leaves the FIFOs and OSR alone
+        if (!run) begin
+            tx_pop_en = 0;
+            rx_push_en = 0;
+            osr_load = 0;
+            osr_count_clr = 0;
+            out_shift_en = 0;
+            osr_refill = 0;
+        end
+    end
+
+    // Logic for isr
+    // PUSH empties the ISR into the RX FIFO
+    assign rx_data_in = isr;
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            isr <= 32'b0;
+        end else if (restart) begin
+            isr <= 32'b0;
+        end else if (run && instr[15:13] == MOV && instr[7:5] == MOV_ISR) begin
+            isr <= mov_data;
+        end else if (rx_push_en) begin
+            isr <= 32'b0;
+        end
+    end
+
+    // Logic for exec_en, exec_instr, exec_jumped
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            exec_en <= 0;
+            exec_instr <= 16'b0;
+            exec_jumped <= 0;
+        end else if (restart) begin
+            exec_en <= 0;
+            exec_instr <= 16'b0;
+            exec_jumped <= 0;
+        end else begin
+            if (step) begin
+                exec_en <= instr[15:13] == MOV && instr[7:5] == MOV_EXEC;
+                exec_instr <= mov_data[15:0];
+            end
+            exec_jumped <= external_exec_en && exec_jump_en;
+        end
+    end
+
+    // Logic for pin_output
+    // MOV PINS writes OUT_COUNT pins from OUT_BASE up, wrapping past pin 31
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            pin_output <= 32'b0;
+        end else if (run && instr[15:13] == MOV && instr[7:5] == MOV_PINS) begin
+            for (int i = 0; i < 32; i = i + 1) begin
+                if (6'(i) < out_count) pin_output[5'(out_base + 5'(i))] <= mov_data[i];
+            end
+        end
+    end
+
+    // TODO - SET PINDIRS and OUT PINDIRS, until then no pin is driven
+    assign pin_drive = 32'b0;
+
+    // Logic for out_shift_counter
+    // The count saturates at 32, the OSR is empty from then on
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            out_shift_counter <= 6'b0;
+        end else if (restart || osr_count_clr) begin
+            out_shift_counter <= 6'b0;
+        end else if (osr_refill) begin
+            // Counting starts over from the word just pulled
+            out_shift_counter <= true_out_shift_count;
+        end else if (out_shift_en) begin
+            out_shift_counter <= out_shift_counter_next > 32 ? 6'd32 : out_shift_counter_next[5:0];
         end
     end
 
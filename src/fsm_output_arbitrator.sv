@@ -5,29 +5,22 @@ module fsm_output_arbitrator(
     output logic [31:0] core_drive
 );
 
-integer i;
-always @(*) begin
-    // For each bit in the output, check if any of the FSMs are driving it
-    // Lowest index FSM gets priority, so if multiple FSMs are driving the same bit,
-    // the lowest index FSM will be selected.
-    for (i = 0; i < 32; i = i + 1) begin
-        if (fsm_drive[0][i]) begin
-            core_drive[i] = 1;
-            core_output[i] = fsm_output[0][i];
-        end else if (fsm_drive[1][i]) begin
-            core_drive[i] = 1;
-            core_output[i] = fsm_output[1][i];
-        end else if (fsm_drive[2][i]) begin
-            core_drive[i] = 1;
-            core_output[i] = fsm_output[2][i];
-        end else if (fsm_drive[3][i]) begin
-            core_drive[i] = 1;
-            core_output[i] = fsm_output[3][i];
-        end else begin
-            core_drive[i] = 0;
-            core_output[i] = 0;
-        end
-    end
-end
+// For each bit in the output, check if any of the FSMs are driving it.
+// Lowest index FSM gets priority, so if multiple FSMs are driving the same bit,
+// the lowest index FSM will be selected.
+// This is done a whole word at a time rather than bit by bit - each FSM only
+// gets the bits that no lower indexed FSM is driving.
+logic [31:0] grant [3:0];
 
-endmodule
\ No newline at end of file
+assign grant[0] = fsm_drive[0];
+assign grant[1] = fsm_drive[1] & ~fsm_drive[0];
+assign grant[2] = fsm_drive[2] & ~(fsm_drive[0] | fsm_drive[1]);
+assign grant[3] = fsm_drive[3] & ~(fsm_drive[0] | fsm_drive[1] | fsm_drive[2]);
+
+assign core_drive = fsm_drive[0] | fsm_drive[1] | fsm_drive[2] | fsm_drive[3];
+assign core_output = (grant[0] & fsm_output[0])
+                   | (grant[1] & fsm_output[1])
+                   | (grant[2] & fsm_output[2])
+                   | (grant[3] & fsm_output[3]);
+
+endmodule
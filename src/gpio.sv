@@ -1,10 +1,11 @@
 module gpio(
     input logic clk, rst,
-    input logic [31:0] sync_bypass, // TODO: Implement
+    input logic [31:0] sync_bypass, // 1 = skip the input synchronizer for that pin
     input logic [31:0] dir, // 0 = input, 1 = output
     input logic [31:0] pde, pue,
     input logic [31:0] out_data,
     output logic [31:0] in_data,
+    output logic settled, // Both synchronizer stages already hold the pad values
     inout logic [31:0] gpio
 );
 
@@ -31,12 +32,24 @@ module gpio(
         end
     endgenerate
 
+    // Input synchronizer
+    // Each pin passes through two flops before it reaches in_data, so a change
+    // on the pad shows up on in_data 2 cycles later. Pins with sync_bypass set
+    // skip both flops and reach in_data combinationally (0 cycles), which is only
+    // safe for inputs that are already synchronous to clk.
+    logic [31:0] sync_stage_1, sync_stage_2;
+
     always @(posedge clk or posedge rst) begin
         if (rst) begin
-            in_data <= 32'b0;
+            sync_stage_1 <= 32'b0;
+            sync_stage_2 <= 32'b0;
         end else begin
-            in_data <= (~dir & gpio);
+            sync_stage_1 <= gpio;
+            sync_stage_2 <= sync_stage_1;
         end
     end
+
+    assign in_data = ~dir & ((sync_bypass & gpio) | (~sync_bypass & sync_stage_2));
+    assign settled = sync_stage_1 == gpio && sync_stage_2 == sync_stage_1;
     
 endmodule
@@ -3,22 +3,39 @@ module instruction_regfile(
     input logic [15:0] instr_in,
     input logic [4:0] write_addr,
     input logic write_en,
-    input logic [4:0] read_addr,
-    output logic [15:0] instr_out
+    // Two banks: the FSMs fetch from the active one, and with shadow_write
+    // set the host fills the other while they run. swap exchanges the two
+    // on the next clock, so the very next fetch comes from the new program.
+    input logic shadow_write,
+    input logic swap,
+    output logic active,
+    // One read port per FSM
+    input logic [4:0] read_addr [3:0],
+    output logic [15:0] instr_out [3:0]
 );
-    
-logic [15:0] registers [31:0];
 
-assign instr_out = registers[read_addr];
+logic [15:0] registers [1:0][31:0];
+
+genvar j;
+generate
+    for (j = 0; j < 4; j = j + 1) begin
+        assign instr_out[j] = registers[active][read_addr[j]];
+    end
+endgenerate
 
 always @(posedge clk or posedge rst) begin
     if (rst) begin
         integer i;
         for (i = 0; i < 32; i = i + 1) begin
-            registers[i] <= 16'b0;  // Reset each register to 0
+            registers[0][i] <= 16'b0;  // Reset each register to 0
+            registers[1][i] <= 16'b0;
+        end
+        active <= 1'b0;
+    end else begin
+        if (write_en) begin
+            registers[active ^ shadow_write][write_addr] <= instr_in;
         end
-    end else if (write_en) begin
-        registers[write_addr] <= instr_in;
+        active <= active ^ swap;
     end
 end
 
@@ -9,11 +9,16 @@ module output_shift_register(
     // CTRL
     input logic load, // Set on MOV, PULL, or autopull
     input logic shift_en, // Set on OUT
+    input logic refill, // Set on OUT with the OSR empty, shift out of data_in rather than the OSR
     input logic shiftdir, // Set by control register 0 = left, 1 = right
     input logic [5:0] shift_count // Set on OUT
 );
 
 logic [31:0] osr_next;
+logic [31:0] osr_shifted;
+logic [31:0] shift_source;
+
+assign shift_source = refill ? data_in : osr;
 
 // Essentially the OSR needs to know whether it is to pull the value
 // from a MOV or PULL instruction, or how many bits to shift out
@@ -24,24 +29,27 @@ always_comb begin
     // Default values
     if (rst) begin
         shift_out = 32'b0;
-        osr_next = 32'b0;
-    end else if (load) begin
-        osr_next = data_in;
-        shift_out = 32'b0;
+        osr_shifted = 32'b0;
     end else if (shift_en) begin
         if (shiftdir) begin
             // Right shift
-            shift_out = (osr << (32 - shift_count)) >> (32 - shift_count);
-            osr_next = osr >> shift_count;
+            shift_out = (shift_source << (32 - shift_count)) >> (32 - shift_count);
+            osr_shifted = shift_source >> shift_count;
         end else begin
             // Left shift
-            shift_out = (osr >> (32 - shift_count));
-            osr_next = osr << shift_count;
+            shift_out = (shift_source >> (32 - shift_count));
+            osr_shifted = shift_source << shift_count;
         end
     end else begin
         shift_out = 32'b0; // No shift operation
-        osr_next = osr; // Keep the current value
+        osr_shifted = osr; // Keep the current value
     end
+
+    // A load wins over the shift, but the shifted out bits are still valid so
+    // an OUT can refill the OSR on the same cycle it empties it.
+    if (rst) osr_next = 32'b0;
+    else if (load) osr_next = data_in;
+    else osr_next = osr_shifted;
 end
 
 always_ff @(posedge clk or posedge rst) begin
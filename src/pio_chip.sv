@@ -1,10 +1,24 @@
+`include "types.svh"
+
 module pio_chip(
     input logic clk, rst,
     output logic [1:0] counter, // TODO - what is this doing here? clock divider?
-    inout logic [31:0] gpio
+    inout logic [31:0] gpio,
+    // Host register bus
+    // TODO - Drive from the SPI controller once it exists
+    // Bits [10:9] of the address select the core, [8:0] are the core's register address.
+    // 0x1F4 - 0x1FC are chip registers and ignore the core bits.
+    input logic [31:0] reg_data_in,
+    input logic [10:0] reg_write_addr, reg_read_addr,
+    input logic reg_write_en, reg_read_en,
+    output logic [31:0] reg_data_out,
+    // Nothing will change until the pins or the host bus do, so the
+    // simulation driver can skip ahead
+    output logic quiescent
 );
 
-    logic [1:0] core_select [31:0];
+    // One-hot pin ownership, one mask per core
+    logic [31:0] core_select [3:0];
 
     logic [31:0] core_0_output, core_1_output, core_2_output, core_3_output;
     logic [31:0] core_0_drive, core_1_drive, core_2_drive, core_3_drive;
@@ -12,18 +26,97 @@ module pio_chip(
     logic [31:0] core_output [3:0];
     logic [31:0] core_drive [3:0];
 
-    logic [31:0] out_data;
+    // Readable from the simulation driver for GPIO capture
+    logic [31:0] out_data /*verilator public_flat_rd*/;
     logic [31:0] sync_bypass;
-    logic [31:0] dir;
+    logic [31:0] dir /*verilator public_flat_rd*/;
+    // Instruction trace, SM x of core y is at index 4 * y + x. Not a port, so
+    // synthesis drops it.
+    fsm_trace_t trace [15:0] /*verilator public_flat_rd*/;
     logic [31:0] pde, pue;
     logic [31:0] in_data;
+    logic [31:0] core_sync_bypass [3:0];
+
+    // Host register bus, split per core
+    logic [3:0] core_write_en, core_read_en;
+    logic [31:0] core_data_out [3:0];
+
+    logic [3:0] core_quiescent;
+    logic gpio_settled;
+
+    // Synchronised start across cores
+    // 0x1F8 SYNC_ARM - RW, one bit per SM, SM x of core y is bit 4 * y + x
+    // 0x1FC SYNC_TRIGGER - WO, bit 0 sets SM_ENABLE, bit 1 clears it, bit 2
+    //       pulses SM_RESTART and bit 3 CLKDIV_RESTART, for every armed SM
+    // The trigger goes into each core's CTRL on the edge a CTRL write would,
+    // so armed SMs on different cores start with zero skew.
+    logic [15:0] sync_arm;
+    logic sync_arm_write, sync_trigger_write, chip_reg_write;
+    sync_reg_in_t sync_in [3:0];
+
+    assign sync_arm_write = reg_write_en && reg_write_addr[8:0] == 9'h1F8;
+    assign sync_trigger_write = reg_write_en && reg_write_addr[8:0] == 9'h1FC;
+    assign chip_reg_write = sync_arm_write || sync_trigger_write;
+
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) sync_arm <= 16'b0;
+        else if (sync_arm_write) sync_arm <= reg_data_in[15:0];
+    end
+
+    always_comb begin
+        for (int i = 0; i < 4; i = i + 1) begin
+            core_write_en[i] = reg_write_en && !chip_reg_write && reg_write_addr[10:9] == 2'(i);
+            core_read_en[i] = reg_read_en && reg_read_addr[10:9] == 2'(i);
+            sync_in[i].sm_en = sync_arm[4 * i +: 4] & {4{sync_trigger_write && reg_data_in[0]}};
+            sync_in[i].sm_disable = sync_arm[4 * i +: 4] & {4{sync_trigger_write && reg_data_in[1]}};
+            sync_in[i].sm_restart = sync_arm[4 * i +: 4] & {4{sync_trigger_write && reg_data_in[2]}};
+            sync_in[i].clkdiv_restart = sync_arm[4 * i +: 4] & {4{sync_trigger_write && reg_data_in[3]}};
+        end
+    end
+
+    // Cross-core IRQ fabric
+    // The cores form a ring 0 -> 1 -> 2 -> 3 -> 0. IRQ and WAIT IRQ with the
+    // RP2350's PREV/NEXT index modes reach the flags of the core before or
+    // after their own. Requests go straight into the target core's IRQ
+    // register, so a flag set on another core lands on the same edge as a
+    // local one: an IRQ executed on cycle n releases a WAIT on any core on
+    // cycle n + 1.
+    // 0x1F4 IRQ_ALL - RO, every core's IRQ flags, core y in bits [8y+7:8y]
+    logic [7:0] core_irq_flags [3:0];
+    irq_reg_in_t irq_to_prev [3:0];
+    irq_reg_in_t irq_to_next [3:0];
+
+    always_comb begin
+        case (reg_read_addr[8:0])
+            9'h1F4: reg_data_out = {core_irq_flags[3], core_irq_flags[2], core_irq_flags[1], core_irq_flags[0]};
+            9'h1F8: reg_data_out = {16'b0, sync_arm};
+            default: reg_data_out = core_data_out[reg_read_addr[10:9]];
+        endcase
+    end
 
     pio_core core_0(
         .clk(clk),
         .rst(rst),
         .core_output(core_0_output),
         .core_drive(core_0_drive),
-        .gpio_input(in_data)
+        .sync_bypass(core_sync_bypass[0]),
+        .gpio_input(in_data),
+        .reg_data_in(reg_data_in),
+        .reg_write_addr(reg_write_addr[8:0]),
+        .reg_read_addr(reg_read_addr[8:0]),
+        .reg_write_en(core_write_en[0]),
+        .reg_read_en(core_read_en[0]),
+        .reg_data_out(core_data_out[0]),
+        .sync_in(sync_in[0]),
+        .irq_flags(core_irq_flags[0]),
+        .irq_prev_flags(core_irq_flags[3]),
+        .irq_next_flags(core_irq_flags[1]),
+        .irq_to_prev(irq_to_prev[0]),
+        .irq_to_next(irq_to_next[0]),
+        .irq_from_prev(irq_to_next[3]),
+        .irq_from_next(irq_to_prev[1]),
+        .trace(trace[3:0]),
+        .quiescent(core_quiescent[0])
     );
 
     pio_core core_1(
@@ -31,7 +124,24 @@ module pio_chip(
         .rst(rst),
         .core_output(core_1_output),
         .core_drive(core_1_drive),
-        .gpio_input(in_data)
+        .sync_bypass(core_sync_bypass[1]),
+        .gpio_input(in_data),
+        .reg_data_in(reg_data_in),
+        .reg_write_addr(reg_write_addr[8:0]),
+        .reg_read_addr(reg_read_addr[8:0]),
+        .reg_write_en(core_write_en[1]),
+        .reg_read_en(core_read_en[1]),
+        .reg_data_out(core_data_out[1]),
+        .sync_in(sync_in[1]),
+        .irq_flags(core_irq_flags[1]),
+        .irq_prev_flags(core_irq_flags[0]),
+        .irq_next_flags(core_irq_flags[2]),
+        .irq_to_prev(irq_to_prev[1]),
+        .irq_to_next(irq_to_next[1]),
+        .irq_from_prev(irq_to_next[0]),
+        .irq_from_next(irq_to_prev[2]),
+        .trace(trace[7:4]),
+        .quiescent(core_quiescent[1])
     );
 
     pio_core core_2(
@@ -39,7 +149,24 @@ module pio_chip(
         .rst(rst),
         .core_output(core_2_output),
         .core_drive(core_2_drive),
-        .gpio_input(in_data)
+        .sync_bypass(core_sync_bypass[2]),
+        .gpio_input(in_data),
+        .reg_data_in(reg_data_in),
+        .reg_write_addr(reg_write_addr[8:0]),
+        .reg_read_addr(reg_read_addr[8:0]),
+        .reg_write_en(core_write_en[2]),
+        .reg_read_en(core_read_en[2]),
+        .reg_data_out(core_data_out[2]),
+        .sync_in(sync_in[2]),
+        .irq_flags(core_irq_flags[2]),
+        .irq_prev_flags(core_irq_flags[1]),
+        .irq_next_flags(core_irq_flags[3]),
+        .irq_to_prev(irq_to_prev[2]),
+        .irq_to_next(irq_to_next[2]),
+        .irq_from_prev(irq_to_next[1]),
+        .irq_from_next(irq_to_prev[3]),
+        .trace(trace[11:8]),
+        .quiescent(core_quiescent[2])
     );
 
     pio_core core_3(
@@ -47,7 +174,24 @@ module pio_chip(
         .rst(rst),
         .core_output(core_3_output),
         .core_drive(core_3_drive),
-        .gpio_input(in_data)
+        .sync_bypass(core_sync_bypass[3]),
+        .gpio_input(in_data),
+        .reg_data_in(reg_data_in),
+        .reg_write_addr(reg_write_addr[8:0]),
+        .reg_read_addr(reg_read_addr[8:0]),
+        .reg_write_en(core_write_en[3]),
+        .reg_read_en(core_read_en[3]),
+        .reg_data_out(core_data_out[3]),
+        .sync_in(sync_in[3]),
+        .irq_flags(core_irq_flags[3]),
+        .irq_prev_flags(core_irq_flags[2]),
+        .irq_next_flags(core_irq_flags[0]),
+        .irq_to_prev(irq_to_prev[3]),
+        .irq_to_next(irq_to_next[3]),
+        .irq_from_prev(irq_to_next[2]),
+        .irq_from_next(irq_to_prev[0]),
+        .trace(trace[15:12]),
+        .quiescent(core_quiescent[3])
     );
 
     assign core_output[0] = core_0_output;
@@ -60,6 +204,12 @@ module pio_chip(
     assign core_drive[2] = core_2_drive;
     assign core_drive[3] = core_3_drive;
 
+    // TODO - drive from GPIO_CTRL once it exists. Until then core 0 owns every pin.
+    assign core_select[0] = 32'hFFFFFFFF;
+    assign core_select[1] = 32'h00000000;
+    assign core_select[2] = 32'h00000000;
+    assign core_select[3] = 32'h00000000;
+
     core_output_arbitrator core_output_arbitrator(
         .core_select(core_select),
         .core_output(core_output),
@@ -68,6 +218,12 @@ module pio_chip(
         .gpio_drive(dir)
     );
 
+    // Each pin's input synchronizer is bypassed if the core that owns it sets INPUT_SYNC_BYPASS
+    assign sync_bypass = (core_select[0] & core_sync_bypass[0])
+                       | (core_select[1] & core_sync_bypass[1])
+                       | (core_select[2] & core_sync_bypass[2])
+                       | (core_select[3] & core_sync_bypass[3]);
+
     gpio gpio_bank(
         .clk(clk),
         .rst(rst),
@@ -77,7 +233,10 @@ module pio_chip(
         .pde(pde),
         .pue(pue),
         .in_data(in_data),
+        .settled(gpio_settled),
         .gpio(gpio)
     );
 
+    assign quiescent = &core_quiescent && gpio_settled;
+
 endmodule
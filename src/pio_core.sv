@@ -1,48 +1,231 @@
+`include "types.svh"
+
 module pio_core(
     input logic clk, rst,
     input logic [31:0] gpio_input,
     output logic [31:0] core_output,
-    output logic [31:0] core_drive
+    output logic [31:0] core_drive,
+    output logic [31:0] sync_bypass, // INPUT_SYNC_BYPASS
+    // Host register bus
+    input logic [31:0] reg_data_in,
+    input logic [8:0] reg_write_addr, reg_read_addr,
+    input logic reg_write_en,
+    input logic reg_read_en, // Reads from RXFx pop the FIFO
+    output logic [31:0] reg_data_out,
+    input sync_reg_in_t sync_in, // Chip-level SYNC_TRIGGER for this core's SMs
+    // Cross-core IRQ fabric, see pio_chip
+    output logic [7:0] irq_flags, // This core's IRQ register
+    input logic [7:0] irq_prev_flags, irq_next_flags, // The neighbouring cores'
+    output irq_reg_in_t irq_to_prev, irq_to_next, // Set/clear from this core's SMs
+    input irq_reg_in_t irq_from_prev, irq_from_next, // Set/clear for this core from the neighbours' SMs
+    output fsm_trace_t trace [3:0],
+    output logic quiescent // Every FSM is quiescent
     );
 
-    logic [4:0] pc;
-    logic [15:0] instruction;
-    logic [15:0] instr_in;
-    logic [4:0] write_addr;
-    logic write_en;
-    logic out_shiftdir; // TODO - wire up to control register
-
-    // TODO: Remove when spi is wired up
-    initial begin
-        write_addr = 5'b00000;
-        write_en = 0;
+    logic [4:0] pc [3:0];
+    logic [15:0] instruction [3:0];
+
+    // Control register outputs
+    ctrl_reg_out_t ctrl_out;
+    logic [31:8] fsm_clkdiv [3:0];
+    logic [31:0] fsm_execctrl [3:0];
+    logic [31:14] fsm_shiftctrl [3:0];
+    logic [15:0] fsm_instr [3:0];
+    logic [3:0] fsm_instr_flag;
+    logic [31:0] fsm_pinctrl [3:0];
+    logic [31:0] regfile_data_out;
+    instr_bank_out_t instr_bank;
+
+    // Control register inputs
+    fsm_events_t fsm_events [3:0];
+    fstat_reg_in_t fstat_in;
+    fdebug_reg_in_t fdebug_in;
+    flevel_reg_in_t flevel_in;
+    perf_reg_in_t perf_in;
+    irq_reg_in_t irq_in;
+
+    // Host bus decode
+    // 0x010 - 0x01C TXFx - writes push to the TX FIFO of FSM x
+    // 0x020 - 0x02C RXFx - reads return the head of the RX FIFO of FSM x, and pop it if reg_read_en is set
+    // 0x048 - 0x0C4 INSTR_MEMx - writes go to the instruction regfile, to the shadow bank with INSTR_BANK.SHADOW_WRITE
+    // 0x19C - 0x1D8 RXFx_PUTGETy - decoded by the control regfile, but the entries live in FSM x's RX FIFO
+    // Everything else is handled by the control regfile
+    logic [3:0] tx_push_en, rx_pop_en;
+    logic [31:0] rx_data_out [3:0];
+    logic [31:0] rx_entries [3:0][0:3];
+    logic [3:0] rxf_put_en;
+    logic [1:0] rxf_put_index;
+    logic instr_write_en;
+    logic [4:0] instr_write_addr;
+
+    assign instr_write_en = reg_write_en && reg_write_addr >= 9'h048 && reg_write_addr <= 9'h0C4;
+    assign instr_write_addr = 5'((reg_write_addr - 9'h048) >> 2);
+
+    always_comb begin
+        reg_data_out = regfile_data_out;
+        for (int i = 0; i < 4; i = i + 1) begin
+            tx_push_en[i] = reg_write_en && reg_write_addr == 9'h010 + 9'(4 * i);
+            rx_pop_en[i] = reg_read_en && reg_read_addr == 9'h020 + 9'(4 * i);
+            if (reg_read_addr == 9'h020 + 9'(4 * i)) reg_data_out = rx_data_out[i];
+        end
+    end
+
+    logic [31:0] fsm_output [3:0];
+    logic [31:0] fsm_drive [3:0];
+
+    fifo_status tx_status [3:0];
+    fifo_status rx_status [3:0];
+    logic [2:0] tx_level [3:0];
+    logic [2:0] rx_level [3:0];
+    logic [3:0] fsm_quiescent;
+
+    // Instruction bank swap, when INSTR_BANK.SWAP_SEL says so
+    logic instr_bank_active, instr_swap;
+
+    always_comb begin
+        case (instr_bank.swap_sel)
+            SWAP_NOW: instr_swap = instr_bank.swap_pending;
+            SWAP_WRAP: instr_swap = instr_bank.swap_pending && fsm_events[instr_bank.swap_sm].wrapped;
+            SWAP_IRQ: instr_swap = instr_bank.swap_pending && irq_flags[instr_bank.swap_irq];
+            default: instr_swap = 1'b0;
+        endcase
+    end
+
+    // A swap that's due changes what the FSMs run, so it isn't quiescent
+    // until it has happened
+    assign quiescent = &fsm_quiescent && !instr_swap;
+
+    // IRQ flag requests, merged across the FSMs and split by the core they're for
+    irq_flags_t fsm_irq_set [3:0];
+    irq_flags_t fsm_irq_clr [3:0];
+
+    always_comb begin
+        irq_in.irq_set = irq_from_prev.irq_set | irq_from_next.irq_set;
+        irq_in.irq_clr = irq_from_prev.irq_clr | irq_from_next.irq_clr;
+        // A swap on an IRQ flag consumes it, like WAIT 1 IRQ
+        if (instr_swap && instr_bank.swap_sel == SWAP_IRQ) irq_in.irq_clr[instr_bank.swap_irq] = 1'b1;
+        irq_to_prev = '0;
+        irq_to_next = '0;
+        for (int i = 0; i < 4; i = i + 1) begin
+            irq_in.irq_set = irq_in.irq_set | fsm_irq_set[i].own;
+            irq_in.irq_clr = irq_in.irq_clr | fsm_irq_clr[i].own;
+            irq_to_prev.irq_set = irq_to_prev.irq_set | fsm_irq_set[i].prev;
+            irq_to_prev.irq_clr = irq_to_prev.irq_clr | fsm_irq_clr[i].prev;
+            irq_to_next.irq_set = irq_to_next.irq_set | fsm_irq_set[i].next;
+            irq_to_next.irq_clr = irq_to_next.irq_clr | fsm_irq_clr[i].next;
+        end
     end
 
-    // TODO: Wire these up properly
-    logic push_en, pop_en;
-    logic [31:0] fifo_in, fifo_out;
-    logic autopull;
-    logic [4:0] pull_thresh;
+    generate
+        for (genvar i = 0; i < 4; i = i + 1) begin : g_fsm
+            fsm fsm(
+                .clk(clk),
+                .rst(rst),
+                .enable(ctrl_out.sm_en[i]),
+                .restart(ctrl_out.sm_restart[i]),
+                .external_push_en(tx_push_en[i]),
+                .external_pop_en(rx_pop_en[i]),
+                .external_data_in(reg_data_in),
+                .external_put_en(rxf_put_en[i]),
+                .external_put_index(rxf_put_index),
+                .instruction(instruction[i]),
+                .external_exec_instr(fsm_instr[i]),
+                .external_exec_en(fsm_instr_flag[i]),
+                .pc(pc[i]),
+                .external_data_out(rx_data_out[i]),
+                .rx_entries(rx_entries[i]),
+                .out_shiftdir(fsm_shiftctrl[i][19]), // SHIFTCTRL_OUT_SHIFTDIR
+                .autopull(fsm_shiftctrl[i][17]), // SHIFTCTRL_AUTOPULL
+                .pull_thresh(fsm_shiftctrl[i][29:25]), // SHIFTCTRL_PULL_THRESH
+                .rx_put(fsm_shiftctrl[i][15]), // SHIFTCTRL_FJOIN_RX_PUT
+                .rx_get(fsm_shiftctrl[i][14]), // SHIFTCTRL_FJOIN_RX_GET
+                // The RP2040 calls the wrap target WRAP_BOTTOM and the end WRAP_TOP,
+                // the program counter has them the other way up
+                .wrap_top(fsm_execctrl[i][11:7]), // EXECCTRL_WRAP_BOTTOM
+                .wrap_bottom(fsm_execctrl[i][16:12]), // EXECCTRL_WRAP_TOP
+                .jmp_pin(fsm_execctrl[i][28:24]), // EXECCTRL_JMP_PIN
+                .status_sel(fsm_execctrl[i][4]), // EXECCTRL_STATUS_SEL
+                .status_n(fsm_execctrl[i][3:0]), // EXECCTRL_STATUS_N
+                .in_base(fsm_pinctrl[i][19:15]), // PINCTRL_IN_BASE
+                .out_base(fsm_pinctrl[i][4:0]), // PINCTRL_OUT_BASE
+                .out_count(fsm_pinctrl[i][25:20]), // PINCTRL_OUT_COUNT
+                .gpio_input(gpio_input),
+                .sm_index(2'(i)),
+                .irq_flags({irq_next_flags, irq_prev_flags, irq_flags}),
+                .irq_set(fsm_irq_set[i]),
+                .irq_clr(fsm_irq_clr[i]),
+                .events(fsm_events[i]),
+                .tx_status(tx_status[i]),
+                .rx_status(rx_status[i]),
+                .tx_fifo_count(tx_level[i]),
+                .rx_fifo_count(rx_level[i]),
+                .trace(trace[i]),
+                .pin_output(fsm_output[i]),
+                .pin_drive(fsm_drive[i]),
+                .quiescent(fsm_quiescent[i])
+            );
+
+            // FSTAT
+            assign fstat_in.tx_empty[i] = tx_status[i].empty;
+            assign fstat_in.tx_full[i] = tx_status[i].full;
+            assign fstat_in.rx_empty[i] = rx_status[i].empty;
+            assign fstat_in.rx_full[i] = rx_status[i].full;
 
-    // TODO: Add the other FSMs later
-    fsm fsm(
+            // FLEVEL
+            assign flevel_in.tx[i] = {1'b0, tx_level[i]};
+            assign flevel_in.rx[i] = {1'b0, rx_level[i]};
+
+            // FDEBUG
+            assign fdebug_in.tx_stall[i] = fsm_events[i].tx_stall;
+            assign fdebug_in.tx_over[i] = fsm_events[i].tx_over;
+            assign fdebug_in.rx_under[i] = fsm_events[i].rx_under;
+            assign fdebug_in.rx_stall[i] = fsm_events[i].rx_stall;
+
+            // Performance counters
+            assign perf_in.retired[i] = fsm_events[i].retired;
+            assign perf_in.tx_stall[i] = fsm_events[i].tx_stall;
+            assign perf_in.rx_stall[i] = fsm_events[i].rx_stall;
+            assign perf_in.wait_stall[i] = fsm_events[i].wait_stall;
+            assign perf_in.jump_taken[i] = fsm_events[i].jump_taken;
+        end
+    endgenerate
+
+    control_regfile control_regfile(
         .clk(clk),
         .rst(rst),
-        .external_push_en(push_en),
-        .external_pop_en(pop_en),
-        .external_data_in(fifo_in),
-        .instruction(instruction),
-        .pc(pc),
-        .external_data_out(fifo_out),
-        .out_shiftdir(out_shiftdir),
-        .autopull(autopull),
-        .pull_thresh(pull_thresh)
+        .data_in(reg_data_in),
+        .write_addr(reg_write_addr),
+        .read_addr(reg_read_addr),
+        .write_en(reg_write_en),
+        .data_out(regfile_data_out),
+        .ctrl_out(ctrl_out),
+        .fstat_in(fstat_in),
+        .fdebug_in(fdebug_in),
+        .flevel_in(flevel_in),
+        .irq_in(irq_in),
+        .irq_flags(irq_flags),
+        .gpio_sync_bypass(sync_bypass),
+        .dbg_padout(core_output),
+        .dbg_padoe(core_drive),
+        .fsm_clkdiv(fsm_clkdiv),
+        .fsm_execctrl(fsm_execctrl),
+        .fsm_shiftctrl(fsm_shiftctrl),
+        .current_addr(pc),
+        .current_instr(instruction),
+        .fsm_instr(fsm_instr),
+        .fsm_instr_flag(fsm_instr_flag),
+        .fsm_pinctrl(fsm_pinctrl),
+        .intr_in('0),
+        .perf_in(perf_in),
+        .sync_in(sync_in),
+        .instr_bank_out(instr_bank),
+        .instr_bank_active(instr_bank_active),
+        .instr_bank_swap(instr_swap),
+        .rx_entries(rx_entries),
+        .rxf_put_en(rxf_put_en),
+        .rxf_put_index(rxf_put_index)
     );
 
-    // TODO - Wire these up to the FSMs
-    logic [31:0] fsm_output [3:0];
-    logic [31:0] fsm_drive [3:0];
-
     fsm_output_arbitrator fsm_output_arbitrator(
         .fsm_output(fsm_output),
         .fsm_drive(fsm_drive),
@@ -53,11 +236,14 @@ module pio_core(
     instruction_regfile instruction_regfile(
         .clk(clk),
         .rst(rst),
-        .instr_in(instr_in),
-        .write_addr(write_addr),
-        .write_en(write_en),
+        .instr_in(reg_data_in[15:0]),
+        .write_addr(instr_write_addr),
+        .write_en(instr_write_en),
+        .shadow_write(instr_bank.shadow_write),
+        .swap(instr_swap),
+        .active(instr_bank_active),
         .read_addr(pc),
         .instr_out(instruction)
     );
 
-endmodule
\ No newline at end of file
+endmodule
@@ -1,5 +1,6 @@
 module program_counter(
     input logic clk, rst,
+    input logic restart, // Back to wrap_top, like rst
     input logic [4:0] wrap_top,
     input logic [4:0] wrap_bottom,
     input logic [4:0] jump,
@@ -11,6 +12,8 @@ module program_counter(
     always @(posedge clk or posedge rst) begin
         if (rst) begin
             pc <= wrap_top;
+        end else if (restart) begin
+            pc <= wrap_top;
         end else if (pc_en) begin
             if (jump_en) begin
                 // Jump instruction
@@ -3,6 +3,7 @@
 module test_wrapper(
     input logic clk, rst,
     // PROGRAM COUNTER
+    input logic restart,
     input logic [4:0] wrap_top, wrap_bottom,
     input logic [4:0] jump,
     input logic jump_en,
@@ -14,6 +15,8 @@ module test_wrapper(
     input logic write_en,
     input logic [4:0] read_addr,
     output logic [15:0] instr_out,
+    input logic instr_shadow_write, instr_swap,
+    output logic instr_active,
     // GPIO
     input logic [31:0] out_data, sync_bypass, dir, pde, pue,
     output logic [31:0] in_data,
@@ -24,7 +27,7 @@ module test_wrapper(
     output logic [31:0] fsm_core_output,
     output logic [31:0] fsm_core_drive,
     // CORE OUTPUT ARBITRATOR
-    input logic [1:0] core_select [31:0],
+    input logic [31:0] core_select [3:0],
     input logic [31:0] core_output [3:0],
     input logic [31:0] core_drive [3:0],
     output logic [31:0] gpio_output,
@@ -34,6 +37,7 @@ module test_wrapper(
     output logic [31:0] osr, osr_shift_out,
     input logic osr_load,
     input logic osr_shift_en,
+    input logic osr_refill,
     input logic osr_shiftdir,
     input logic [5:0] osr_shift_count,
     // FIFO
@@ -44,22 +48,63 @@ module test_wrapper(
     output logic empty,
     output logic full,
     output logic [2:0] fifo_count,
+    input logic fifo_put_en,
+    input logic [1:0] fifo_put_index,
+    input logic [31:0] fifo_put_data,
     output [31:0] fifo_memory [0:3],
     output logic [1:0] fifo_head,
     output logic [1:0] fifo_tail,
+    output logic [31:0] fwft_fifo_out,
+    output logic fwft_data_valid,
+    output logic [2:0] fwft_fifo_count,
     // FSM
+    input logic fsm_enable, fsm_restart,
     input logic [15:0] instruction,
     output logic [4:0] fsm_pc,
     input logic external_push_en, external_pop_en,
     input logic [31:0] external_data_in,
+    input logic external_put_en,
+    input logic [1:0] external_put_index,
     output logic [31:0] external_data_out,
     input logic out_shiftdir,
     input logic autopull,
     input logic [4:0] pull_thresh,
+    input logic fsm_rx_put, fsm_rx_get,
+    input logic [31:0] fsm_execctrl,
+    input logic [31:0] fsm_pinctrl,
+    input logic [31:0] fsm_gpio_input,
+    input logic [1:0] fsm_sm_index,
+    input irq_flags_t fsm_irq_flags,
+    output irq_flags_t fsm_irq_set, fsm_irq_clr,
+    output logic [31:0] fsm_pin_output,
+    output logic [31:0] fsm_isr,
     output logic [31:0] x, y,
     output logic [31:0] osr_data,
     output logic [5:0] out_shift_counter,
-    output logic osr_empty
+    output logic osr_empty,
+    output fsm_events_t fsm_events,
+    output fsm_trace_t fsm_trace,
+    output logic fsm_quiescent,
+    output logic [2:0] fsm_tx_count, fsm_rx_count,
+    output logic [31:0] fsm_tx_memory [0:3],
+    output logic [31:0] fsm_rx_memory [0:3],
+    output logic [1:0] fsm_tx_tail, fsm_rx_tail,
+    // CONTROL REGFILE
+    input logic [31:0] cr_data_in,
+    input logic [8:0] cr_write_addr, cr_read_addr,
+    input logic cr_write_en,
+    output logic [31:0] cr_data_out,
+    input fstat_reg_in_t cr_fstat_in,
+    input fdebug_reg_in_t cr_fdebug_in,
+    input flevel_reg_in_t cr_flevel_in,
+    input perf_reg_in_t cr_perf_in,
+    input irq_reg_in_t cr_irq_in,
+    output logic [7:0] cr_irq_flags,
+    output instr_bank_out_t cr_instr_bank_out,
+    input logic cr_instr_bank_active, cr_instr_bank_swap,
+    input logic [31:0] cr_rx_entries [3:0][0:3],
+    output logic [3:0] cr_rxf_put_en,
+    output logic [1:0] cr_rxf_put_index
     );
 
     initial begin
@@ -71,6 +116,7 @@ module test_wrapper(
     program_counter uut_program_counter(
         .clk(clk),
         .rst(rst),
+        .restart(restart),
         .wrap_top(wrap_top),
         .wrap_bottom(wrap_bottom),
         .jump(jump),
@@ -79,35 +125,86 @@ module test_wrapper(
         .pc(pc)
     );
 
+    // Tests drive every read port from the same address and look at port 0
+    logic [4:0] regfile_read_addr [3:0];
+    logic [15:0] regfile_instr_out [3:0];
+
+    always_comb begin
+        for (int i = 0; i < 4; i = i + 1) begin
+            regfile_read_addr[i] = read_addr;
+        end
+    end
+
+    assign instr_out = regfile_instr_out[0];
+
     instruction_regfile uut_instruction_regfile(
         .clk(clk),
         .rst(rst),
         .instr_in(instr_in),
         .write_addr(write_addr),
         .write_en(write_en),
-        .read_addr(read_addr),
-        .instr_out(instr_out)
+        .shadow_write(instr_shadow_write),
+        .swap(instr_swap),
+        .active(instr_active),
+        .read_addr(regfile_read_addr),
+        .instr_out(regfile_instr_out)
     );
 
     fsm uut_fsm(
         .clk(clk),
         .rst(rst),
+        .enable(fsm_enable),
+        .restart(fsm_restart),
         .external_push_en(external_push_en),
         .external_data_in(external_data_in),
         .external_pop_en(external_pop_en),
+        .external_put_en(external_put_en),
+        .external_put_index(external_put_index),
         .instruction(instruction),
+        // SMx_INSTR goes through pio_core, see tests/pio_shim.cpp
+        .external_exec_instr(16'b0),
+        .external_exec_en(1'b0),
         .pc(fsm_pc),
         .external_data_out(external_data_out),
+        .rx_entries(),
         .out_shiftdir(out_shiftdir),
         .autopull(autopull),
-        .pull_thresh(pull_thresh)
+        .pull_thresh(pull_thresh),
+        .rx_put(fsm_rx_put),
+        .rx_get(fsm_rx_get),
+        // Same EXECCTRL fields as pio_core
+        .wrap_top(fsm_execctrl[11:7]),
+        .wrap_bottom(fsm_execctrl[16:12]),
+        .jmp_pin(fsm_execctrl[28:24]),
+        .status_sel(fsm_execctrl[4]),
+        .status_n(fsm_execctrl[3:0]),
+        .in_base(fsm_pinctrl[19:15]),
+        .out_base(fsm_pinctrl[4:0]),
+        .out_count(fsm_pinctrl[25:20]),
+        .gpio_input(fsm_gpio_input),
+        .sm_index(fsm_sm_index),
+        .irq_flags(fsm_irq_flags),
+        .irq_set(fsm_irq_set),
+        .irq_clr(fsm_irq_clr),
+        .events(fsm_events),
+        .trace(fsm_trace),
+        .pin_output(fsm_pin_output),
+        .pin_drive(),
+        .quiescent(fsm_quiescent)
     );
     
     assign x = uut_fsm.x;
     assign y = uut_fsm.y;
+    assign fsm_isr = uut_fsm.isr;
     assign osr_data = uut_fsm.osr_data;
     assign out_shift_counter = uut_fsm.out_shift_counter;
     assign osr_empty = uut_fsm.osr_empty;
+    assign fsm_tx_count = uut_fsm.tx_fifo_count;
+    assign fsm_rx_count = uut_fsm.rx_fifo_count;
+    assign fsm_tx_memory = uut_fsm.tx_fifo.memory;
+    assign fsm_rx_memory = uut_fsm.rx_fifo.memory;
+    assign fsm_tx_tail = uut_fsm.tx_fifo.tail;
+    assign fsm_rx_tail = uut_fsm.rx_fifo.tail;
 
     gpio uut_gpio(
         .clk(clk),
@@ -118,6 +215,7 @@ module test_wrapper(
         .pde(pde),
         .pue(pue),
         .in_data(in_data),
+        .settled(),
         .gpio(gpio)
     );
 
@@ -144,6 +242,7 @@ module test_wrapper(
         .shift_out(osr_shift_out),
         .load(osr_load),
         .shift_en(osr_shift_en),
+        .refill(osr_refill),
         .shiftdir(osr_shiftdir),
         .shift_count(osr_shift_count)
     );
@@ -155,8 +254,30 @@ module test_wrapper(
         .push_en(push_en),
         .pop_en(pop_en),
         .data_out(fifo_out),
+        .data_valid(),
         .status(status),
-        .fifo_count(fifo_count)
+        .fifo_count(fifo_count),
+        .put_en(fifo_put_en),
+        .put_index(fifo_put_index),
+        .put_data(fifo_put_data),
+        .entries()
+    );
+
+    // Shares its inputs with uut_fifo
+    fifo #(.FWFT(1)) uut_fwft_fifo(
+        .clk(clk),
+        .rst(rst),
+        .data_in(fifo_in),
+        .push_en(push_en),
+        .pop_en(pop_en),
+        .data_out(fwft_fifo_out),
+        .data_valid(fwft_data_valid),
+        .status(),
+        .fifo_count(fwft_fifo_count),
+        .put_en(fifo_put_en),
+        .put_index(fifo_put_index),
+        .put_data(fifo_put_data),
+        .entries()
     );
 
     fifo_status status;
@@ -167,4 +288,59 @@ module test_wrapper(
     assign fifo_head = uut_fifo.head;
     assign fifo_tail = uut_fifo.tail;
 
-endmodule
+    // Control regfile outputs that the tests don't look at yet
+    ctrl_reg_out_t cr_ctrl_out;
+    logic [31:0] cr_gpio_sync_bypass;
+    logic [31:8] cr_fsm_clkdiv [3:0];
+    logic [31:0] cr_fsm_execctrl [3:0];
+    logic [31:14] cr_fsm_shiftctrl [3:0];
+    logic [15:0] cr_fsm_instr [3:0];
+    logic [3:0] cr_fsm_instr_flag;
+    logic [31:0] cr_fsm_pinctrl [3:0];
+    logic [4:0] cr_current_addr [3:0];
+    logic [15:0] cr_current_instr [3:0];
+
+    always_comb begin
+        for (int i = 0; i < 4; i = i + 1) begin
+            cr_current_addr[i] = 5'b0;
+            cr_current_instr[i] = 16'b0;
+        end
+    end
+
+    control_regfile uut_control_regfile(
+        .clk(clk),
+        .rst(rst),
+        .data_in(cr_data_in),
+        .write_addr(cr_write_addr),
+        .read_addr(cr_read_addr),
+        .write_en(cr_write_en),
+        .data_out(cr_data_out),
+        .ctrl_out(cr_ctrl_out),
+        .fstat_in(cr_fstat_in),
+        .fdebug_in(cr_fdebug_in),
+        .flevel_in(cr_flevel_in),
+        .irq_in(cr_irq_in),
+        .irq_flags(cr_irq_flags),
+        .gpio_sync_bypass(cr_gpio_sync_bypass),
+        .dbg_padout(32'b0),
+        .dbg_padoe(32'b0),
+        .fsm_clkdiv(cr_fsm_clkdiv),
+        .fsm_execctrl(cr_fsm_execctrl),
+        .fsm_shiftctrl(cr_fsm_shiftctrl),
+        .current_addr(cr_current_addr),
+        .current_instr(cr_current_instr),
+        .fsm_instr(cr_fsm_instr),
+        .fsm_instr_flag(cr_fsm_instr_flag),
+        .fsm_pinctrl(cr_fsm_pinctrl),
+        .intr_in('0),
+        .perf_in(cr_perf_in),
+        .sync_in('0),
+        .instr_bank_out(cr_instr_bank_out),
+        .instr_bank_active(cr_instr_bank_active),
+        .instr_bank_swap(cr_instr_bank_swap),
+        .rx_entries(cr_rx_entries),
+        .rxf_put_en(cr_rxf_put_en),
+        .rxf_put_index(cr_rxf_put_index)
+    );
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,77 @@
+# Compares two synthesis reports from report.cmake
+#
+#     cmake -DOLD=<old report.json> -DNEW=<new report.json> [-DTOLERANCE=5] -P synth/compare.cmake
+#
+# Prints the change in cells, area and fmax for every module in both reports,
+# and fails if any module's fmax dropped by more than TOLERANCE percent.
+
+cmake_minimum_required(VERSION 3.19)
+
+if(NOT DEFINED TOLERANCE)
+    set(TOLERANCE 5)
+endif()
+
+file(READ ${OLD} old)
+file(READ ${NEW} new)
+
+# Percentage change between two values, to the nearest 0.1%. CMake's math is
+# integer only, so any fractional part is dropped first.
+function(percent_change old new out)
+    string(REGEX REPLACE "\\..*" "" old "${old}")
+    string(REGEX REPLACE "\\..*" "" new "${new}")
+    if(old EQUAL 0)
+        set(${out} "n/a" PARENT_SCOPE)
+        return()
+    endif()
+    math(EXPR tenths "(${new} - ${old}) * 1000 / ${old}")
+    if(tenths LESS 0)
+        set(sign "-")
+        math(EXPR tenths "-${tenths}")
+    else()
+        set(sign "+")
+    endif()
+    math(EXPR whole "${tenths} / 10")
+    math(EXPR frac "${tenths} % 10")
+    set(${out} "${sign}${whole}.${frac}%" PARENT_SCOPE)
+endfunction()
+
+set(regressed "")
+string(JSON count LENGTH "${new}" modules)
+math(EXPR last "${count} - 1")
+foreach(i RANGE ${last})
+    string(JSON module MEMBER "${new}" modules ${i})
+    string(JSON old_cells ERROR_VARIABLE missing GET "${old}" modules ${module} cells)
+    if(missing)
+        message("${module}: new")
+        continue()
+    endif()
+    string(JSON new_cells GET "${new}" modules ${module} cells)
+    percent_change(${old_cells} ${new_cells} cells_change)
+    set(line "${module}: cells ${old_cells} -> ${new_cells} (${cells_change})")
+
+    string(JSON old_area GET "${old}" modules ${module} area)
+    string(JSON new_area GET "${new}" modules ${module} area)
+    # null (no liberty) reads back as an empty string
+    if(NOT old_area MATCHES "^(null)?$" AND NOT new_area MATCHES "^(null)?$")
+        percent_change(${old_area} ${new_area} area_change)
+        string(REGEX REPLACE "(\\.[0-9][0-9])[0-9]*" "\\1" old_area "${old_area}")
+        string(REGEX REPLACE "(\\.[0-9][0-9])[0-9]*" "\\1" new_area "${new_area}")
+        string(APPEND line ", area ${old_area} -> ${new_area} (${area_change})")
+    endif()
+
+    string(JSON old_fmax ERROR_VARIABLE no_old GET "${old}" modules ${module} timing fmax_khz)
+    string(JSON new_fmax ERROR_VARIABLE no_new GET "${new}" modules ${module} timing fmax_khz)
+    if(NOT no_old AND NOT no_new)
+        percent_change(${old_fmax} ${new_fmax} fmax_change)
+        string(APPEND line ", fmax ${old_fmax} -> ${new_fmax} kHz (${fmax_change})")
+        math(EXPR floor "${old_fmax} * (100 - ${TOLERANCE}) / 100")
+        if(new_fmax LESS floor)
+            list(APPEND regressed ${module})
+        endif()
+    endif()
+    message("${line}")
+endforeach()
+
+if(regressed)
+    message(FATAL_ERROR "fmax dropped by more than ${TOLERANCE}% in: ${regressed}")
+endif()
@@ -0,0 +1,45 @@
+# Collects the per-module synthesis and timing results into one JSON report
+#
+#     cmake -DSYNTH_DIR=<dir> -DMODULES="fsm;fifo;..." -DOUTPUT=<report.json> -P synth/report.cmake
+#
+# Report layout:
+#     {"modules": {"fsm": {"cells": 1234, "area": 5678.9, "timing": {...} or null}, ...}}
+# area is null without a liberty, timing is sta.tcl's timing.json or null.
+
+cmake_minimum_required(VERSION 3.19)
+
+set(report "{\"modules\": {}}")
+foreach(module ${MODULES})
+    file(READ ${SYNTH_DIR}/${module}/stat.json stat)
+    string(JSON cells GET "${stat}" design num_cells)
+    string(JSON area ERROR_VARIABLE no_area GET "${stat}" design area)
+    if(no_area)
+        set(area null)
+    endif()
+
+    set(timing null)
+    if(EXISTS ${SYNTH_DIR}/${module}/timing.json)
+        file(READ ${SYNTH_DIR}/${module}/timing.json timing)
+    endif()
+
+    string(JSON report SET "${report}" modules ${module} "{\"cells\": ${cells}, \"area\": ${area}, \"timing\": ${timing}}")
+endforeach()
+
+file(WRITE ${OUTPUT} "${report}\n")
+
+# Short summary for the build log
+foreach(module ${MODULES})
+    string(JSON cells GET "${report}" modules ${module} cells)
+    string(JSON area GET "${report}" modules ${module} area)
+    set(line "${module}: ${cells} cells")
+    if(NOT area MATCHES "^(null)?$")
+        string(REGEX REPLACE "(\\.[0-9][0-9])[0-9]*" "\\1" area "${area}")
+        string(APPEND line ", area ${area}")
+    endif()
+    string(JSON fmax_khz ERROR_VARIABLE no_timing GET "${report}" modules ${module} timing fmax_khz)
+    if(NOT no_timing)
+        string(JSON endpoint GET "${report}" modules ${module} timing endpoint)
+        string(APPEND line ", fmax ${fmax_khz} kHz (worst path ends at ${endpoint})")
+    endif()
+    message("${line}")
+endforeach()
@@ -0,0 +1,59 @@
+# OpenSTA timing of a netlist from synth.tcl, run by the `synth` target
+#
+#     sta -no_init -no_splash -exit synth/sta.tcl
+#
+# Environment: PIO_SYNTH_TOP, PIO_SYNTH_OUT and PIO_LIBERTY as for synth.tcl,
+# plus PIO_SYNTH_PERIOD_NS, the clock period to check against.
+#
+# Inputs and outputs are constrained to the clock edge with no external delay,
+# so register-to-register paths and the combinational paths through a module
+# both count. Modules without a clk port are timed against a virtual clock.
+#
+# Writes critical_path.txt (the full worst path report) and timing.json:
+#     {"period_ns": 10, "worst_slack_ns": 1.234, "fmax_khz": 114207,
+#      "startpoint": "...", "endpoint": "..."}
+
+set top $::env(PIO_SYNTH_TOP)
+set out $::env(PIO_SYNTH_OUT)
+set period $::env(PIO_SYNTH_PERIOD_NS)
+
+read_liberty $::env(PIO_LIBERTY)
+read_verilog $out/netlist.v
+link_design $top
+
+set clk_port [get_ports -quiet clk]
+if {[llength $clk_port]} {
+    create_clock -name clk -period $period $clk_port
+    set inputs [delete_from_list [all_inputs] $clk_port]
+} else {
+    create_clock -name clk -period $period
+    set inputs [all_inputs]
+}
+set_input_delay 0 -clock clk $inputs
+set_output_delay 0 -clock clk [all_outputs]
+
+report_checks -path_delay max -digits 3 > $out/critical_path.txt
+report_worst_slack -max -digits 3 > $out/worst_slack.txt
+
+proc read_file {path} {
+    set f [open $path r]
+    set text [read $f]
+    close $f
+    return $text
+}
+
+set slack 0
+regexp {worst slack\s+(-?[0-9.]+)} [read_file $out/worst_slack.txt] -> slack
+set path [read_file $out/critical_path.txt]
+set startpoint ""
+set endpoint ""
+regexp {Startpoint:\s+(\S+)} $path -> startpoint
+regexp {Endpoint:\s+(\S+)} $path -> endpoint
+
+# The worst path takes period - slack, so that's the shortest period that works
+set fmax_khz [expr {int(1e6 / ($period - $slack))}]
+
+set f [open $out/timing.json w]
+puts $f [format {{"period_ns": %s, "worst_slack_ns": %s, "fmax_khz": %d, "startpoint": "%s", "endpoint": "%s"}} \
+    $period $slack $fmax_khz $startpoint $endpoint]
+close $f
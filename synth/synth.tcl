@@ -0,0 +1,45 @@
+# Yosys synthesis of one module, run by the `synth` target
+#
+#     yosys -c synth/synth.tcl
+#
+# Environment:
+#     PIO_SYNTH_TOP      module to synthesise
+#     PIO_SYNTH_SRCS     space-separated sources (SystemVerilog, or sv2v output)
+#     PIO_SYNTH_INCLUDE  include directory for types.svh
+#     PIO_SYNTH_OUT      output directory
+#     PIO_LIBERTY        liberty file to map to, optional
+#
+# Writes stat.json (cell counts, and area when mapped to a liberty) and, when
+# mapped, netlist.v for sta.tcl. Without a liberty the design is mapped to
+# generic gates, so the cell count is still comparable between commits.
+
+yosys -import
+
+set top $::env(PIO_SYNTH_TOP)
+set out $::env(PIO_SYNTH_OUT)
+set liberty ""
+if {[info exists ::env(PIO_LIBERTY)]} {
+    set liberty $::env(PIO_LIBERTY)
+}
+
+foreach src $::env(PIO_SYNTH_SRCS) {
+    read_verilog -sv -I$::env(PIO_SYNTH_INCLUDE) $src
+}
+hierarchy -check -top $top
+
+# The pads are outside the chip, so the GPIO tristates become plain logic
+tribuf -logic
+synth -top $top -flatten
+
+if {$liberty ne ""} {
+    dfflibmap -liberty $liberty
+    abc -liberty $liberty
+    setundef -zero
+    opt_clean -purge
+    tee -q -o $out/stat.json stat -json -liberty $liberty
+    write_verilog -noattr -noexpr $out/netlist.v
+} else {
+    abc -g AND,NAND,OR,NOR,XOR,XNOR,MUX
+    opt_clean -purge
+    tee -q -o $out/stat.json stat -json
+}
@@ -0,0 +1,232 @@
+#ifndef FSM_DIFF_H
+#define FSM_DIFF_H
+
+// Differential run of the verilated fsm (through test_wrapper) against
+// fsm_model.h
+//
+// The input bytes are a program plus what the host does each cycle:
+//
+//     u8           config: bit 0 autopull, bit 1 out_shiftdir, bits 6:2 pull_thresh
+//     u24          EXECCTRL, little-endian: bits 4:0 wrap_target, 9:5 wrap,
+//                  14:10 jmp_pin, 15 status_sel, 19:16 status_n, the
+//                  state machine's number in bits 21:20, and SHIFTCTRL's
+//                  FJOIN_RX_GET and FJOIN_RX_PUT in bits 22 and 23
+//     u16          PINCTRL, little-endian: bits 4:0 in_base, 9:5 out_base,
+//                  15:10 out_count
+//     u8           program length - 1 (low 5 bits)
+//     u16 * len    instructions, little-endian. The rest of memory is jmp 0,
+//                  as it is after reset.
+//     u8 *         one per cycle: bit 0 push to TXF, bit 1 pop RXF, bit 2
+//                  change the input pins, bit 3 clear SM_ENABLE, bit 4 pulse
+//                  SM_RESTART, bit 5 change the IRQ flags, bit 6 write an RX
+//                  FIFO entry through RXFx_PUTGETy. A push or put takes its
+//                  data from the next 4 bytes (one word, shared, as on the
+//                  bus), a put its entry from the byte after that, then new
+//                  pins from the next 4, then new IRQ flags (own, prev, next)
+//                  from 3 more.
+//
+// Short inputs are fine, whatever is missing reads as zero. After each clock
+// pc, X, Y, the OSR, the shift count, the ISR, the output pins, both FIFOs'
+// contents, every RX FIFO entry and the IRQ flags set and cleared on that
+// clock are compared.
+//
+// Templated on the model like PioBus. The model is reset rather than rebuilt
+// for every input, so libFuzzer can run it persistently.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "fsm_model.h"
+
+template <typename Uut>
+class FsmDiff {
+public:
+    static constexpr uint64_t kMaxCycles = 4096;
+
+    explicit FsmDiff(Uut &uut) : uut_(uut) {}
+
+    // Empty if the two agreed, otherwise a description of the first divergence
+    std::string run(const uint8_t *data, std::size_t size) {
+        data_ = data;
+        size_ = size;
+        pos_ = 0;
+
+        const uint8_t config = next_byte();
+        fsm_model::Config c;
+        c.autopull = config & 1;
+        c.out_shiftdir = config >> 1 & 1;
+        c.pull_thresh = config >> 2 & 0x1F;
+        uint32_t exec = 0;
+        for (int i = 0; i < 3; i++) exec |= static_cast<uint32_t>(next_byte()) << 8 * i;
+        c.wrap_target = exec & 0x1F;
+        c.wrap = exec >> 5 & 0x1F;
+        c.jmp_pin = exec >> 10 & 0x1F;
+        c.status_sel = exec >> 15 & 1;
+        c.status_n = exec >> 16 & 0xF;
+        c.sm_index = exec >> 20 & 3;
+        c.rx_get = exec >> 22 & 1;
+        c.rx_put = exec >> 23 & 1;
+        const uint8_t pinctrl_low = next_byte();
+        const uint16_t pinctrl = static_cast<uint16_t>(pinctrl_low | next_byte() << 8);
+        c.in_base = pinctrl & 0x1F;
+        c.out_base = pinctrl >> 5 & 0x1F;
+        c.out_count = pinctrl >> 10 & 0x3F;
+        const unsigned length = (next_byte() & 0x1F) + 1;
+        for (unsigned i = 0; i < 32; i++) {
+            program_[i] = 0; // jmp 0
+            if (i < length) {
+                const uint8_t low = next_byte();
+                program_[i] = static_cast<uint16_t>(low | next_byte() << 8);
+            }
+        }
+
+        uut_.autopull = c.autopull;
+        uut_.out_shiftdir = c.out_shiftdir;
+        uut_.pull_thresh = c.pull_thresh;
+        uut_.fsm_rx_put = c.rx_put;
+        uut_.fsm_rx_get = c.rx_get;
+        uut_.fsm_execctrl = static_cast<uint32_t>(c.jmp_pin) << 24 | c.wrap << 12 | c.wrap_target << 7 |
+            c.status_sel << 4 | c.status_n;
+        uut_.fsm_pinctrl = static_cast<uint32_t>(c.out_count) << 20 | c.in_base << 15 | c.out_base;
+        uut_.fsm_gpio_input = 0;
+        uut_.fsm_sm_index = c.sm_index;
+        uut_.fsm_irq_flags = 0;
+        uut_.fsm_enable = 1;
+        uut_.fsm_restart = 0;
+        uut_.external_push_en = 0;
+        uut_.external_pop_en = 0;
+        uut_.external_put_en = 0;
+        uut_.instruction = program_[0];
+        uut_.clk = 0;
+        uut_.rst = 1;
+        uut_.eval();
+        uut_.rst = 0;
+        uut_.eval();
+        model_.configure(c);
+        model_.reset();
+
+        fsm_model::Inputs in;
+        irq_set_ = 0;
+        irq_clr_ = 0;
+        std::string divergence = compare(0);
+        for (uint64_t cycle = 1; divergence.empty() && pos_ < size_ && cycle <= kMaxCycles; cycle++) {
+            // The pins and IRQ flags hold their value until the input changes them
+            const uint8_t host = next_byte();
+            in.push_en = host & 1;
+            in.pop_en = host >> 1 & 1;
+            in.put_en = host >> 6 & 1;
+            in.push_data = in.push_en || in.put_en ? next_word() : 0;
+            in.put_index = in.put_en ? next_byte() & 3 : 0;
+            if (host & 4) in.pins = next_word();
+            if (host & 32) {
+                in.irq_flags = 0;
+                for (int i = 0; i < 3; i++) in.irq_flags |= static_cast<uint32_t>(next_byte()) << 8 * i;
+            }
+            in.enable = !(host & 8);
+            in.restart = host & 16;
+
+            uut_.clk = 0;
+            uut_.external_push_en = in.push_en;
+            uut_.external_data_in = in.push_data;
+            uut_.external_pop_en = in.pop_en;
+            uut_.external_put_en = in.put_en;
+            uut_.external_put_index = in.put_index;
+            uut_.fsm_gpio_input = in.pins;
+            uut_.fsm_irq_flags = in.irq_flags;
+            uut_.fsm_enable = in.enable;
+            uut_.fsm_restart = in.restart;
+            uut_.instruction = program_[uut_.fsm_pc];
+            uut_.eval();
+            // IRQ requests are combinational, so catch them before the edge
+            irq_set_ = uut_.fsm_irq_set;
+            irq_clr_ = uut_.fsm_irq_clr;
+            model_.step(program_[model_.pc], in);
+            uut_.clk = 1;
+            uut_.eval();
+
+            divergence = compare(cycle);
+        }
+        return divergence;
+    }
+
+    const fsm_model::Fsm &model() const { return model_; }
+
+private:
+    uint8_t next_byte() { return pos_ < size_ ? data_[pos_++] : 0; }
+
+    uint32_t next_word() {
+        uint32_t word = 0;
+        for (int i = 0; i < 4; i++) word |= static_cast<uint32_t>(next_byte()) << 8 * i;
+        return word;
+    }
+
+    std::string compare(uint64_t cycle) {
+        char what[128] = "";
+        const fsm_model::Fsm &m = model_;
+        if (uut_.fsm_pc != m.pc) {
+            std::snprintf(what, sizeof(what), "pc %u, model %u", unsigned(uut_.fsm_pc), unsigned(m.pc));
+        } else if (uut_.x != m.x) {
+            std::snprintf(what, sizeof(what), "x %08x, model %08x", unsigned(uut_.x), m.x);
+        } else if (uut_.y != m.y) {
+            std::snprintf(what, sizeof(what), "y %08x, model %08x", unsigned(uut_.y), m.y);
+        } else if (uut_.osr_data != m.osr) {
+            std::snprintf(what, sizeof(what), "osr %08x, model %08x", unsigned(uut_.osr_data), m.osr);
+        } else if (uut_.out_shift_counter != m.shift_count) {
+            std::snprintf(what, sizeof(what), "shift count %u, model %u", unsigned(uut_.out_shift_counter),
+                unsigned(m.shift_count));
+        } else if (uut_.fsm_isr != m.isr) {
+            std::snprintf(what, sizeof(what), "isr %08x, model %08x", unsigned(uut_.fsm_isr), m.isr);
+        } else if (uut_.fsm_pin_output != m.pin_output) {
+            std::snprintf(what, sizeof(what), "pins %08x, model %08x", unsigned(uut_.fsm_pin_output), m.pin_output);
+        } else if (irq_set_ != m.irq_set || irq_clr_ != m.irq_clr) {
+            std::snprintf(what, sizeof(what), "irq set %06x clear %06x, model set %06x clear %06x", irq_set_,
+                irq_clr_, m.irq_set, m.irq_clr);
+        } else if (!same_fifo(uut_.fsm_tx_count, uut_.fsm_tx_tail, uut_.fsm_tx_memory, m.tx)) {
+            std::snprintf(what, sizeof(what), "tx fifo (%u entries), model (%u entries)", unsigned(uut_.fsm_tx_count),
+                m.tx.count);
+        } else if (!same_fifo(uut_.fsm_rx_count, uut_.fsm_rx_tail, uut_.fsm_rx_memory, m.rx)) {
+            std::snprintf(what, sizeof(what), "rx fifo (%u entries), model (%u entries)", unsigned(uut_.fsm_rx_count),
+                m.rx.count);
+        } else if (unsigned entry = different_entry(uut_.fsm_rx_memory, m.rx); entry < 4) {
+            std::snprintf(what, sizeof(what), "rx entry %u %08x, model %08x", entry,
+                unsigned(uut_.fsm_rx_memory[entry]), m.rx.data[entry]);
+        } else {
+            return {};
+        }
+
+        char where[64];
+        std::snprintf(where, sizeof(where), "cycle %llu, instruction %04x: ", static_cast<unsigned long long>(cycle),
+            unsigned(uut_.instruction));
+        return std::string(where) + what;
+    }
+
+    template <typename Memory>
+    static bool same_fifo(unsigned count, unsigned tail, const Memory &memory, const fsm_model::Fifo &fifo) {
+        if (count != fifo.count) return false;
+        for (unsigned i = 0; i < count; i++) {
+            if (memory[(tail + i) % 4] != fifo.at(i)) return false;
+        }
+        return true;
+    }
+
+    // The first entry, in storage order, that differs, or 4. The random access
+    // modes reach entries that aren't in the queue.
+    template <typename Memory>
+    static unsigned different_entry(const Memory &memory, const fsm_model::Fifo &fifo) {
+        unsigned i = 0;
+        while (i < 4 && memory[i] == fifo.data[i]) i++;
+        return i;
+    }
+
+    Uut &uut_;
+    fsm_model::Fsm model_;
+    uint16_t program_[32] = {};
+    uint32_t irq_set_ = 0, irq_clr_ = 0;
+    const uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t pos_ = 0;
+};
+
+#endif // FSM_DIFF_H
@@ -0,0 +1,386 @@
+#ifndef FSM_MODEL_H
+#define FSM_MODEL_H
+
+// Cycle-level C++ model of one state machine (src/fsm.sv)
+//
+// Written from the instruction set and this chip's pipeline rather than
+// translated from the RTL, so the two can be run side by side and compared,
+// see fsm_diff.h. It follows the chip where the chip knowingly differs from
+// the RP2040:
+// - pc_en, jump_en and jump are registered, and the program counter moves on
+//   the edge after. The first instruction after reset issues twice, the
+//   instruction after a taken JMP still issues, and a stall holds whatever
+//   instruction the pc has moved on to.
+// - MOV EXEC holds the pc for the cycle the moved instruction runs in.
+// - IN, WAIT GPIO and WAIT PIN are no-ops. Without IN the input shift count
+//   stays at zero, so PUSH IFFULL never pushes.
+// - IRQ flags live outside the state machine. It sees them as an input and
+//   reports the flags it sets and clears, see Inputs::irq_flags.
+// - Pin directions can't be set yet, MOV PINS only changes the output values.
+// - SM_RESTART also puts the pc back to the wrap target and clears X and Y.
+
+#include <cstdint>
+
+namespace fsm_model {
+
+struct Config {
+    bool autopull = false;
+    bool out_shiftdir = true; // 1 = right
+    uint8_t pull_thresh = 0; // 0 encodes 32
+    // SHIFTCTRL_FJOIN_RX_PUT/GET, the RX FIFO's entries as registers
+    bool rx_put = false;
+    bool rx_get = false;
+    // EXECCTRL
+    uint8_t wrap_target = 0; // WRAP_BOTTOM, also where the pc starts
+    uint8_t wrap = 31; // WRAP_TOP
+    uint8_t jmp_pin = 0;
+    bool status_sel = false; // 1 = RX level
+    uint8_t status_n = 0;
+    // PINCTRL
+    uint8_t in_base = 0;
+    uint8_t out_base = 0;
+    uint8_t out_count = 0;
+    uint8_t sm_index = 0; // For IRQ REL
+};
+
+// What the host does on a cycle
+struct Inputs {
+    bool push_en = false; // Write to TXF
+    uint32_t push_data = 0;
+    bool pop_en = false; // Read from RXF
+    // Write to RXFx_PUTGETy entry put_index. The bus carries one word a
+    // cycle, so this writes push_data.
+    bool put_en = false;
+    uint8_t put_index = 0;
+    uint32_t pins = 0; // Synchronised GPIO inputs
+    bool enable = true; // CTRL_SM_ENABLE
+    bool restart = false; // CTRL_SM_RESTART
+    // IRQ flags: this core's in bits 7:0, the previous core's in 15:8 and
+    // the next core's in 23:16
+    uint32_t irq_flags = 0;
+};
+
+// Four-entry first-word-fall-through FIFO
+struct Fifo {
+    uint32_t data[4] = {};
+    unsigned head = 0; // Oldest entry
+    unsigned count = 0;
+
+    uint32_t at(unsigned i) const { return data[(head + i) % 4]; }
+    bool full() const { return count == 4; }
+
+    // A push into an empty FIFO can be popped on the same cycle
+    bool valid(bool push_en) const { return count || push_en; }
+    uint32_t front(bool push_en, uint32_t push_data) const { return count ? data[head] : push_en ? push_data : 0; }
+
+    // Random access, by where the entry is stored rather than from the head
+    void put(unsigned index, uint32_t value) { data[index % 4] = value; }
+
+    void update(bool push_en, uint32_t push_data, bool pop_en) {
+        // A full FIFO takes a push on a cycle it's popped
+        const bool pop = pop_en && valid(push_en);
+        const bool push = push_en && (!full() || pop);
+        if (push) data[(head + count++) % 4] = push_data;
+        if (pop) {
+            head = (head + 1) % 4;
+            count--;
+        }
+    }
+};
+
+class Fsm {
+public:
+    Fsm() = default;
+    explicit Fsm(const Config &config) : pc(config.wrap_target), config_(config) {}
+
+    void reset() { *this = Fsm(config_); }
+
+    // Back to the state after reset, keeping the FIFOs, the OSR and the pins
+    void restart() {
+        Fsm fresh(config_);
+        fresh.osr = osr;
+        fresh.pin_output = pin_output;
+        fresh.tx = tx;
+        fresh.rx = rx;
+        *this = fresh;
+    }
+    void configure(const Config &config) { config_ = config; }
+
+    // One clock edge, with `instruction` the word at pc. A pending MOV EXEC
+    // runs instead.
+    void step(uint16_t instruction, const Inputs &in) {
+        irq_set = 0;
+        irq_clr = 0;
+
+        // Only the host touches the FIFOs while disabled or restarting
+        if (!in.enable || in.restart) {
+            tx.update(in.push_en, in.push_data, false);
+            rx.update(false, 0, in.pop_en);
+            if (in.put_en) rx.put(in.put_index, in.push_data);
+            if (in.restart) restart();
+            return;
+        }
+
+        const uint16_t instr = exec_en_ ? exec_instr_ : instruction;
+        const unsigned op = instr >> 13;
+        const unsigned arg1 = instr >> 5 & 7;
+        const unsigned arg2 = instr & 0x1F;
+        const unsigned thresh = config_.pull_thresh ? config_.pull_thresh : 32;
+        const unsigned bit_count = arg2 ? arg2 : 32;
+        const bool osr_empty = shift_count >= thresh;
+
+        const bool tx_valid = tx.valid(in.push_en);
+        const uint32_t tx_front = tx.front(in.push_en, in.push_data);
+        const bool rx_blocked = rx.full() && !in.pop_en;
+        const bool block = instr & 0x20;
+        const bool if_flag = instr & 0x40; // IfEmpty for PULL, IfFull for PUSH
+
+        // Flag addressed by IRQ and WAIT IRQ, as a bit of Inputs::irq_flags
+        const unsigned irq_mode = instr >> 3 & 3;
+        const unsigned irq_index = irq_mode == kIrqRel ? (instr & 4) | ((instr + config_.sm_index) & 3) : instr & 7;
+        const unsigned irq_bit = (irq_mode == kIrqPrev ? 8 : irq_mode == kIrqNext ? 16 : 0) + irq_index;
+        const bool irq_flag = in.irq_flags >> irq_bit & 1;
+
+        // Issue
+        bool next_pc_en = true;
+        bool next_jump_en = false;
+        uint8_t next_jump = jump_;
+        bool next_tx_stall = false;
+        bool next_rx_stall = false;
+
+        // Datapath
+        uint32_t next_x = x, next_y = y;
+        bool pull = false; // Pop the TX FIFO into the OSR
+        bool load = false;
+        uint32_t load_data = 0;
+        bool clear_count = false;
+        bool shift = false;
+        bool refill = false; // OUT shifts out of the TX FIFO head into an empty OSR
+        bool push = false;
+        bool rx_put = false; // MOV RXFIFO[], ISR
+        unsigned rx_index = 0;
+        uint32_t next_isr = isr;
+        uint32_t next_pins = pin_output;
+        bool next_exec_en = false;
+        bool next_irq_waiting = false;
+
+        switch (op) {
+        case kJmp: {
+            next_jump = arg2;
+            switch (arg1) {
+            case 0: next_jump_en = true; break;
+            case 1: next_jump_en = x == 0; break;
+            case 2: next_jump_en = x != 0; next_x = x - 1; break;
+            case 3: next_jump_en = y == 0; break;
+            case 4: next_jump_en = y != 0; next_y = y - 1; break;
+            case 5: next_jump_en = x != y; break;
+            case 6: next_jump_en = in.pins >> config_.jmp_pin & 1; break;
+            case 7: next_jump_en = !osr_empty; break;
+            }
+            break;
+        }
+        case kOut:
+            if (config_.autopull && osr_empty && !tx_valid) {
+                // Stall until there's a word to refill the OSR with
+                next_pc_en = false;
+                next_tx_stall = true;
+            } else {
+                // An empty OSR refills and the new word shifts out on the same edge
+                refill = config_.autopull && osr_empty;
+                shift = true;
+                pull = !refill && config_.autopull && shift_count + bit_count >= thresh && tx_valid;
+                const uint32_t source = refill ? tx_front : osr;
+                if (arg1 == 1) next_x = shift_out(source, bit_count);
+                if (arg1 == 2) next_y = shift_out(source, bit_count);
+            }
+            break;
+        case kPushPull:
+            if (instr & 0x10) {
+                // MOV RXFIFO[], ISR and MOV OSR, RXFIFO[], indexed by Y or
+                // the instruction. Neither stalls or touches the ISR.
+                rx_index = (instr & 8 ? instr : y) & 3;
+                if (!(instr & 0x80)) {
+                    rx_put = config_.rx_put;
+                } else if (config_.rx_get) {
+                    load = true;
+                    load_data = rx.data[rx_index];
+                    clear_count = true;
+                }
+            } else if (!(instr & 0x80)) {
+                if (rx_blocked) {
+                    next_pc_en = !block;
+                    next_rx_stall = block;
+                } else {
+                    push = !if_flag;
+                }
+            } else if (if_flag && !osr_empty) {
+                // Still data left to shift out
+            } else if (tx_valid) {
+                pull = true;
+            } else if (block) {
+                next_pc_en = false;
+                next_tx_stall = true;
+            } else {
+                load = true;
+                load_data = x;
+                clear_count = true;
+            }
+            break;
+        case kMov: {
+            const uint32_t value = mov_value(instr, in.pins);
+            switch (arg1) {
+            case kMovPins:
+                for (unsigned i = 0; i < 32 && i < config_.out_count; i++) {
+                    const unsigned pin = (config_.out_base + i) % 32;
+                    next_pins = (next_pins & ~(1u << pin)) | (value >> i & 1) << pin;
+                }
+                break;
+            case kMovX: next_x = value; break;
+            case kMovY: next_y = value; break;
+            case kMovExec:
+                next_pc_en = false;
+                next_exec_en = true;
+                exec_instr_ = static_cast<uint16_t>(value);
+                break;
+            case kMovPc:
+                next_jump_en = true;
+                next_jump = value & 0x1F;
+                break;
+            case kMovIsr: next_isr = value; break;
+            case kMovOsr:
+                load = true;
+                load_data = value;
+                clear_count = true;
+                break;
+            }
+            break;
+        }
+        case kSet:
+            if (arg1 == 1) next_x = arg2;
+            if (arg1 == 2) next_y = arg2;
+            break;
+        case kWait:
+            if ((arg1 & 3) == kWaitIrq) {
+                const bool polarity = instr & 0x80;
+                next_pc_en = irq_flag == polarity;
+                if (polarity && irq_flag) irq_clr = 1u << irq_bit;
+            }
+            pull = config_.autopull && osr_empty && tx_valid;
+            break;
+        case kIrq:
+            if (instr & 0x40) {
+                irq_clr = 1u << irq_bit;
+            } else if (!(instr & 0x20)) {
+                irq_set = 1u << irq_bit;
+            } else {
+                // IRQ WAIT sets the flag once, then waits for it to clear
+                if (!irq_waiting_) irq_set = 1u << irq_bit;
+                next_pc_en = irq_waiting_ && !irq_flag;
+                next_irq_waiting = !next_pc_en;
+            }
+            pull = config_.autopull && osr_empty && tx_valid;
+            break;
+        default:
+            // IN does nothing yet, but autopull still refills
+            pull = config_.autopull && osr_empty && tx_valid;
+            break;
+        }
+
+        if (pull) {
+            load = true;
+            load_data = tx_front;
+            clear_count = true;
+        }
+
+        // Clock edge
+        if (pc_en_) pc = jump_en_ ? jump_ : pc == config_.wrap ? config_.wrap_target : (pc + 1) % 32;
+        pc_en_ = next_pc_en;
+        jump_en_ = next_jump_en;
+        jump_ = next_jump;
+        tx_stall = next_tx_stall;
+        rx_stall = next_rx_stall;
+        x = next_x;
+        y = next_y;
+
+        if (load) osr = load_data;
+        else if (shift) osr = shifted(refill ? tx_front : osr, bit_count);
+        if (clear_count) shift_count = 0;
+        else if (refill) shift_count = bit_count;
+        else if (shift) shift_count = shift_count + bit_count > 32 ? 32 : shift_count + bit_count;
+
+        tx.update(in.push_en, in.push_data, pull || refill);
+        rx.update(push, isr, in.pop_en);
+        // The state machine's put wins over the host's
+        if (rx_put) rx.put(rx_index, isr);
+        else if (in.put_en) rx.put(in.put_index, in.push_data);
+        isr = push ? 0 : next_isr;
+        pin_output = next_pins;
+        exec_en_ = next_exec_en;
+        irq_waiting_ = next_irq_waiting;
+    }
+
+    uint8_t pc = 0;
+    uint32_t x = 0, y = 0;
+    uint32_t osr = 0;
+    uint32_t isr = 0;
+    uint32_t pin_output = 0;
+    uint8_t shift_count = 0;
+    bool tx_stall = false, rx_stall = false;
+    Fifo tx, rx;
+    // IRQ flags set and cleared on the last edge, laid out like Inputs::irq_flags
+    uint32_t irq_set = 0, irq_clr = 0;
+
+private:
+    enum : unsigned { kJmp = 0, kWait, kIn, kOut, kPushPull, kMov, kIrq, kSet };
+    // MOV sources and destinations share an encoding, apart from 4 and 5
+    enum : unsigned { kMovPins = 0, kMovX, kMovY, kMovNull, kMovExec, kMovPc, kMovIsr, kMovOsr };
+    static constexpr unsigned kMovStatus = kMovPc;
+    static constexpr unsigned kWaitIrq = 2;
+    enum : unsigned { kIrqOwn = 0, kIrqPrev, kIrqRel, kIrqNext };
+
+    // Source with the operation applied
+    uint32_t mov_value(uint16_t instr, uint32_t pins) const {
+        uint32_t value = 0; // NULL, and the reserved source 4
+        switch (instr & 7) {
+        case kMovPins: value = config_.in_base ? pins >> config_.in_base | pins << (32 - config_.in_base) : pins; break;
+        case kMovX: value = x; break;
+        case kMovY: value = y; break;
+        case kMovStatus: value = (config_.status_sel ? rx.count : tx.count) < config_.status_n ? ~0u : 0; break;
+        case kMovIsr: value = isr; break;
+        case kMovOsr: value = osr; break;
+        }
+        switch (instr >> 3 & 3) {
+        case 1: return ~value;
+        case 2: return reversed(value);
+        default: return value;
+        }
+    }
+
+    static uint32_t reversed(uint32_t value) {
+        uint32_t out = 0;
+        for (int i = 0; i < 32; i++, value >>= 1) out = out << 1 | (value & 1);
+        return out;
+    }
+
+    uint32_t shift_out(uint32_t value, unsigned n) const {
+        if (n == 32) return value;
+        return config_.out_shiftdir ? value & ((1u << n) - 1) : value >> (32 - n);
+    }
+
+    uint32_t shifted(uint32_t value, unsigned n) const {
+        if (n == 32) return 0;
+        return config_.out_shiftdir ? value >> n : value << n;
+    }
+
+    Config config_;
+    bool pc_en_ = false;
+    bool jump_en_ = false;
+    uint8_t jump_ = 0;
+    bool exec_en_ = false;
+    uint16_t exec_instr_ = 0;
+    bool irq_waiting_ = false;
+};
+
+} // namespace fsm_model
+
+#endif // FSM_MODEL_H
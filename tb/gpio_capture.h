@@ -0,0 +1,271 @@
+#ifndef GPIO_CAPTURE_H
+#define GPIO_CAPTURE_H
+
+// GPIO logic analyzer for simulation
+//
+// Samples the pad-side buses once per clock and keeps only the cycles where
+// something changed, so storage scales with the number of edges instead of the
+// length of the run. Each Edge holds until the next one (run-length encoding).
+//
+// A capture can be saved as a flat file of Edges (see CaptureHeader), which
+// gpio_stimulus.h can play back, or exported to sigrok's .sr format to run
+// PulseView's protocol decoders over it. The .sr format stores every
+// sample, so the export is expanded to one sample per cycle.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gpio_capture {
+
+constexpr char kMagic[8] = {'P', 'I', 'O', 'G', 'P', 'I', 'O', '\0'};
+constexpr uint32_t kVersion = 1;
+
+// File layout: CaptureHeader followed by edge_count Edges, little-endian
+struct CaptureHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t cycles; // Length of the capture, the last Edge holds until here
+    uint64_t edge_count;
+};
+
+struct Edge {
+    uint64_t cycle;
+    uint32_t gpio; // What the chip sees on its pads
+    uint32_t output; // gpio_output from the core output arbitrator
+    uint32_t drive; // gpio_drive, 1 = the chip drives the pin
+    uint32_t reserved;
+
+    // The level on each pad, whoever is driving it
+    uint32_t level() const { return (drive & output) | (~drive & gpio); }
+};
+
+static_assert(sizeof(CaptureHeader) == 32);
+static_assert(sizeof(Edge) == 24);
+
+namespace detail {
+
+inline uint32_t crc32(const uint8_t *data, std::size_t size, uint32_t crc = 0) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Just enough of ZIP to write a .sr file: stored (uncompressed) entries, no ZIP64
+class ZipWriter {
+public:
+    explicit ZipWriter(const std::string &path) {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) throw std::runtime_error("can't open " + path);
+    }
+
+    ZipWriter(const ZipWriter &) = delete;
+    ZipWriter &operator=(const ZipWriter &) = delete;
+
+    ~ZipWriter() {
+        if (file_) std::fclose(file_);
+    }
+
+    void add(const std::string &name, const uint8_t *data, std::size_t size) {
+        if (offset_ + size > 0xFFFFFFFFull - 0x10000) throw std::runtime_error("capture too large for a .sr file");
+
+        Entry entry{name, detail::crc32(data, size), static_cast<uint32_t>(size), static_cast<uint32_t>(offset_)};
+        std::vector<uint8_t> header;
+        put32(header, 0x04034B50);
+        put16(header, 20); // Version needed
+        put16(header, 0); // Flags
+        put16(header, 0); // Stored
+        put32(header, 0); // Time, date
+        put32(header, entry.crc);
+        put32(header, entry.size);
+        put32(header, entry.size);
+        put16(header, static_cast<uint16_t>(name.size()));
+        put16(header, 0);
+        header.insert(header.end(), name.begin(), name.end());
+
+        write(header.data(), header.size());
+        write(data, size);
+        entries_.push_back(entry);
+    }
+
+    void add(const std::string &name, const std::string &text) {
+        add(name, reinterpret_cast<const uint8_t *>(text.data()), text.size());
+    }
+
+    void close() {
+        const uint64_t directory = offset_;
+        std::vector<uint8_t> out;
+        for (const Entry &entry : entries_) {
+            put32(out, 0x02014B50);
+            put16(out, 20); // Version made by
+            put16(out, 20); // Version needed
+            put16(out, 0);
+            put16(out, 0);
+            put32(out, 0);
+            put32(out, entry.crc);
+            put32(out, entry.size);
+            put32(out, entry.size);
+            put16(out, static_cast<uint16_t>(entry.name.size()));
+            put16(out, 0); // Extra
+            put16(out, 0); // Comment
+            put16(out, 0); // Disk
+            put16(out, 0); // Internal attributes
+            put32(out, 0); // External attributes
+            put32(out, entry.offset);
+            out.insert(out.end(), entry.name.begin(), entry.name.end());
+        }
+        const std::size_t directory_size = out.size();
+        put32(out, 0x06054B50);
+        put16(out, 0);
+        put16(out, 0);
+        put16(out, static_cast<uint16_t>(entries_.size()));
+        put16(out, static_cast<uint16_t>(entries_.size()));
+        put32(out, static_cast<uint32_t>(directory_size));
+        put32(out, static_cast<uint32_t>(directory));
+        put16(out, 0);
+
+        write(out.data(), out.size());
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        uint32_t crc;
+        uint32_t size;
+        uint32_t offset;
+    };
+
+    static void put16(std::vector<uint8_t> &out, uint16_t value) {
+        out.push_back(value & 0xFF);
+        out.push_back(value >> 8);
+    }
+
+    static void put32(std::vector<uint8_t> &out, uint32_t value) {
+        put16(out, value & 0xFFFF);
+        put16(out, value >> 16);
+    }
+
+    void write(const uint8_t *data, std::size_t size) {
+        if (size && std::fwrite(data, 1, size, file_) != size) throw std::runtime_error("write failed");
+        offset_ += size;
+    }
+
+    std::FILE *file_ = nullptr;
+    uint64_t offset_ = 0;
+    std::vector<Entry> entries_;
+};
+
+} // namespace detail
+
+class Capture {
+public:
+    // Call once per clock, unchanged samples aren't stored
+    void sample(uint64_t cycle, uint32_t gpio, uint32_t output, uint32_t drive) {
+        cycles_ = cycle + 1;
+        if (!edges_.empty()) {
+            const Edge &last = edges_.back();
+            if (last.gpio == gpio && last.output == output && last.drive == drive) return;
+        }
+        edges_.push_back({cycle, gpio, output, drive, 0});
+    }
+
+    // Ends the capture at `cycles`, for runs that stopped sampling early
+    // because nothing more could change
+    void finish(uint64_t cycles) { cycles_ = std::max(cycles_, cycles); }
+
+    const std::vector<Edge> &edges() const { return edges_; }
+    uint64_t cycles() const { return cycles_; }
+
+    void save(const std::string &path) const {
+        std::FILE *file = std::fopen(path.c_str(), "wb");
+        if (!file) throw std::runtime_error("can't open " + path);
+
+        CaptureHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.cycles = cycles_;
+        header.edge_count = edges_.size();
+        std::fwrite(&header, sizeof(header), 1, file);
+        std::fwrite(edges_.data(), sizeof(Edge), edges_.size(), file);
+        std::fclose(file);
+    }
+
+    // Writes a sigrok session with one channel per pad level (GPIO0-31), plus
+    // one per drive enable (DIR0-31) if with_drive is set
+    void export_sigrok(const std::string &path, uint64_t samplerate_hz, bool with_drive = false) const {
+        const unsigned unitsize = with_drive ? 8 : 4;
+        const unsigned channels = with_drive ? 64 : 32;
+
+        std::string metadata = "[global]\nsigrok version=0.5.2\n\n[device 1]\ncapturefile=logic-1\n";
+        metadata += "total probes=" + std::to_string(channels) + "\n";
+        metadata += "samplerate=" + std::to_string(samplerate_hz) + " Hz\n";
+        metadata += "total analog=0\n";
+        for (unsigned i = 0; i < channels; i++) {
+            metadata += "probe" + std::to_string(i + 1) + "=" + (i < 32 ? "GPIO" : "DIR") + std::to_string(i % 32) +
+                "\n";
+        }
+        metadata += "unitsize=" + std::to_string(unitsize) + "\n";
+
+        detail::ZipWriter zip(path);
+        zip.add("version", "2");
+        zip.add("metadata", metadata);
+
+        // Expand the runs into chunk files the size sigrok itself writes
+        constexpr std::size_t kChunkSize = 4 << 20;
+        std::vector<uint8_t> chunk;
+        chunk.reserve(kChunkSize);
+        unsigned chunk_index = 1;
+        auto flush = [&] {
+            zip.add("logic-1-" + std::to_string(chunk_index++), chunk.data(), chunk.size());
+            chunk.clear();
+        };
+
+        for (std::size_t i = 0; i < edges_.size(); i++) {
+            const Edge &edge = edges_[i];
+            const uint64_t end = i + 1 < edges_.size() ? edges_[i + 1].cycle : cycles_;
+            const uint32_t words[2] = {edge.level(), edge.drive};
+            uint8_t unit[8];
+            std::memcpy(unit, words, unitsize);
+
+            // Cycles before the first edge read as 0
+            if (i == 0) {
+                for (uint64_t c = 0; c < edge.cycle; c++) {
+                    chunk.insert(chunk.end(), unitsize, 0);
+                    if (chunk.size() + unitsize > kChunkSize) flush();
+                }
+            }
+            for (uint64_t c = edge.cycle; c < end; c++) {
+                chunk.insert(chunk.end(), unit, unit + unitsize);
+                if (chunk.size() + unitsize > kChunkSize) flush();
+            }
+        }
+        if (!chunk.empty()) flush();
+        zip.close();
+    }
+
+private:
+    std::vector<Edge> edges_;
+    uint64_t cycles_ = 0;
+};
+
+} // namespace gpio_capture
+
+#endif // GPIO_CAPTURE_H
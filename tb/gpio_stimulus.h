@@ -0,0 +1,124 @@
+#ifndef GPIO_STIMULUS_H
+#define GPIO_STIMULUS_H
+
+// GPIO stimulus playback
+//
+// Replays recorded pin values into the chip's gpio inputs. The file is mapped
+// rather than read, and at() only walks forward through it, so playback does
+// no allocation or copying however long the recording is.
+//
+// Two file formats are accepted:
+// - A capture from gpio_capture.h (run-length encoded, the Edge's gpio field
+//   is replayed). Captures from real hardware can be converted to this format.
+// - Anything else is treated as raw samples, one little-endian u32 per cycle.
+//
+// After the end of the recording the last value is held.
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "gpio_capture.h"
+
+namespace gpio_stimulus {
+
+class Stimulus {
+public:
+    explicit Stimulus(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("can't open " + path);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error(path + " is empty");
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        map_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map_ == MAP_FAILED) throw std::runtime_error("can't map " + path);
+        // Playback is a single forward pass
+        ::madvise(map_, size_, MADV_SEQUENTIAL);
+
+        const auto *bytes = static_cast<const uint8_t *>(map_);
+        gpio_capture::CaptureHeader header;
+        if (size_ >= sizeof(header) && std::memcmp(bytes, gpio_capture::kMagic, sizeof(gpio_capture::kMagic)) == 0) {
+            std::memcpy(&header, bytes, sizeof(header));
+            if (header.version != gpio_capture::kVersion ||
+                size_ < sizeof(header) + header.edge_count * sizeof(gpio_capture::Edge)) {
+                ::munmap(map_, size_);
+                throw std::runtime_error(path + " is not a valid capture");
+            }
+            edges_ = reinterpret_cast<const gpio_capture::Edge *>(bytes + sizeof(header));
+            count_ = header.edge_count;
+            cycles_ = header.cycles;
+        } else {
+            samples_ = static_cast<const uint32_t *>(map_);
+            count_ = size_ / sizeof(uint32_t);
+            cycles_ = count_;
+            if (count_ == 0) {
+                ::munmap(map_, size_);
+                throw std::runtime_error(path + " is shorter than one sample");
+            }
+        }
+    }
+
+    Stimulus(const Stimulus &) = delete;
+    Stimulus &operator=(const Stimulus &) = delete;
+
+    ~Stimulus() { ::munmap(map_, size_); }
+
+    // Pin values for `cycle`. Cycles must not go backwards between calls.
+    uint32_t at(uint64_t cycle) {
+        if (samples_) {
+            return cycle < count_ ? samples_[cycle] : samples_[count_ - 1];
+        }
+        while (next_ < count_ && edges_[next_].cycle <= cycle) {
+            value_ = edges_[next_++].gpio;
+        }
+        return value_;
+    }
+
+    // First cycle after `cycle` whose pin values differ from those at `cycle`,
+    // or UINT64_MAX if they never change again. Same ordering rule as at().
+    uint64_t next_change(uint64_t cycle) {
+        const uint32_t value = at(cycle);
+        if (samples_) {
+            for (uint64_t c = cycle + 1; c < count_; c++) {
+                if (samples_[c] != value) return c;
+            }
+            return UINT64_MAX;
+        }
+        for (uint64_t i = next_; i < count_; i++) {
+            if (edges_[i].gpio != value) return edges_[i].cycle;
+        }
+        return UINT64_MAX;
+    }
+
+    // Overwrites the pins in mask with the recording, leaving the rest alone
+    void apply(uint64_t cycle, uint32_t &pins, uint32_t mask = 0xFFFFFFFF) {
+        pins = (pins & ~mask) | (at(cycle) & mask);
+    }
+
+    // Length of the recording in cycles
+    uint64_t cycles() const { return cycles_; }
+
+private:
+    void *map_ = nullptr;
+    std::size_t size_ = 0;
+    const gpio_capture::Edge *edges_ = nullptr;
+    const uint32_t *samples_ = nullptr;
+    uint64_t count_ = 0;
+    uint64_t cycles_ = 0;
+    uint64_t next_ = 0;
+    uint32_t value_ = 0;
+};
+
+} // namespace gpio_stimulus
+
+#endif // GPIO_STIMULUS_H
@@ -0,0 +1,313 @@
+#ifndef _HARDWARE_PIO_H
+#define _HARDWARE_PIO_H
+
+// hardware_pio for the simulated chip
+//
+// A stand-in for the pico-sdk's hardware/pio.h that drives a verilated
+// pio_chip over its host register bus, so driver code written against the SDK
+// (including pioasm-generated .pio.h headers) builds and runs unmodified. Put
+// this directory ahead of the SDK's hardware_pio include directory and attach
+// a model with pio_shim_attach() (pio_shim.h) before calling anything here.
+//
+// Each register access is one clock of the model. Blocking calls clock it
+// until they can complete.
+//
+// pio0-pio3 are the chip's four cores. Only the API is provided: code that
+// touches pio_hw_t registers directly (pio->txf[sm] = x) won't build.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hardware/pio_instructions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef PICO_PIO_VERSION
+#define PICO_PIO_VERSION 0
+#endif
+
+#define NUM_PIOS 4
+#define NUM_PIO_STATE_MACHINES 4
+#define PIO_INSTRUCTION_COUNT 32
+
+// Allocation state for one core, private to the shim
+typedef struct pio_hw {
+    uint32_t used_instruction_space;
+    uint32_t claimed;
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t pio_shim_instances[NUM_PIOS];
+
+#define pio0 (&pio_shim_instances[0])
+#define pio1 (&pio_shim_instances[1])
+#define pio2 (&pio_shim_instances[2])
+#define pio3 (&pio_shim_instances[3])
+
+typedef struct pio_program {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin; // Required instruction memory origin or -1
+    uint8_t pio_version;
+} pio_program_t;
+
+typedef struct {
+    uint32_t clkdiv;
+    uint32_t execctrl;
+    uint32_t shiftctrl;
+    uint32_t pinctrl;
+} pio_sm_config;
+
+enum pio_fifo_join {
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX = 1,
+    PIO_FIFO_JOIN_RX = 2,
+    // RP2350 RX FIFO random access, see pio_shim_rxf_putget_read()
+    PIO_FIFO_JOIN_RXGET = 4,
+    PIO_FIFO_JOIN_RXPUT = 8,
+    PIO_FIFO_JOIN_PUTGET = 12,
+};
+
+enum pio_mov_status_type {
+    STATUS_TX_LESSTHAN = 0,
+    STATUS_RX_LESSTHAN = 1,
+};
+
+// Register fields, same layout as the RP2040
+#define PIO_SM0_CLKDIV_INT_LSB 16
+#define PIO_SM0_CLKDIV_FRAC_LSB 8
+
+#define PIO_SM0_EXECCTRL_SIDE_EN_BITS (1u << 30)
+#define PIO_SM0_EXECCTRL_SIDE_PINDIR_BITS (1u << 29)
+#define PIO_SM0_EXECCTRL_JMP_PIN_LSB 24
+#define PIO_SM0_EXECCTRL_JMP_PIN_BITS (0x1Fu << 24)
+#define PIO_SM0_EXECCTRL_OUT_EN_SEL_LSB 19
+#define PIO_SM0_EXECCTRL_OUT_EN_SEL_BITS (0x1Fu << 19)
+#define PIO_SM0_EXECCTRL_INLINE_OUT_EN_BITS (1u << 18)
+#define PIO_SM0_EXECCTRL_OUT_STICKY_BITS (1u << 17)
+#define PIO_SM0_EXECCTRL_WRAP_TOP_LSB 12
+#define PIO_SM0_EXECCTRL_WRAP_TOP_BITS (0x1Fu << 12)
+#define PIO_SM0_EXECCTRL_WRAP_BOTTOM_LSB 7
+#define PIO_SM0_EXECCTRL_WRAP_BOTTOM_BITS (0x1Fu << 7)
+#define PIO_SM0_EXECCTRL_STATUS_SEL_BITS (1u << 4)
+#define PIO_SM0_EXECCTRL_STATUS_N_BITS 0xFu
+
+#define PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS (1u << 31)
+#define PIO_SM0_SHIFTCTRL_FJOIN_TX_BITS (1u << 30)
+#define PIO_SM0_SHIFTCTRL_PULL_THRESH_LSB 25
+#define PIO_SM0_SHIFTCTRL_PULL_THRESH_BITS (0x1Fu << 25)
+#define PIO_SM0_SHIFTCTRL_PUSH_THRESH_LSB 20
+#define PIO_SM0_SHIFTCTRL_PUSH_THRESH_BITS (0x1Fu << 20)
+#define PIO_SM0_SHIFTCTRL_OUT_SHIFTDIR_BITS (1u << 19)
+#define PIO_SM0_SHIFTCTRL_IN_SHIFTDIR_BITS (1u << 18)
+#define PIO_SM0_SHIFTCTRL_AUTOPULL_BITS (1u << 17)
+#define PIO_SM0_SHIFTCTRL_AUTOPUSH_BITS (1u << 16)
+#define PIO_SM0_SHIFTCTRL_FJOIN_RX_PUT_BITS (1u << 15) // RP2350
+#define PIO_SM0_SHIFTCTRL_FJOIN_RX_GET_LSB 14 // RP2350
+#define PIO_SM0_SHIFTCTRL_FJOIN_RX_GET_BITS (1u << 14) // RP2350
+
+#define PIO_SM0_PINCTRL_SIDESET_COUNT_LSB 29
+#define PIO_SM0_PINCTRL_SIDESET_COUNT_BITS (0x7u << 29)
+#define PIO_SM0_PINCTRL_SET_COUNT_LSB 26
+#define PIO_SM0_PINCTRL_SET_COUNT_BITS (0x7u << 26)
+#define PIO_SM0_PINCTRL_OUT_COUNT_LSB 20
+#define PIO_SM0_PINCTRL_OUT_COUNT_BITS (0x3Fu << 20)
+#define PIO_SM0_PINCTRL_IN_BASE_LSB 15
+#define PIO_SM0_PINCTRL_IN_BASE_BITS (0x1Fu << 15)
+#define PIO_SM0_PINCTRL_SIDESET_BASE_LSB 10
+#define PIO_SM0_PINCTRL_SIDESET_BASE_BITS (0x1Fu << 10)
+#define PIO_SM0_PINCTRL_SET_BASE_LSB 5
+#define PIO_SM0_PINCTRL_SET_BASE_BITS (0x1Fu << 5)
+#define PIO_SM0_PINCTRL_OUT_BASE_LSB 0
+#define PIO_SM0_PINCTRL_OUT_BASE_BITS 0x1Fu
+
+// State machine configuration, these only build up a pio_sm_config
+
+static inline void pio_shim_set_field(uint32_t *reg, uint32_t bits, unsigned lsb, uint32_t value) {
+    *reg = (*reg & ~bits) | ((value << lsb) & bits);
+}
+
+static inline void sm_config_set_out_pin_base(pio_sm_config *c, uint out_base) {
+    pio_shim_set_field(&c->pinctrl, PIO_SM0_PINCTRL_OUT_BASE_BITS, PIO_SM0_PINCTRL_OUT_BASE_LSB, out_base);
+}
+
+static inline void sm_config_set_out_pin_count(pio_sm_config *c, uint out_count) {
+    pio_shim_set_field(&c->pinctrl, PIO_SM0_PINCTRL_OUT_COUNT_BITS, PIO_SM0_PINCTRL_OUT_COUNT_LSB, out_count);
+}
+
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count) {
+    sm_config_set_out_pin_base(c, out_base);
+    sm_config_set_out_pin_count(c, out_count);
+}
+
+static inline void sm_config_set_set_pin_base(pio_sm_config *c, uint set_base) {
+    pio_shim_set_field(&c->pinctrl, PIO_SM0_PINCTRL_SET_BASE_BITS, PIO_SM0_PINCTRL_SET_BASE_LSB, set_base);
+}
+
+static inline void sm_config_set_set_pin_count(pio_sm_config *c, uint set_count) {
+    pio_shim_set_field(&c->pinctrl, PIO_SM0_PINCTRL_SET_COUNT_BITS, PIO_SM0_PINCTRL_SET_COUNT_LSB, set_count);
+}
+
+static inline void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count) {
+    sm_config_set_set_pin_base(c, set_base);
+    sm_config_set_set_pin_count(c, set_count);
+}
+
+static inline void sm_config_set_in_pin_base(pio_sm_config *c, uint in_base) {
+    pio_shim_set_field(&c->pinctrl, PIO_SM0_PINCTRL_IN_BASE_BITS, PIO_SM0_PINCTRL_IN_BASE_LSB, in_base);
+}
+
+static inline void sm_config_set_in_pins(pio_sm_config *c, uint in_base) {
+    sm_config_set_in_pin_base(c, in_base);
+}
+
+static inline void sm_config_set_sideset_pin_base(pio_sm_config *c, uint sideset_base) {
+    pio_shim_set_field(&c->pinctrl, PIO_SM0_PINCTRL_SIDESET_BASE_BITS, PIO_SM0_PINCTRL_SIDESET_BASE_LSB,
+        sideset_base);
+}
+
+static inline void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base) {
+    sm_config_set_sideset_pin_base(c, sideset_base);
+}
+
+// bit_count includes the enable bit when optional is set, as pioasm emits it
+static inline void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs) {
+    pio_shim_set_field(&c->pinctrl, PIO_SM0_PINCTRL_SIDESET_COUNT_BITS, PIO_SM0_PINCTRL_SIDESET_COUNT_LSB,
+        bit_count);
+    c->execctrl = (c->execctrl & ~(PIO_SM0_EXECCTRL_SIDE_EN_BITS | PIO_SM0_EXECCTRL_SIDE_PINDIR_BITS)) |
+        (optional ? PIO_SM0_EXECCTRL_SIDE_EN_BITS : 0) | (pindirs ? PIO_SM0_EXECCTRL_SIDE_PINDIR_BITS : 0);
+}
+
+static inline void sm_config_set_clkdiv_int_frac8(pio_sm_config *c, uint32_t div_int, uint8_t div_frac8) {
+    c->clkdiv = (div_int << PIO_SM0_CLKDIV_INT_LSB) | ((uint32_t)div_frac8 << PIO_SM0_CLKDIV_FRAC_LSB);
+}
+
+static inline void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac) {
+    sm_config_set_clkdiv_int_frac8(c, div_int, div_frac);
+}
+
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div) {
+    uint32_t div_int = (uint32_t)div;
+    uint8_t div_frac8 = div_int ? (uint8_t)((div - (float)div_int) * 256.0f) : 0;
+    sm_config_set_clkdiv_int_frac8(c, div_int, div_frac8);
+}
+
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap) {
+    pio_shim_set_field(&c->execctrl, PIO_SM0_EXECCTRL_WRAP_BOTTOM_BITS, PIO_SM0_EXECCTRL_WRAP_BOTTOM_LSB,
+        wrap_target);
+    pio_shim_set_field(&c->execctrl, PIO_SM0_EXECCTRL_WRAP_TOP_BITS, PIO_SM0_EXECCTRL_WRAP_TOP_LSB, wrap);
+}
+
+static inline void sm_config_set_jmp_pin(pio_sm_config *c, uint pin) {
+    pio_shim_set_field(&c->execctrl, PIO_SM0_EXECCTRL_JMP_PIN_BITS, PIO_SM0_EXECCTRL_JMP_PIN_LSB, pin);
+}
+
+// A threshold of 32 is encoded as 0
+static inline void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold) {
+    c->shiftctrl = (c->shiftctrl & ~(PIO_SM0_SHIFTCTRL_IN_SHIFTDIR_BITS | PIO_SM0_SHIFTCTRL_AUTOPUSH_BITS)) |
+        (shift_right ? PIO_SM0_SHIFTCTRL_IN_SHIFTDIR_BITS : 0) | (autopush ? PIO_SM0_SHIFTCTRL_AUTOPUSH_BITS : 0);
+    pio_shim_set_field(&c->shiftctrl, PIO_SM0_SHIFTCTRL_PUSH_THRESH_BITS, PIO_SM0_SHIFTCTRL_PUSH_THRESH_LSB,
+        push_threshold & 0x1Fu);
+}
+
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold) {
+    c->shiftctrl = (c->shiftctrl & ~(PIO_SM0_SHIFTCTRL_OUT_SHIFTDIR_BITS | PIO_SM0_SHIFTCTRL_AUTOPULL_BITS)) |
+        (shift_right ? PIO_SM0_SHIFTCTRL_OUT_SHIFTDIR_BITS : 0) | (autopull ? PIO_SM0_SHIFTCTRL_AUTOPULL_BITS : 0);
+    pio_shim_set_field(&c->shiftctrl, PIO_SM0_SHIFTCTRL_PULL_THRESH_BITS, PIO_SM0_SHIFTCTRL_PULL_THRESH_LSB,
+        pull_threshold & 0x1Fu);
+}
+
+static inline void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) {
+    c->shiftctrl = (c->shiftctrl & ~(PIO_SM0_SHIFTCTRL_FJOIN_TX_BITS | PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS |
+        PIO_SM0_SHIFTCTRL_FJOIN_RX_PUT_BITS | PIO_SM0_SHIFTCTRL_FJOIN_RX_GET_BITS)) |
+        (join == PIO_FIFO_JOIN_TX ? PIO_SM0_SHIFTCTRL_FJOIN_TX_BITS : 0) |
+        (join == PIO_FIFO_JOIN_RX ? PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS : 0) |
+        ((uint)join >> 2) << PIO_SM0_SHIFTCTRL_FJOIN_RX_GET_LSB;
+}
+
+static inline void sm_config_set_out_special(pio_sm_config *c, bool sticky, bool has_enable_pin,
+    uint enable_pin_index) {
+    c->execctrl = (c->execctrl & ~(PIO_SM0_EXECCTRL_OUT_STICKY_BITS | PIO_SM0_EXECCTRL_INLINE_OUT_EN_BITS)) |
+        (sticky ? PIO_SM0_EXECCTRL_OUT_STICKY_BITS : 0) | (has_enable_pin ? PIO_SM0_EXECCTRL_INLINE_OUT_EN_BITS : 0);
+    pio_shim_set_field(&c->execctrl, PIO_SM0_EXECCTRL_OUT_EN_SEL_BITS, PIO_SM0_EXECCTRL_OUT_EN_SEL_LSB,
+        enable_pin_index);
+}
+
+static inline void sm_config_set_mov_status(pio_sm_config *c, enum pio_mov_status_type status_sel, uint status_n) {
+    c->execctrl = (c->execctrl & ~(PIO_SM0_EXECCTRL_STATUS_SEL_BITS | PIO_SM0_EXECCTRL_STATUS_N_BITS)) |
+        (status_sel == STATUS_RX_LESSTHAN ? PIO_SM0_EXECCTRL_STATUS_SEL_BITS : 0) |
+        (status_n & PIO_SM0_EXECCTRL_STATUS_N_BITS);
+}
+
+// Same defaults as the SDK: clkdiv 1, wrap over all of memory, shift right
+// with no autopush/autopull and 32-bit thresholds
+static inline pio_sm_config pio_get_default_sm_config(void) {
+    pio_sm_config c = {0, 0, 0, 0};
+    sm_config_set_clkdiv_int_frac8(&c, 1, 0);
+    sm_config_set_wrap(&c, 0, 31);
+    sm_config_set_in_shift(&c, true, false, 32);
+    sm_config_set_out_shift(&c, true, false, 32);
+    return c;
+}
+
+// Instruction memory
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program);
+bool pio_can_add_program_at_offset(PIO pio, const pio_program_t *program, uint offset);
+// Returns the offset the program was loaded at, or -1 if it doesn't fit
+int pio_add_program(PIO pio, const pio_program_t *program);
+int pio_add_program_at_offset(PIO pio, const pio_program_t *program, uint offset);
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset);
+void pio_clear_instruction_memory(PIO pio);
+
+// State machines
+
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+int pio_sm_set_config(PIO pio, uint sm, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_set_sm_mask_enabled(PIO pio, uint32_t mask, bool enabled);
+void pio_enable_sm_mask_in_sync(PIO pio, uint32_t mask);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+uint8_t pio_sm_get_pc(PIO pio, uint sm);
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+// There's no GPIO function select on the chip, so this does nothing
+void pio_gpio_init(PIO pio, uint pin);
+uint pio_get_index(PIO pio);
+
+// FIFOs
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+
+// IRQ flags
+
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num);
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num);
+// IRQ_FORCE, not in the SDK, which writes pio->irq_force directly
+void pio_interrupt_force(PIO pio, uint pio_interrupt_num);
+
+// State machine claiming
+
+void pio_sm_claim(PIO pio, uint sm);
+void pio_claim_sm_mask(PIO pio, uint sm_mask);
+void pio_sm_unclaim(PIO pio, uint sm);
+int pio_claim_unused_sm(PIO pio, bool required);
+bool pio_sm_is_claimed(PIO pio, uint sm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _HARDWARE_PIO_H
@@ -0,0 +1,337 @@
+#include "hardware/pio.h"
+#include "pio_shim.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+
+#include "Vpio_chip.h"
+#include "Vpio_chip___024root.h"
+#include "pio_bus.h"
+#include "pio_loader.h"
+
+pio_hw_t pio_shim_instances[NUM_PIOS];
+
+namespace {
+
+std::optional<PioBus<Vpio_chip>> bus;
+uint64_t timeout = 100'000'000;
+
+PioBus<Vpio_chip> &chip_bus() {
+    if (!bus) {
+        std::fprintf(stderr, "hardware_pio: no model attached, call pio_shim_attach() first\n");
+        std::abort();
+    }
+    return *bus;
+}
+
+unsigned core_of(PIO pio) { return static_cast<unsigned>(pio - pio_shim_instances); }
+
+// Clocks the model until ready() or the timeout runs out
+template <typename Fn>
+void wait_for(const char *what, Fn &&ready) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    for (uint64_t waited = 0; !ready(); waited++) {
+        // ready() has just evaluated the model, and with every SM stalled or
+        // disabled nothing is going to unblock the host
+        if (b.chip().quiescent) {
+            std::fprintf(stderr, "hardware_pio: %s blocked with every state machine stalled or disabled\n", what);
+            std::abort();
+        }
+        if (timeout && waited == timeout) {
+            std::fprintf(stderr, "hardware_pio: %s still blocked after %llu cycles\n", what,
+                static_cast<unsigned long long>(timeout));
+            std::abort();
+        }
+        b.tick();
+    }
+}
+
+void set_ctrl_bits(PIO pio, uint32_t mask, bool set) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    const uint32_t ctrl = b.read(core_of(pio), pio_regs::kCtrl) & 0xF;
+    b.write(core_of(pio), pio_regs::kCtrl, set ? ctrl | mask : ctrl & ~mask);
+}
+
+} // namespace
+
+void pio_shim_attach(Vpio_chip *chip) {
+    bus.emplace(*chip);
+    bus->reset();
+    for (pio_hw_t &instance : pio_shim_instances) instance = {};
+}
+
+void pio_shim_detach() { bus.reset(); }
+
+void pio_shim_run(uint64_t cycles) { chip_bus().run(cycles); }
+
+uint64_t pio_shim_cycles() { return chip_bus().cycle(); }
+
+void pio_shim_set_timeout(uint64_t cycles) { timeout = cycles; }
+
+void pio_shim_start_in_sync(uint16_t sm_mask) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    b.write(0, pio_regs::kSyncArm, sm_mask);
+    b.write(0, pio_regs::kSyncTrigger, pio_regs::kSyncRestart | pio_regs::kSyncClkdivRestart | pio_regs::kSyncEnable);
+}
+
+void pio_shim_stop_in_sync(uint16_t sm_mask) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    b.write(0, pio_regs::kSyncArm, sm_mask);
+    b.write(0, pio_regs::kSyncTrigger, pio_regs::kSyncDisable);
+}
+
+void pio_shim_load_shadow(PIO pio, const pio_program_t *program, uint offset) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    b.write(core_of(pio), pio_regs::kInstrBank, pio_regs::kInstrBankShadowWrite);
+    for (uint i = 0; i < program->length; i++) {
+        b.write(core_of(pio), pio_regs::kInstrMem0 + 4 * (offset + i),
+            pio_loader::relocate(program->instructions[i], offset));
+    }
+    b.write(core_of(pio), pio_regs::kInstrBank, 0);
+}
+
+void pio_shim_swap_now(PIO pio) {
+    chip_bus().write(core_of(pio), pio_regs::kInstrBank, pio_regs::kInstrBankSwap | pio_regs::kSwapNow);
+}
+
+void pio_shim_swap_at_wrap(PIO pio, uint sm) {
+    chip_bus().write(core_of(pio), pio_regs::kInstrBank,
+        pio_regs::kInstrBankSwap | pio_regs::kSwapAtWrap | pio_regs::swap_sm(sm));
+}
+
+void pio_shim_swap_on_irq(PIO pio, uint irq_num) {
+    chip_bus().write(core_of(pio), pio_regs::kInstrBank,
+        pio_regs::kInstrBankSwap | pio_regs::kSwapOnIrq | pio_regs::swap_irq(irq_num));
+}
+
+bool pio_shim_swap_pending(PIO pio) {
+    return chip_bus().read(core_of(pio), pio_regs::kInstrBank) & pio_regs::kInstrBankSwapPending;
+}
+
+uint32_t pio_shim_rxf_putget_read(PIO pio, uint sm, uint index) {
+    return chip_bus().read(core_of(pio), pio_regs::rxf_putget(sm, index));
+}
+
+void pio_shim_rxf_putget_write(PIO pio, uint sm, uint index, uint32_t data) {
+    chip_bus().write(core_of(pio), pio_regs::rxf_putget(sm, index), data);
+}
+
+extern "C" {
+
+// Instruction memory
+
+bool pio_can_add_program_at_offset(PIO pio, const pio_program_t *program, uint offset) {
+    return pio_loader::can_place(pio->used_instruction_space, program->length, program->origin, offset);
+}
+
+static int find_offset(PIO pio, const pio_program_t *program) {
+    return pio_loader::find_offset(pio->used_instruction_space, program->length, program->origin);
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program) { return find_offset(pio, program) >= 0; }
+
+int pio_add_program_at_offset(PIO pio, const pio_program_t *program, uint offset) {
+    if (!pio_can_add_program_at_offset(pio, program, offset)) return -1;
+
+    PioBus<Vpio_chip> &b = chip_bus();
+    for (uint i = 0; i < program->length; i++) {
+        b.write(core_of(pio), pio_regs::kInstrMem0 + 4 * (offset + i),
+            pio_loader::relocate(program->instructions[i], offset));
+    }
+    pio->used_instruction_space |= pio_loader::slot_mask(program->length, offset);
+    return static_cast<int>(offset);
+}
+
+int pio_add_program(PIO pio, const pio_program_t *program) {
+    const int offset = find_offset(pio, program);
+    return offset < 0 ? -1 : pio_add_program_at_offset(pio, program, offset);
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset) {
+    pio->used_instruction_space &= ~pio_loader::slot_mask(program->length, loaded_offset);
+}
+
+void pio_clear_instruction_memory(PIO pio) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    for (uint i = 0; i < PIO_INSTRUCTION_COUNT; i++) {
+        b.write(core_of(pio), pio_regs::kInstrMem0 + 4 * i, pio_encode_jmp(i));
+    }
+    pio->used_instruction_space = 0;
+}
+
+// State machines
+
+int pio_sm_set_config(PIO pio, uint sm, const pio_sm_config *config) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    const unsigned core = core_of(pio);
+    b.write(core, pio_regs::sm_reg(sm, pio_regs::kSmClkdiv), config->clkdiv);
+    b.write(core, pio_regs::sm_reg(sm, pio_regs::kSmExecctrl), config->execctrl);
+    b.write(core, pio_regs::sm_reg(sm, pio_regs::kSmShiftctrl), config->shiftctrl);
+    b.write(core, pio_regs::sm_reg(sm, pio_regs::kSmPinctrl), config->pinctrl);
+    return 0;
+}
+
+// Follows the SDK's sequence, except that the FIFOs aren't cleared, the chip
+// has no way to do that yet
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config) {
+    pio_sm_set_enabled(pio, sm, false);
+    if (config) {
+        pio_sm_set_config(pio, sm, config);
+    } else {
+        pio_sm_config c = pio_get_default_sm_config();
+        pio_sm_set_config(pio, sm, &c);
+    }
+
+    // Clear the sticky FDEBUG flags for this SM
+    chip_bus().write(core_of(pio), pio_regs::kFdebug, 0x01010101u << sm);
+    pio_sm_restart(pio, sm);
+    pio_sm_exec(pio, sm, pio_encode_jmp(initial_pc));
+    return 0;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) { set_ctrl_bits(pio, 1u << sm, enabled); }
+
+void pio_set_sm_mask_enabled(PIO pio, uint32_t mask, bool enabled) { set_ctrl_bits(pio, mask & 0xF, enabled); }
+
+// One CTRL write, so the SMs in `mask` start on the same clock
+void pio_enable_sm_mask_in_sync(PIO pio, uint32_t mask) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    const uint32_t ctrl = b.read(core_of(pio), pio_regs::kCtrl) & 0xF;
+    b.write(core_of(pio), pio_regs::kCtrl, ctrl | (mask & 0xF) | (mask & 0xF) << 8);
+}
+
+// SM_RESTART bits are self-clearing, so write them with the current enables
+void pio_sm_restart(PIO pio, uint sm) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    const uint32_t ctrl = b.read(core_of(pio), pio_regs::kCtrl) & 0xF;
+    b.write(core_of(pio), pio_regs::kCtrl, ctrl | 1u << (4 + sm));
+}
+
+// The instruction runs on the clock after the write, and a jump moves the pc
+// on the one after that. Both are clocked here, so the exec has finished by
+// the time this returns, as it has on the RP2040.
+void pio_sm_exec(PIO pio, uint sm, uint instr) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    b.write(core_of(pio), pio_regs::sm_reg(sm, pio_regs::kSmInstr), instr);
+    b.tick();
+    b.tick();
+}
+
+uint8_t pio_sm_get_pc(PIO pio, uint sm) {
+    return static_cast<uint8_t>(chip_bus().read(core_of(pio), pio_regs::sm_reg(sm, pio_regs::kSmAddr)));
+}
+
+// Same as the SDK: point SET at each group of up to 5 pins and exec set pindirs
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+    PioBus<Vpio_chip> &b = chip_bus();
+    const unsigned core = core_of(pio);
+    const uint16_t pinctrl_addr = pio_regs::sm_reg(sm, pio_regs::kSmPinctrl);
+    const uint32_t pinctrl = b.read(core, pinctrl_addr);
+    const uint pindir_val = is_out ? 0x1F : 0;
+
+    while (pin_count > 5) {
+        b.write(core, pinctrl_addr, 5u << PIO_SM0_PINCTRL_SET_COUNT_LSB | pin_base << PIO_SM0_PINCTRL_SET_BASE_LSB);
+        pio_sm_exec(pio, sm, pio_encode_set(pio_pindirs, pindir_val));
+        pin_count -= 5;
+        pin_base = (pin_base + 5) & 0x1F;
+    }
+    b.write(core, pinctrl_addr, pin_count << PIO_SM0_PINCTRL_SET_COUNT_LSB | pin_base << PIO_SM0_PINCTRL_SET_BASE_LSB);
+    pio_sm_exec(pio, sm, pio_encode_set(pio_pindirs, pindir_val));
+    b.write(core, pinctrl_addr, pinctrl);
+    return 0;
+}
+
+void pio_gpio_init(PIO, uint) {}
+
+uint pio_get_index(PIO pio) { return core_of(pio); }
+
+// FIFOs
+
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm) {
+    return chip_bus().read(core_of(pio), pio_regs::kFstat) & pio_regs::fstat_rx_full(sm);
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) {
+    return chip_bus().read(core_of(pio), pio_regs::kFstat) & pio_regs::fstat_rx_empty(sm);
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm) {
+    return pio_regs::flevel_rx(chip_bus().read(core_of(pio), pio_regs::kFlevel), sm);
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) {
+    return chip_bus().read(core_of(pio), pio_regs::kFstat) & pio_regs::fstat_tx_full(sm);
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) {
+    return chip_bus().read(core_of(pio), pio_regs::kFstat) & pio_regs::fstat_tx_empty(sm);
+}
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm) {
+    return pio_regs::flevel_tx(chip_bus().read(core_of(pio), pio_regs::kFlevel), sm);
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data) { chip_bus().push(core_of(pio), sm, data); }
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    wait_for("pio_sm_put_blocking", [&] { return !pio_sm_is_tx_fifo_full(pio, sm); });
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) { return chip_bus().pop(core_of(pio), sm); }
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm) {
+    wait_for("pio_sm_get_blocking", [&] { return !pio_sm_is_rx_fifo_empty(pio, sm); });
+    return pio_sm_get(pio, sm);
+}
+
+// IRQ flags
+
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num) {
+    return chip_bus().read(core_of(pio), pio_regs::kIrq) >> pio_interrupt_num & 1;
+}
+
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num) {
+    chip_bus().write(core_of(pio), pio_regs::kIrq, 1u << pio_interrupt_num);
+}
+
+void pio_interrupt_force(PIO pio, uint pio_interrupt_num) {
+    chip_bus().write(core_of(pio), pio_regs::kIrqForce, 1u << pio_interrupt_num);
+}
+
+// State machine claiming
+
+void pio_sm_claim(PIO pio, uint sm) {
+    if (pio->claimed & 1u << sm) {
+        std::fprintf(stderr, "hardware_pio: PIO %u SM %u is already claimed\n", core_of(pio), sm);
+        std::abort();
+    }
+    pio->claimed |= 1u << sm;
+}
+
+void pio_claim_sm_mask(PIO pio, uint sm_mask) {
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        if (sm_mask & 1u << sm) pio_sm_claim(pio, sm);
+    }
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) { pio->claimed &= ~(1u << sm); }
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        if (!(pio->claimed & 1u << sm)) {
+            pio->claimed |= 1u << sm;
+            return static_cast<int>(sm);
+        }
+    }
+    if (required) {
+        std::fprintf(stderr, "hardware_pio: no free state machines on PIO %u\n", core_of(pio));
+        std::abort();
+    }
+    return -1;
+}
+
+bool pio_sm_is_claimed(PIO pio, uint sm) { return pio->claimed & 1u << sm; }
+
+} // extern "C"
@@ -0,0 +1,57 @@
+#ifndef PIO_SHIM_H
+#define PIO_SHIM_H
+
+// Binds the hardware_pio shim (hardware/pio.h in this directory) to a model
+
+#include <cstdint>
+
+#include "hardware/pio.h"
+
+class Vpio_chip;
+
+// Resets the model and the shim's allocation state. The model must outlive
+// every hardware_pio call made until pio_shim_detach().
+void pio_shim_attach(Vpio_chip *chip);
+void pio_shim_detach();
+
+// Clocks the model with no register access, for code that would otherwise
+// sleep or busy-wait. Stretches where every SM is stalled are skipped rather
+// than simulated.
+void pio_shim_run(uint64_t cycles);
+
+// Clocks since pio_shim_attach()
+uint64_t pio_shim_cycles();
+
+// Restarts and enables every SM in `sm_mask` on the same clock, across cores,
+// through the chip's SYNC_ARM/SYNC_TRIGGER registers. SM x of PIO y is bit
+// 4 * y + x. The clock dividers restart too, as pio_enable_sm_mask_in_sync()
+// does within one PIO.
+void pio_shim_start_in_sync(uint16_t sm_mask);
+// Disables every SM in `sm_mask` on the same clock
+void pio_shim_stop_in_sync(uint16_t sm_mask);
+
+// Program swap through the core's shadow instruction bank (INSTR_BANK).
+// pio_shim_load_shadow() writes a program into the bank the core isn't
+// executing, relocating JMPs like pio_add_program_at_offset() but without
+// touching the allocation state, and cancels any swap still pending. The
+// swap then happens on the next clock, when `sm` wraps, or when the core's
+// IRQ flag `irq_num` is set (the swap clears it). The two banks trade places,
+// so the old program can be swapped back in without reloading it.
+void pio_shim_load_shadow(PIO pio, const pio_program_t *program, uint offset);
+void pio_shim_swap_now(PIO pio);
+void pio_shim_swap_at_wrap(PIO pio, uint sm);
+void pio_shim_swap_on_irq(PIO pio, uint irq_num);
+bool pio_shim_swap_pending(PIO pio);
+
+// RX FIFO random access, the RP2350's RXFx_PUTGETy registers. With
+// sm_config_set_fifo_join(PIO_FIFO_JOIN_RXPUT) the host reads the entries
+// `mov rxfifo[], isr` writes, with PIO_FIFO_JOIN_RXGET it writes the ones
+// `mov osr, rxfifo[]` reads. In any other mode reads return 0 and writes are
+// ignored.
+uint32_t pio_shim_rxf_putget_read(PIO pio, uint sm, uint index);
+void pio_shim_rxf_putget_write(PIO pio, uint sm, uint index, uint32_t data);
+
+// Blocking FIFO calls give up and abort after this many clocks, 0 waits forever
+void pio_shim_set_timeout(uint64_t cycles);
+
+#endif // PIO_SHIM_H
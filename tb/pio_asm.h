@@ -0,0 +1,577 @@
+#ifndef PIO_ASM_H
+#define PIO_ASM_H
+
+// Compile-time PIO assembler
+//
+// Turns pioasm source into machine code at compile time:
+//
+//     constexpr auto blink = pio_asm::assemble<R"(
+//         .side_set 1 opt
+//     .wrap_target
+//         set pins, 1   side 0 [7]
+//     loop:
+//         jmp x--, loop
+//         set pins, 0   side 1
+//     .wrap
+//     )">();
+//
+//     blink.instructions   // std::array<uint16_t, 3>
+//     blink.wrap_target    // 0
+//     blink.wrap           // 2
+//
+// Supported directives: .program, .origin, .define, .side_set, .wrap_target,
+// .wrap and .word. Labels, delays ([n]) and side-set (side n) work as they do
+// in pioasm, and so do the RP2350's mov rxfifo[y], isr and
+// mov osr, rxfifo[n]. Jump targets are relative to the start of the program,
+// the same as pioasm output, so programs must be relocated if loaded at an
+// offset.
+//
+// Anything malformed is a compile error when assemble<>() is used, and throws
+// pio_asm::assembler_error when detail::parse() is called at runtime.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace pio_asm {
+
+constexpr std::size_t kMaxInstructions = 32;
+
+class assembler_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+template <std::size_t N>
+struct Program {
+    std::array<uint16_t, N> instructions;
+    uint8_t wrap_target;
+    uint8_t wrap;
+    int8_t origin; // -1 if the program can be loaded anywhere
+    uint8_t sideset_bits; // Not including the enable bit for optional side-set
+    bool sideset_opt;
+    bool sideset_pindirs;
+
+    static constexpr std::size_t length() { return N; }
+};
+
+// Lets the source be passed as a template argument
+template <std::size_t N>
+struct fixed_string {
+    char data[N];
+
+    constexpr fixed_string(const char (&str)[N]) {
+        for (std::size_t i = 0; i < N; i++) {
+            data[i] = str[i];
+        }
+    }
+
+    constexpr std::string_view view() const { return {data, N - 1}; }
+};
+
+namespace detail {
+
+struct Parsed {
+    std::array<uint16_t, kMaxInstructions> instructions{};
+    std::size_t length = 0;
+    uint8_t wrap_target = 0;
+    uint8_t wrap = 0;
+    int8_t origin = -1;
+    uint8_t sideset_bits = 0;
+    bool sideset_opt = false;
+    bool sideset_pindirs = false;
+};
+
+struct Symbol {
+    std::string_view name;
+    uint32_t value = 0;
+};
+
+struct SymbolTable {
+    std::array<Symbol, 64> symbols{};
+    std::size_t count = 0;
+
+    constexpr const Symbol *find(std::string_view name) const {
+        for (std::size_t i = 0; i < count; i++) {
+            if (symbols[i].name == name) return &symbols[i];
+        }
+        return nullptr;
+    }
+
+    constexpr void add(std::string_view name, uint32_t value) {
+        if (find(name)) throw assembler_error("duplicate symbol");
+        if (count == symbols.size()) throw assembler_error("too many symbols");
+        symbols[count++] = {name, value};
+    }
+};
+
+// Up to 16 tokens per line is plenty for any PIO instruction
+struct Tokens {
+    std::array<std::string_view, 16> tokens{};
+    std::size_t count = 0;
+
+    constexpr std::string_view operator[](std::size_t i) const {
+        return i < count ? tokens[i] : std::string_view{};
+    }
+};
+
+constexpr bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == ',';
+}
+
+constexpr std::string_view strip_comment(std::string_view line) {
+    for (std::size_t i = 0; i < line.size(); i++) {
+        if (line[i] == ';') return line.substr(0, i);
+        if (line[i] == '/' && i + 1 < line.size() && line[i + 1] == '/') return line.substr(0, i);
+    }
+    return line;
+}
+
+constexpr Tokens tokenize(std::string_view line) {
+    Tokens out;
+    std::size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && is_space(line[i])) i++;
+        if (i == line.size()) break;
+
+        std::size_t start = i;
+        if (line[i] == '[' || line[i] == ']') {
+            // Brackets are tokens on their own so "[ 3 ]" and "[3]" look the same
+            i++;
+        } else {
+            while (i < line.size() && !is_space(line[i]) && line[i] != '[' && line[i] != ']') i++;
+        }
+
+        if (out.count == out.tokens.size()) throw assembler_error("line has too many tokens");
+        out.tokens[out.count++] = line.substr(start, i - start);
+    }
+    return out;
+}
+
+constexpr bool parse_number(std::string_view token, uint32_t &value) {
+    if (token.empty()) return false;
+
+    uint32_t base = 10;
+    std::size_t i = 0;
+    if (token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X')) {
+        base = 16;
+        i = 2;
+    } else if (token.size() > 2 && token[0] == '0' && (token[1] == 'b' || token[1] == 'B')) {
+        base = 2;
+        i = 2;
+    }
+
+    uint64_t result = 0;
+    for (; i < token.size(); i++) {
+        char c = token[i];
+        uint32_t digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else if (c == '_') continue;
+        else return false;
+
+        if (digit >= base) return false;
+        result = result * base + digit;
+        if (result > 0xFFFFFFFF) throw assembler_error("number out of range");
+    }
+    value = static_cast<uint32_t>(result);
+    return true;
+}
+
+// A number, a .define or a label
+constexpr uint32_t parse_value(std::string_view token, const SymbolTable &symbols) {
+    uint32_t value = 0;
+    if (parse_number(token, value)) return value;
+    if (const Symbol *symbol = symbols.find(token)) return symbol->value;
+    throw assembler_error("expected a number or symbol");
+}
+
+constexpr uint32_t parse_bounded(std::string_view token, const SymbolTable &symbols, uint32_t max) {
+    uint32_t value = parse_value(token, symbols);
+    if (value > max) throw assembler_error("value out of range");
+    return value;
+}
+
+// 1-32, with 32 encoded as 0
+constexpr uint16_t parse_bit_count(std::string_view token, const SymbolTable &symbols) {
+    uint32_t value = parse_value(token, symbols);
+    if (value < 1 || value > 32) throw assembler_error("bit count must be 1-32");
+    return value & 0x1F;
+}
+
+constexpr bool is_label(std::string_view token) {
+    return token.size() > 1 && token.back() == ':';
+}
+
+struct Operand {
+    std::string_view name;
+    std::string_view values[8];
+    uint16_t codes[8];
+};
+
+constexpr uint16_t lookup(std::string_view token, const Operand &operand) {
+    for (std::size_t i = 0; i < 8; i++) {
+        if (!operand.values[i].empty() && operand.values[i] == token) return operand.codes[i];
+    }
+    throw assembler_error("invalid operand");
+}
+
+constexpr Operand kJmpConditions = {"condition", {"!x", "x--", "!y", "y--", "x!=y", "pin", "!osre"},
+    {1, 2, 3, 4, 5, 6, 7}};
+constexpr Operand kWaitSources = {"source", {"gpio", "pin", "irq"}, {0, 1, 2}};
+constexpr Operand kInSources = {"source", {"pins", "x", "y", "null", "isr", "osr"}, {0, 1, 2, 3, 6, 7}};
+constexpr Operand kOutDestinations = {"destination", {"pins", "x", "y", "null", "pindirs", "pc", "isr", "exec"},
+    {0, 1, 2, 3, 4, 5, 6, 7}};
+constexpr Operand kMovDestinations = {"destination", {"pins", "x", "y", "exec", "pc", "isr", "osr"},
+    {0, 1, 2, 4, 5, 6, 7}};
+constexpr Operand kMovSources = {"source", {"pins", "x", "y", "null", "status", "isr", "osr"},
+    {0, 1, 2, 3, 5, 6, 7}};
+constexpr Operand kSetDestinations = {"destination", {"pins", "x", "y", "pindirs"}, {0, 1, 2, 4}};
+
+// Splits an instruction line into its operands and the delay/side-set suffix
+struct Instruction {
+    Tokens operands;
+    std::string_view delay;
+    std::string_view side;
+};
+
+constexpr Instruction split_instruction(const Tokens &tokens, std::size_t first) {
+    Instruction out;
+    for (std::size_t i = first; i < tokens.count; i++) {
+        if (tokens[i] == "[" && out.operands.count && out.operands[out.operands.count - 1] == "rxfifo") {
+            // rxfifo[index] is one operand. Tokens are views into the same
+            // line, so it can be re-joined.
+            if (tokens[i + 2] != "]") throw assembler_error("malformed rxfifo index");
+            std::string_view &rxfifo = out.operands.tokens[out.operands.count - 1];
+            rxfifo = std::string_view(rxfifo.data(), tokens[i + 2].data() + 1 - rxfifo.data());
+            i += 2;
+        } else if (tokens[i] == "[") {
+            if (tokens[i + 2] != "]") throw assembler_error("malformed delay");
+            if (!out.delay.empty()) throw assembler_error("delay given twice");
+            out.delay = tokens[i + 1];
+            i += 2;
+        } else if (tokens[i] == "side" || tokens[i] == "sideset" || tokens[i] == "side_set") {
+            if (i + 1 >= tokens.count) throw assembler_error("missing side-set value");
+            if (!out.side.empty()) throw assembler_error("side-set given twice");
+            out.side = tokens[i + 1];
+            i += 1;
+        } else {
+            if (out.operands.count == out.operands.tokens.size()) throw assembler_error("too many operands");
+            out.operands.tokens[out.operands.count++] = tokens[i];
+        }
+    }
+    return out;
+}
+
+constexpr uint16_t encode_delay_sideset(const Instruction &instr, const Parsed &program,
+    const SymbolTable &symbols) {
+    uint32_t bits = program.sideset_bits + (program.sideset_opt ? 1 : 0);
+    uint32_t max_delay = (1u << (5 - bits)) - 1;
+    uint32_t field = 0;
+
+    if (!instr.delay.empty()) {
+        field |= parse_value(instr.delay, symbols);
+        if (field > max_delay) throw assembler_error("delay too large for the side-set configuration");
+    }
+
+    if (!instr.side.empty()) {
+        if (program.sideset_bits == 0) throw assembler_error("side-set used without .side_set");
+        uint32_t side = parse_bounded(instr.side, symbols, (1u << program.sideset_bits) - 1);
+        field |= side << (5 - bits);
+        if (program.sideset_opt) field |= 0x10;
+    } else if (program.sideset_bits > 0 && !program.sideset_opt) {
+        throw assembler_error("side-set is required on every instruction unless .side_set is opt");
+    }
+
+    return field << 8;
+}
+
+// Joins "!", "~" or "::" with the operand that follows, so "! x" and "!x" are the same
+constexpr Tokens join_prefixes(const Tokens &operands) {
+    Tokens out;
+    for (std::size_t i = 0; i < operands.count; i++) {
+        std::string_view token = operands[i];
+        if ((token == "!" || token == "~" || token == "::") && i + 1 < operands.count) {
+            std::string_view next = operands[i + 1];
+            // Tokens are views into the same line, so they can be re-joined
+            token = std::string_view(token.data(), next.data() + next.size() - token.data());
+            i++;
+        }
+        out.tokens[out.count++] = token;
+    }
+    return out;
+}
+
+constexpr std::string_view without_spaces_prefix(std::string_view token, std::size_t prefix) {
+    std::string_view rest = token.substr(prefix);
+    while (!rest.empty() && (rest.front() == ' ' || rest.front() == '\t')) rest.remove_prefix(1);
+    return rest;
+}
+
+// IRQ number, with the RP2350's prev/next before it or rel after it
+constexpr uint16_t encode_irq_index(const Tokens &ops, std::size_t index, const SymbolTable &symbols) {
+    uint16_t mode = 0;
+    if (ops[index] == "prev" || ops[index] == "next") {
+        mode = ops[index] == "prev" ? 0x08 : 0x18;
+        index++;
+    }
+    uint16_t value = parse_bounded(ops[index], symbols, 7);
+    if (ops[index + 1] == "rel" && !mode) {
+        value |= 0x10;
+    } else if (!ops[index + 1].empty()) {
+        throw assembler_error("unexpected operand after irq index");
+    }
+    return mode | value;
+}
+
+// The index part of rxfifo[y] or rxfifo[n], as the low bits of the PUSH/PULL
+// encoding: 0x10 for Y, 0x18 | n for a fixed entry
+constexpr uint16_t encode_rxfifo_index(std::string_view operand, const SymbolTable &symbols) {
+    if (!operand.starts_with("rxfifo")) throw assembler_error("expected rxfifo[]");
+    std::string_view index = without_spaces_prefix(operand, operand.find('[') + 1);
+    index.remove_suffix(1); // ]
+    while (!index.empty() && (index.back() == ' ' || index.back() == '\t')) index.remove_suffix(1);
+    if (index == "y") return 0x10;
+    return 0x18 | parse_bounded(index, symbols, 3);
+}
+
+constexpr uint16_t encode(const Instruction &instr, std::string_view mnemonic, const Parsed &program,
+    const SymbolTable &symbols) {
+    const Tokens ops = join_prefixes(instr.operands);
+    uint16_t ds = encode_delay_sideset(instr, program, symbols);
+
+    if (mnemonic == "nop") {
+        if (ops.count != 0) throw assembler_error("nop takes no operands");
+        return 0xA042 | ds; // mov y, y
+    }
+
+    if (mnemonic == "jmp") {
+        uint16_t cond = 0;
+        std::string_view target;
+        if (ops.count == 1) {
+            target = ops[0];
+        } else if (ops.count == 2) {
+            cond = lookup(ops[0], kJmpConditions);
+            target = ops[1];
+        } else {
+            throw assembler_error("jmp takes a condition and a target");
+        }
+        return 0x0000 | ds | cond << 5 | parse_bounded(target, symbols, 31);
+    }
+
+    if (mnemonic == "wait") {
+        if (ops.count < 3) throw assembler_error("wait takes a polarity, source and index");
+        uint16_t polarity = parse_bounded(ops[0], symbols, 1);
+        uint16_t source = lookup(ops[1], kWaitSources);
+        uint16_t index;
+        if (source == 2) {
+            index = encode_irq_index(ops, 2, symbols);
+        } else {
+            if (ops.count != 3) throw assembler_error("unexpected operand after wait index");
+            index = parse_bounded(ops[2], symbols, 31);
+        }
+        return 0x2000 | ds | polarity << 7 | source << 5 | index;
+    }
+
+    if (mnemonic == "in") {
+        if (ops.count != 2) throw assembler_error("in takes a source and a bit count");
+        return 0x4000 | ds | lookup(ops[0], kInSources) << 5 | parse_bit_count(ops[1], symbols);
+    }
+
+    if (mnemonic == "out") {
+        if (ops.count != 2) throw assembler_error("out takes a destination and a bit count");
+        return 0x6000 | ds | lookup(ops[0], kOutDestinations) << 5 | parse_bit_count(ops[1], symbols);
+    }
+
+    if (mnemonic == "push" || mnemonic == "pull") {
+        bool is_pull = mnemonic == "pull";
+        uint16_t if_flag = 0;
+        uint16_t block = 1;
+        for (std::size_t i = 0; i < ops.count; i++) {
+            if (ops[i] == (is_pull ? "ifempty" : "iffull")) if_flag = 1;
+            else if (ops[i] == "block") block = 1;
+            else if (ops[i] == "noblock") block = 0;
+            else throw assembler_error("invalid push/pull option");
+        }
+        return 0x8000 | ds | (is_pull ? 0x80 : 0) | if_flag << 6 | block << 5;
+    }
+
+    if (mnemonic == "mov") {
+        if (ops.count != 2) throw assembler_error("mov takes a destination and a source");
+        // RX FIFO random access, encoded as PUSH and PULL
+        if (ops[0].starts_with("rxfifo")) {
+            if (ops[1] != "isr") throw assembler_error("mov rxfifo[] only takes isr");
+            return 0x8000 | ds | encode_rxfifo_index(ops[0], symbols);
+        }
+        if (ops[1].starts_with("rxfifo")) {
+            if (ops[0] != "osr") throw assembler_error("mov from rxfifo[] only goes to osr");
+            return 0x8080 | ds | encode_rxfifo_index(ops[1], symbols);
+        }
+        uint16_t op = 0;
+        std::string_view source = ops[1];
+        if (source.starts_with("!") || source.starts_with("~")) {
+            op = 1;
+            source = without_spaces_prefix(source, 1);
+        } else if (source.starts_with("::")) {
+            op = 2;
+            source = without_spaces_prefix(source, 2);
+        }
+        return 0xA000 | ds | lookup(ops[0], kMovDestinations) << 5 | op << 3 | lookup(source, kMovSources);
+    }
+
+    if (mnemonic == "irq") {
+        uint16_t clear = 0;
+        uint16_t wait = 0;
+        // prev/next can also come before set/wait/clear, as pioasm writes it
+        const std::size_t first = ops[0] == "prev" || ops[0] == "next" ? 1 : 0;
+        std::size_t index = first;
+        if (ops[first] == "set" || ops[first] == "nowait") {
+            index = first + 1;
+        } else if (ops[first] == "wait") {
+            wait = 1;
+            index = first + 1;
+        } else if (ops[first] == "clear") {
+            clear = 1;
+            index = first + 1;
+        }
+        if (ops.count <= index) throw assembler_error("irq takes an index");
+        uint16_t irq = encode_irq_index(ops, index, symbols);
+        if (first) {
+            if (irq & 0x18) throw assembler_error("irq takes one of prev, next and rel");
+            irq |= ops[0] == "prev" ? 0x08 : 0x18;
+        }
+        return 0xC000 | ds | clear << 6 | wait << 5 | irq;
+    }
+
+    if (mnemonic == "set") {
+        if (ops.count != 2) throw assembler_error("set takes a destination and a value");
+        return 0xE000 | ds | lookup(ops[0], kSetDestinations) << 5 | parse_bounded(ops[1], symbols, 31);
+    }
+
+    throw assembler_error("unknown instruction");
+}
+
+// Calls fn(tokens) for every non-empty line, with comments removed
+template <typename Fn>
+constexpr void for_each_line(std::string_view source, Fn &&fn) {
+    while (!source.empty()) {
+        std::size_t end = source.find('\n');
+        std::string_view line = source.substr(0, end);
+        source = end == std::string_view::npos ? std::string_view{} : source.substr(end + 1);
+
+        Tokens tokens = tokenize(strip_comment(line));
+        if (tokens.count > 0) fn(tokens);
+    }
+}
+
+// Strips "public" and a leading label, if present, adding the label to symbols
+constexpr std::size_t skip_label(const Tokens &tokens, SymbolTable *symbols, uint32_t address) {
+    std::size_t first = 0;
+    if (tokens[0] == "public" && is_label(tokens[1])) first = 1;
+    if (is_label(tokens[first])) {
+        std::string_view name = tokens[first].substr(0, tokens[first].size() - 1);
+        if (symbols) symbols->add(name, address);
+        return first + 1;
+    }
+    return 0;
+}
+
+constexpr Parsed parse(std::string_view source) {
+    Parsed program;
+    SymbolTable symbols;
+
+    // First pass: labels, defines and directives that affect encoding
+    bool wrap_target_set = false;
+    bool wrap_set = false;
+    bool seen_program = false;
+    std::size_t address = 0;
+
+    for_each_line(source, [&](const Tokens &tokens) {
+        std::size_t first = skip_label(tokens, &symbols, address);
+        std::string_view directive = tokens[first];
+        if (directive.empty()) return;
+
+        if (directive == ".program") {
+            if (seen_program) throw assembler_error("only one .program per source");
+            seen_program = true;
+        } else if (directive == ".define") {
+            std::size_t name = tokens[first + 1] == "public" ? first + 2 : first + 1;
+            if (tokens[name].empty() || tokens[name + 1].empty()) throw assembler_error(".define takes a name and a value");
+            symbols.add(tokens[name], parse_value(tokens[name + 1], symbols));
+        } else if (directive == ".origin") {
+            program.origin = static_cast<int8_t>(parse_bounded(tokens[first + 1], symbols, 31));
+        } else if (directive == ".side_set") {
+            if (address != 0) throw assembler_error(".side_set must come before the first instruction");
+            program.sideset_bits = static_cast<uint8_t>(parse_bounded(tokens[first + 1], symbols, 5));
+            for (std::size_t i = first + 2; i < tokens.count; i++) {
+                if (tokens[i] == "opt") program.sideset_opt = true;
+                else if (tokens[i] == "pindirs") program.sideset_pindirs = true;
+                else throw assembler_error("invalid .side_set option");
+            }
+            if (program.sideset_bits + (program.sideset_opt ? 1 : 0) > 5) {
+                throw assembler_error("side-set uses more than 5 bits");
+            }
+        } else if (directive == ".wrap_target") {
+            if (wrap_target_set) throw assembler_error(".wrap_target given twice");
+            wrap_target_set = true;
+            program.wrap_target = static_cast<uint8_t>(address);
+        } else if (directive == ".wrap") {
+            if (wrap_set) throw assembler_error(".wrap given twice");
+            if (address == 0) throw assembler_error(".wrap before any instructions");
+            wrap_set = true;
+            program.wrap = static_cast<uint8_t>(address - 1);
+        } else if (directive.starts_with(".") && directive != ".word") {
+            throw assembler_error("unknown directive");
+        } else {
+            if (address == kMaxInstructions) throw assembler_error("program is longer than 32 instructions");
+            address++;
+        }
+    });
+
+    if (address == 0) throw assembler_error("program has no instructions");
+    program.length = address;
+    if (!wrap_set) program.wrap = static_cast<uint8_t>(address - 1);
+    if (program.wrap_target >= address) throw assembler_error(".wrap_target after the last instruction");
+
+    // Second pass: encode, now that every label is known
+    address = 0;
+    for_each_line(source, [&](const Tokens &tokens) {
+        std::size_t first = skip_label(tokens, nullptr, address);
+        std::string_view mnemonic = tokens[first];
+        if (mnemonic.empty() || (mnemonic.starts_with(".") && mnemonic != ".word")) return;
+
+        if (mnemonic == ".word") {
+            program.instructions[address++] = static_cast<uint16_t>(parse_bounded(tokens[first + 1], symbols, 0xFFFF));
+        } else {
+            program.instructions[address++] = encode(split_instruction(tokens, first + 1), mnemonic, program, symbols);
+        }
+    });
+
+    return program;
+}
+
+} // namespace detail
+
+template <fixed_string Source>
+consteval auto assemble() {
+    constexpr detail::Parsed parsed = detail::parse(Source.view());
+
+    Program<parsed.length> program{};
+    for (std::size_t i = 0; i < parsed.length; i++) {
+        program.instructions[i] = parsed.instructions[i];
+    }
+    program.wrap_target = parsed.wrap_target;
+    program.wrap = parsed.wrap;
+    program.origin = parsed.origin;
+    program.sideset_bits = parsed.sideset_bits;
+    program.sideset_opt = parsed.sideset_opt;
+    program.sideset_pindirs = parsed.sideset_pindirs;
+    return program;
+}
+
+} // namespace pio_asm
+
+#endif // PIO_ASM_H
@@ -0,0 +1,220 @@
+#ifndef PIO_BUS_H
+#define PIO_BUS_H
+
+// Host register bus driver for a verilated pio_chip
+//
+// Wraps the reg_* ports so a testbench can configure the chip the way a host
+// would, one register access per clock. Templated on the model so it doesn't
+// tie the header to a particular Verilator prefix. credit_stalls(), and so
+// run(), reach into the model's public signals, so callers of those include
+// the model's root header.
+//
+// The chip is clocked low -> high -> low by tick(), so inputs set between
+// ticks are always in place ahead of the rising edge.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pio_regs {
+
+// Per-core register offsets, see the register table in TODO.md
+constexpr uint16_t kCtrl = 0x000;
+constexpr uint16_t kFstat = 0x004;
+constexpr uint16_t kFdebug = 0x008;
+constexpr uint16_t kFlevel = 0x00C;
+constexpr uint16_t kTxf0 = 0x010;
+constexpr uint16_t kRxf0 = 0x020;
+constexpr uint16_t kIrq = 0x030;
+constexpr uint16_t kIrqForce = 0x034;
+constexpr uint16_t kInputSyncBypass = 0x038;
+constexpr uint16_t kInstrMem0 = 0x048;
+constexpr uint16_t kPerfCtrl = 0x144;
+
+// State machine registers, SMx_<reg> is at kSm0Clkdiv + x * kSmStride + offset
+constexpr uint16_t kSm0Clkdiv = 0x0C8;
+constexpr uint16_t kSmStride = 0x018;
+constexpr uint16_t kSmClkdiv = 0x000;
+constexpr uint16_t kSmExecctrl = 0x004;
+constexpr uint16_t kSmShiftctrl = 0x008;
+constexpr uint16_t kSmAddr = 0x00C;
+constexpr uint16_t kSmInstr = 0x010;
+constexpr uint16_t kSmPinctrl = 0x014;
+
+// Performance counter snapshots, SMx counter k is at kSm0Perf + x * kPerfStride + k * 4
+constexpr uint16_t kSm0Perf = 0x148;
+constexpr uint16_t kPerfStride = 0x014;
+enum PerfCounter : uint16_t { kRetired, kTxStall, kRxStall, kWaitStall, kJumps };
+
+constexpr uint16_t txf(unsigned sm) { return kTxf0 + 4 * sm; }
+constexpr uint16_t rxf(unsigned sm) { return kRxf0 + 4 * sm; }
+constexpr uint16_t sm_reg(unsigned sm, uint16_t reg) { return kSm0Clkdiv + sm * kSmStride + reg; }
+constexpr uint16_t perf(unsigned sm, PerfCounter counter) { return kSm0Perf + sm * kPerfStride + counter * 4; }
+
+// FSTAT fields
+constexpr uint32_t fstat_tx_empty(unsigned sm) { return 1u << (24 + sm); }
+constexpr uint32_t fstat_tx_full(unsigned sm) { return 1u << (16 + sm); }
+constexpr uint32_t fstat_rx_empty(unsigned sm) { return 1u << (8 + sm); }
+constexpr uint32_t fstat_rx_full(unsigned sm) { return 1u << sm; }
+
+// FLEVEL fields
+constexpr unsigned flevel_tx(uint32_t flevel, unsigned sm) { return flevel >> (8 * sm) & 0xF; }
+constexpr unsigned flevel_rx(uint32_t flevel, unsigned sm) { return flevel >> (8 * sm + 4) & 0xF; }
+
+// INSTR_BANK fields, see control_regfile. SWAP_SEL picks when a requested
+// swap happens: on the next clock, when SWAP_SM wraps, or on IRQ flag SWAP_IRQ.
+constexpr uint16_t kInstrBank = 0x198;
+constexpr uint32_t kInstrBankActive = 1u << 0;
+constexpr uint32_t kInstrBankSwapPending = 1u << 1;
+constexpr uint32_t kInstrBankShadowWrite = 1u << 4;
+constexpr uint32_t kInstrBankSwap = 1u << 31;
+enum SwapSel : uint32_t { kSwapNow = 0u << 8, kSwapAtWrap = 1u << 8, kSwapOnIrq = 2u << 8 };
+constexpr uint32_t swap_sm(unsigned sm) { return sm << 12; }
+constexpr uint32_t swap_irq(unsigned irq) { return irq << 16; }
+
+// RX FIFO random access. With exactly one of SHIFTCTRL's FJOIN_RX_PUT and
+// FJOIN_RX_GET set, RXFx_PUTGETy reads or writes entry y of SM x's RX FIFO.
+constexpr uint32_t kShiftctrlFjoinRxGet = 1u << 14;
+constexpr uint32_t kShiftctrlFjoinRxPut = 1u << 15;
+constexpr uint16_t kRxfPutget0 = 0x19C;
+constexpr uint16_t rxf_putget(unsigned sm, unsigned index) { return kRxfPutget0 + 0x10 * sm + 4 * index; }
+
+// The chip-level address puts the core in bits [10:9]
+constexpr uint16_t chip_addr(unsigned core, uint16_t addr) { return static_cast<uint16_t>(core << 9 | addr); }
+
+// Chip registers, the same in every core's window. IRQ_ALL has core y's IRQ
+// flags in bits [8y+7:8y]. SYNC_ARM has one bit per SM, SM x of core y at bit
+// 4 * y + x, and SYNC_TRIGGER applies to every armed SM.
+constexpr uint16_t kIrqAll = 0x1F4;
+constexpr uint16_t kSyncArm = 0x1F8;
+constexpr uint16_t kSyncTrigger = 0x1FC;
+constexpr uint32_t kSyncEnable = 1u << 0;
+constexpr uint32_t kSyncDisable = 1u << 1;
+constexpr uint32_t kSyncRestart = 1u << 2;
+constexpr uint32_t kSyncClkdivRestart = 1u << 3;
+constexpr unsigned sync_bit(unsigned core, unsigned sm) { return 4 * core + sm; }
+
+} // namespace pio_regs
+
+// While the chip is quiescent nothing retires or jumps, and each enabled SM
+// counts the same stall reason every cycle, so skipping `cycles` of them
+// adds `cycles` to those stall counters and nothing else. The reasons come
+// from the trace's flags, and the counters are written in place, so this
+// needs the model's root header.
+template <typename Chip>
+void credit_stalls(Chip &chip, uint64_t cycles) {
+    auto &root = *chip.rootp;
+    using Counts = decltype(root.pio_chip__DOT__core_0__DOT__control_regfile__DOT__perf_count);
+    Counts *const counts[] = {&root.pio_chip__DOT__core_0__DOT__control_regfile__DOT__perf_count,
+        &root.pio_chip__DOT__core_1__DOT__control_regfile__DOT__perf_count,
+        &root.pio_chip__DOT__core_2__DOT__control_regfile__DOT__perf_count,
+        &root.pio_chip__DOT__core_3__DOT__control_regfile__DOT__perf_count};
+    // Counters are 32 bits and wrap, as they would have in hardware
+    const uint32_t add = static_cast<uint32_t>(cycles);
+    for (unsigned core = 0; core < 4; core++) {
+        chip.reg_read_addr = pio_regs::chip_addr(core, pio_regs::kCtrl);
+        chip.eval();
+        const uint32_t enabled = chip.reg_data_out & 0xF;
+        for (unsigned sm = 0; sm < 4; sm++) {
+            if (!(enabled >> sm & 1)) continue;
+            // fsm_trace_t flags: tx_stall, rx_stall, wait_stall from bit 24
+            const uint32_t flags = root.pio_chip__DOT__trace[4 * core + sm][0] >> 24;
+            if (flags & 1) (*counts[core])[sm][pio_regs::kTxStall] += add;
+            if (flags & 2) (*counts[core])[sm][pio_regs::kRxStall] += add;
+            if (flags & 4) (*counts[core])[sm][pio_regs::kWaitStall] += add;
+        }
+    }
+}
+
+template <typename Chip>
+class PioBus {
+public:
+    explicit PioBus(Chip &chip) : chip_(chip) {
+        chip_.clk = 0;
+        chip_.reg_write_en = 0;
+        chip_.reg_read_en = 0;
+        chip_.eval();
+    }
+
+    void reset() {
+        chip_.rst = 1;
+        chip_.eval();
+        chip_.rst = 0;
+        chip_.eval();
+    }
+
+    void tick() {
+        chip_.clk = 1;
+        chip_.eval();
+        chip_.clk = 0;
+        chip_.eval();
+        cycle_++;
+    }
+
+    // Clocks the model `cycles` times. Once the chip reports quiescent nothing
+    // more can happen without host or pin activity, so the rest of the cycles
+    // are counted without being evaluated, and credited to the stall counters.
+    void run(uint64_t cycles) {
+        chip_.eval();
+        while (cycles) {
+            if (chip_.quiescent) {
+                credit_stalls(chip_, cycles);
+                cycle_ += cycles;
+                skipped_ += cycles;
+                return;
+            }
+            tick();
+            cycles--;
+        }
+    }
+
+    void write(unsigned core, uint16_t addr, uint32_t data) {
+        chip_.reg_write_addr = pio_regs::chip_addr(core, addr);
+        chip_.reg_data_in = data;
+        chip_.reg_write_en = 1;
+        tick();
+        chip_.reg_write_en = 0;
+    }
+
+    // Registers read combinationally, so this takes no clock
+    uint32_t read(unsigned core, uint16_t addr) {
+        chip_.reg_read_addr = pio_regs::chip_addr(core, addr);
+        chip_.eval();
+        return chip_.reg_data_out;
+    }
+
+    // Reads an RX FIFO, which pops it on the next clock
+    uint32_t pop(unsigned core, unsigned sm) {
+        uint32_t data = read(core, pio_regs::rxf(sm));
+        chip_.reg_read_en = 1;
+        tick();
+        chip_.reg_read_en = 0;
+        return data;
+    }
+
+    void push(unsigned core, unsigned sm, uint32_t data) { write(core, pio_regs::txf(sm), data); }
+
+    void load(unsigned core, unsigned offset, const uint16_t *instructions, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            write(core, pio_regs::kInstrMem0 + 4 * ((offset + i) & 0x1F), instructions[i]);
+        }
+    }
+
+    // Latches the performance counters so they can be read consistently
+    void snapshot_perf(unsigned core) { write(core, pio_regs::kPerfCtrl, 1); }
+
+    uint32_t perf(unsigned core, unsigned sm, pio_regs::PerfCounter counter) {
+        return read(core, pio_regs::perf(sm, counter));
+    }
+
+    uint64_t cycle() const { return cycle_; }
+    // Cycles run() fast-forwarded over
+    uint64_t skipped() const { return skipped_; }
+    Chip &chip() { return chip_; }
+
+private:
+    Chip &chip_;
+    uint64_t cycle_ = 0;
+    uint64_t skipped_ = 0;
+};
+
+#endif // PIO_BUS_H
@@ -0,0 +1,203 @@
+#ifndef PIO_COVERAGE_H
+#define PIO_COVERAGE_H
+
+// Functional coverage of the PIO instruction space
+//
+// One bin per instruction variant the encoding allows: every JMP condition,
+// WAIT polarity and source, IN source, OUT destination, PUSH/PULL flag
+// combination, MOV to and from RXFIFO[], MOV destination x op x source, IRQ
+// mode and SET destination. Operand values, delay and side-set don't get
+// bins of their own. On top of those there are bins for each stall reason and
+// each TX/RX FIFO level.
+//
+// A simulation driver samples the trace port every cycle (and FLEVEL if it
+// can) and saves the counts when it's done. Saved files are plain text, one
+// "bin count" line per bin, and merge by name, so shards run in parallel can
+// be combined with piocov and the report shows what none of them reached.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pio_disasm.h"
+#include "pio_trace.h"
+
+namespace pio_coverage {
+
+constexpr const char *kHeader = "# pio_coverage 1";
+
+class Coverage {
+public:
+    Coverage() {
+        using namespace pio_asm::detail;
+        static constexpr const char *kOps[] = {"", "!", "::"};
+
+        // Bins are keyed on the opcode and the low byte, everything in [12:8]
+        // is delay/side-set
+        std::map<std::string, uint16_t> index;
+        for (unsigned key = 0; key < kKeys; key++) {
+            const uint16_t instr = static_cast<uint16_t>((key >> 8) << 13 | (key & 0xFF));
+            const uint16_t arg1 = instr >> 5 & 0x07;
+            std::string name;
+            switch (instr >> 13) {
+            case 0:
+                name = arg1 ? "jmp " + std::string(name_of(arg1, kJmpConditions)) : "jmp";
+                break;
+            case 1:
+                if ((arg1 & 0x03) != 3) {
+                    name = "wait " + std::to_string(instr >> 7 & 1) + " " +
+                        std::string(name_of(arg1 & 0x03, kWaitSources));
+                }
+                break;
+            case 2:
+                name = "in " + std::string(name_of(arg1, kInSources));
+                break;
+            case 3:
+                name = "out " + std::string(name_of(arg1, kOutDestinations));
+                break;
+            case 4:
+                if (!(instr & 0x1F)) {
+                    const bool is_pull = instr & 0x80;
+                    name = is_pull ? "pull" : "push";
+                    if (instr & 0x40) name += is_pull ? " ifempty" : " iffull";
+                    name += (instr & 0x20) ? " block" : " noblock";
+                } else if ((instr & 0x74) == 0x10) {
+                    // RX FIFO random access, Y or a fixed entry share a bin
+                    name = (instr & 0x80) ? "mov osr, rxfifo[]" : "mov rxfifo[], isr";
+                }
+                break;
+            case 5:
+                if ((instr >> 3 & 0x03) != 3) {
+                    name = "mov " + std::string(name_of(arg1, kMovDestinations)) + ", " +
+                        kOps[instr >> 3 & 0x03] + std::string(name_of(instr & 0x07, kMovSources));
+                }
+                break;
+            case 6:
+                if (!(instr & 0x80)) name = (instr & 0x40) ? "irq clear" : (instr & 0x20) ? "irq wait" : "irq";
+                break;
+            case 7:
+                name = "set " + std::string(name_of(arg1, kSetDestinations));
+                break;
+            }
+
+            // Reserved encodings don't count towards anything
+            if (name.empty() || name.find('?') != std::string::npos) {
+                instr_bin_[key] = kNoBin;
+                continue;
+            }
+            auto [it, added] = index.try_emplace(name, static_cast<uint16_t>(names_.size()));
+            if (added) names_.push_back(name);
+            instr_bin_[key] = it->second;
+        }
+        instruction_bins_ = names_.size();
+
+        stall_bin_ = names_.size();
+        for (const char *reason : {"stall tx", "stall rx", "stall wait"}) names_.push_back(reason);
+        level_bin_ = names_.size();
+        for (const char *fifo : {"tx", "rx"}) {
+            for (int level = 0; level <= 4; level++) {
+                names_.push_back(std::string(fifo) + " level " + std::to_string(level));
+            }
+        }
+
+        counts_.assign(names_.size(), 0);
+    }
+
+    // Instruction being decoded this cycle
+    void sample_instruction(uint16_t instr) {
+        const uint16_t bin = instr_bin_[(instr >> 13) << 8 | (instr & 0xFF)];
+        if (bin != kNoBin) counts_[bin]++;
+    }
+
+    void sample_stalls(uint8_t trace_flags) {
+        if (trace_flags & pio_trace::kTxStall) counts_[stall_bin_]++;
+        if (trace_flags & pio_trace::kRxStall) counts_[stall_bin_ + 1]++;
+        if (trace_flags & pio_trace::kWaitStall) counts_[stall_bin_ + 2]++;
+    }
+
+    void sample_levels(unsigned tx_level, unsigned rx_level) {
+        if (tx_level <= 4) counts_[level_bin_ + tx_level]++;
+        if (rx_level <= 4) counts_[level_bin_ + 5 + rx_level]++;
+    }
+
+    // Everything the trace port carries
+    void sample(const pio_trace::State &state) {
+        sample_instruction(state.instruction);
+        sample_stalls(state.flags);
+    }
+
+    std::size_t bins() const { return names_.size(); }
+    std::size_t instruction_bins() const { return instruction_bins_; }
+    const std::string &name(std::size_t bin) const { return names_[bin]; }
+    uint64_t count(std::size_t bin) const { return counts_[bin]; }
+
+    uint64_t count(const std::string &name) const {
+        for (std::size_t i = 0; i < names_.size(); i++) {
+            if (names_[i] == name) return counts_[i];
+        }
+        throw std::out_of_range("no coverage bin " + name);
+    }
+
+    std::size_t covered(std::size_t first = 0, std::size_t last = SIZE_MAX) const {
+        std::size_t n = 0;
+        for (std::size_t i = first; i < counts_.size() && i < last; i++) n += counts_[i] != 0;
+        return n;
+    }
+
+    void save(const std::string &path) const {
+        std::FILE *file = std::fopen(path.c_str(), "w");
+        if (!file) throw std::runtime_error("can't write " + path);
+        std::fprintf(file, "%s\n", kHeader);
+        for (std::size_t i = 0; i < names_.size(); i++) {
+            std::fprintf(file, "%s %llu\n", names_[i].c_str(), static_cast<unsigned long long>(counts_[i]));
+        }
+        std::fclose(file);
+    }
+
+    // Adds the counts in a saved file. Bins this build doesn't know are skipped.
+    void merge(const std::string &path) {
+        std::ifstream file(path);
+        std::string line;
+        if (!std::getline(file, line) || line != kHeader) {
+            throw std::runtime_error(path + " is not a coverage file");
+        }
+        std::map<std::string, std::size_t> index;
+        for (std::size_t i = 0; i < names_.size(); i++) index[names_[i]] = i;
+        while (std::getline(file, line)) {
+            const std::size_t space = line.rfind(' ');
+            if (space == std::string::npos) continue;
+            auto it = index.find(line.substr(0, space));
+            if (it != index.end()) counts_[it->second] += std::stoull(line.substr(space + 1));
+        }
+    }
+
+    // Summary per group, then the bins nothing has hit (every bin if `all`)
+    void report(std::FILE *out, bool all = false) const {
+        std::fprintf(out, "instructions %zu/%zu, stalls %zu/3, fifo levels %zu/10\n",
+            covered(0, instruction_bins_), instruction_bins_, covered(stall_bin_, level_bin_),
+            covered(level_bin_));
+        for (std::size_t i = 0; i < names_.size(); i++) {
+            if (all) std::fprintf(out, "%12llu  %s\n", static_cast<unsigned long long>(counts_[i]), names_[i].c_str());
+            else if (!counts_[i]) std::fprintf(out, "uncovered  %s\n", names_[i].c_str());
+        }
+    }
+
+private:
+    static constexpr unsigned kKeys = 8 * 256;
+    static constexpr uint16_t kNoBin = 0xFFFF;
+
+    uint16_t instr_bin_[kKeys];
+    std::vector<std::string> names_;
+    std::vector<uint64_t> counts_;
+    std::size_t instruction_bins_ = 0;
+    std::size_t stall_bin_ = 0;
+    std::size_t level_bin_ = 0;
+};
+
+} // namespace pio_coverage
+
+#endif // PIO_COVERAGE_H
@@ -0,0 +1,114 @@
+#ifndef PIO_DISASM_H
+#define PIO_DISASM_H
+
+// PIO disassembler
+//
+// The inverse of pio_asm.h: turns a 16-bit instruction back into pioasm
+// syntax. The side-set configuration isn't part of the instruction, so it has
+// to be supplied to split the delay/side-set field correctly.
+//
+//     pio_asm::disassemble(0x0045)           // "jmp x--, 5"
+//     pio_asm::disassemble(0xFF01, 1, true)  // "set pins, 1 side 1 [7]"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "pio_asm.h"
+
+namespace pio_asm {
+
+namespace detail {
+
+constexpr std::string_view name_of(uint16_t code, const Operand &operand) {
+    for (std::size_t i = 0; i < 8; i++) {
+        if (!operand.values[i].empty() && operand.codes[i] == code) return operand.values[i];
+    }
+    return "?";
+}
+
+inline std::string irq_index(uint16_t index) {
+    switch (index >> 3 & 0x03) {
+    case 1: return "prev " + std::to_string(index & 0x07);
+    case 3: return "next " + std::to_string(index & 0x07);
+    }
+    std::string out = std::to_string(index & 0x07);
+    if (index & 0x10) out += " rel";
+    return out;
+}
+
+} // namespace detail
+
+inline std::string disassemble(uint16_t instr, uint8_t sideset_bits = 0, bool sideset_opt = false) {
+    using namespace detail;
+
+    const uint16_t arg1 = (instr >> 5) & 0x07;
+    const uint16_t arg2 = instr & 0x1F;
+    std::string out;
+
+    switch (instr >> 13) {
+    case 0: // JMP
+        out = "jmp ";
+        if (arg1 != 0) out += std::string(name_of(arg1, kJmpConditions)) + ", ";
+        out += std::to_string(arg2);
+        break;
+    case 1: // WAIT
+        out = "wait " + std::to_string(instr >> 7 & 1) + " " + std::string(name_of(arg1 & 0x03, kWaitSources)) + " ";
+        out += (arg1 & 0x03) == 2 ? irq_index(arg2) : std::to_string(arg2);
+        break;
+    case 2: // IN
+        out = "in " + std::string(name_of(arg1, kInSources)) + ", " + std::to_string(arg2 ? arg2 : 32);
+        break;
+    case 3: // OUT
+        out = "out " + std::string(name_of(arg1, kOutDestinations)) + ", " + std::to_string(arg2 ? arg2 : 32);
+        break;
+    case 4: { // PUSH, PULL
+        const bool is_pull = instr & 0x80;
+        if (instr & 0x10) {
+            // RX FIFO random access
+            const std::string entry = "rxfifo[" + (instr & 0x08 ? std::to_string(instr & 0x03) : "y") + "]";
+            out = is_pull ? "mov osr, " + entry : "mov " + entry + ", isr";
+            break;
+        }
+        out = is_pull ? "pull" : "push";
+        if (instr & 0x40) out += is_pull ? " ifempty" : " iffull";
+        out += (instr & 0x20) ? " block" : " noblock";
+        break;
+    }
+    case 5: { // MOV
+        if ((instr & 0xFF) == 0x42) { // mov y, y
+            out = "nop";
+            break;
+        }
+        static constexpr std::string_view kOps[] = {"", "!", "::", "?"};
+        out = "mov " + std::string(name_of(arg1, kMovDestinations)) + ", " + std::string(kOps[instr >> 3 & 0x03]) +
+            std::string(name_of(instr & 0x07, kMovSources));
+        break;
+    }
+    case 6: // IRQ
+        out = "irq ";
+        if (instr & 0x40) out += "clear ";
+        else if (instr & 0x20) out += "wait ";
+        out += irq_index(arg2);
+        break;
+    case 7: // SET
+        out = "set " + std::string(name_of(arg1, kSetDestinations)) + ", " + std::to_string(arg2);
+        break;
+    }
+
+    // Delay/side-set field, side-set bits (and the enable bit) at the top
+    const uint16_t field = instr >> 8 & 0x1F;
+    const unsigned total_sideset = sideset_bits + (sideset_opt ? 1 : 0);
+    const uint16_t delay = field & ((1u << (5 - total_sideset)) - 1);
+    const bool has_sideset = sideset_bits != 0 && (!sideset_opt || (field & 0x10));
+    if (has_sideset) {
+        out += " side " + std::to_string(field >> (5 - total_sideset) & ((1u << sideset_bits) - 1));
+    }
+    if (delay) out += " [" + std::to_string(delay) + "]";
+
+    return out;
+}
+
+} // namespace pio_asm
+
+#endif // PIO_DISASM_H
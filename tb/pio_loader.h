@@ -0,0 +1,112 @@
+#ifndef PIO_LOADER_H
+#define PIO_LOADER_H
+
+// Instruction memory allocation, so several programs can share a core
+//
+// Each core's 32-word instruction memory is shared by its four state
+// machines. Loader tracks which words are in use per core and places
+// pio_asm programs the way the SDK's pio_add_program() does: at their
+// .origin if they have one, otherwise as high up as they fit. Assembled
+// programs jump relative to their own start, so JMP targets are relocated
+// on the way in, and the returned Placement has the wrap bounds moved to
+// match:
+//
+//     pio_loader::Loader<Vpio_chip> loader(bus);
+//     auto uart = loader.add(0, kUartTx);
+//     auto spi = loader.add(0, kSpi);
+//     bus.write(0, pio_regs::sm_reg(1, pio_regs::kSmExecctrl), spi->execctrl());
+//
+// The free-space helpers work on a plain 32-bit used mask, which is also
+// what the hardware_pio shim keeps in pio_hw_t.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "pio_asm.h"
+#include "pio_bus.h"
+
+namespace pio_loader {
+
+constexpr unsigned kInstructionCount = 32;
+
+// JMP targets are relative to the start of the program
+constexpr uint16_t relocate(uint16_t instr, unsigned offset) {
+    if ((instr & 0xE000) != 0x0000) return instr;
+    return static_cast<uint16_t>((instr & ~0x1Fu) | ((instr + offset) & 0x1Fu));
+}
+
+// The words a program of `length` occupies at `offset`
+constexpr uint32_t slot_mask(unsigned length, unsigned offset) {
+    return (length >= kInstructionCount ? 0xFFFFFFFFu : (1u << length) - 1) << offset;
+}
+
+// `origin` is -1 for a program that can go anywhere
+constexpr bool can_place(uint32_t used, unsigned length, int origin, unsigned offset) {
+    if (origin >= 0 && static_cast<unsigned>(origin) != offset) return false;
+    if (offset + length > kInstructionCount) return false;
+    return !(used & slot_mask(length, offset));
+}
+
+// Like the SDK, pack programs in from the top of memory. -1 if there's no room.
+constexpr int find_offset(uint32_t used, unsigned length, int origin) {
+    if (origin >= 0) return can_place(used, length, origin, origin) ? origin : -1;
+    for (int offset = static_cast<int>(kInstructionCount) - static_cast<int>(length); offset >= 0; offset--) {
+        if (can_place(used, length, -1, offset)) return offset;
+    }
+    return -1;
+}
+
+// Where a program ended up, with its wrap bounds in memory addresses
+struct Placement {
+    unsigned offset;
+    unsigned length;
+    uint8_t wrap_target;
+    uint8_t wrap;
+
+    // EXECCTRL's WRAP_TOP and WRAP_BOTTOM fields, to be or'd with the others
+    constexpr uint32_t execctrl() const { return static_cast<uint32_t>(wrap) << 12 | wrap_target << 7; }
+};
+
+template <typename Chip>
+class Loader {
+public:
+    explicit Loader(PioBus<Chip> &bus) : bus_(bus) {}
+
+    // Loads `program` wherever it fits in `core`, or returns nothing if it
+    // doesn't fit anywhere
+    template <std::size_t N>
+    std::optional<Placement> add(unsigned core, const pio_asm::Program<N> &program) {
+        const int offset = find_offset(used_[core], N, program.origin);
+        if (offset < 0) return std::nullopt;
+        return add_at(core, program, static_cast<unsigned>(offset));
+    }
+
+    template <std::size_t N>
+    std::optional<Placement> add_at(unsigned core, const pio_asm::Program<N> &program, unsigned offset) {
+        if (!can_place(used_[core], N, program.origin, offset)) return std::nullopt;
+        for (std::size_t i = 0; i < N; i++) {
+            bus_.write(core, pio_regs::kInstrMem0 + 4 * (offset + i), relocate(program.instructions[i], offset));
+        }
+        used_[core] |= slot_mask(N, offset);
+        return Placement{offset, static_cast<unsigned>(N), static_cast<uint8_t>(offset + program.wrap_target),
+            static_cast<uint8_t>(offset + program.wrap)};
+    }
+
+    // Frees the words for reuse. The instructions stay in memory until
+    // something else is loaded over them.
+    void remove(unsigned core, const Placement &placement) {
+        used_[core] &= ~slot_mask(placement.length, placement.offset);
+    }
+
+    uint32_t used(unsigned core) const { return used_[core]; }
+
+private:
+    PioBus<Chip> &bus_;
+    std::array<uint32_t, 4> used_{};
+};
+
+} // namespace pio_loader
+
+#endif // PIO_LOADER_H
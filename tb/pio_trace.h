@@ -0,0 +1,290 @@
+#ifndef PIO_TRACE_H
+#define PIO_TRACE_H
+
+// Instruction-level execution trace
+//
+// A compact alternative to VCD for looking at what the state machines did.
+// The simulation driver samples every SM's trace port once per clock and the
+// writer only stores what changed since the previous sample for that SM.
+//
+// File layout, all little-endian:
+//
+//     Header     magic "PIOTRACE", u32 version, u32 sm_count
+//     Record*    varint cycle delta (since the previous record)
+//                u8 sm index, kEndOfTrace for the last record
+//                u8 mask of the fields that follow (Field)
+//                u8 pc, u16 instruction, u8 flags
+//                varint zigzag(x - previous x), varint zigzag(y - previous y)
+//                varint (osr ^ previous osr)
+//
+// Fields not in the mask are unchanged. Every SM starts from the reset state
+// (all zeroes). The file is read by mapping it and walking the records, see
+// Reader.
+//
+// The flags come from the FSM's registered stall/retire signals, so the flags
+// on a sample describe the instruction that was issued on the cycle before.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pio_trace {
+
+constexpr char kMagic[8] = {'P', 'I', 'O', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t kVersion = 1;
+constexpr unsigned kMaxStateMachines = 16;
+constexpr uint8_t kEndOfTrace = 0xFF;
+
+enum Flags : uint8_t {
+    kTxStall = 1 << 0,
+    kRxStall = 1 << 1,
+    kWaitStall = 1 << 2,
+    kRetired = 1 << 3,
+};
+
+enum Field : uint8_t {
+    kPc = 1 << 0,
+    kInstruction = 1 << 1,
+    kFlags = 1 << 2,
+    kX = 1 << 3,
+    kY = 1 << 4,
+    kOsr = 1 << 5,
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t sm_count;
+};
+
+struct State {
+    uint8_t pc = 0;
+    uint16_t instruction = 0;
+    uint8_t flags = 0;
+    uint32_t x = 0, y = 0, osr = 0;
+
+    // Unpacks fsm_trace_t, see types.svh for the word layout
+    static State from_words(const uint32_t *words) {
+        State state;
+        state.pc = words[0] & 0x1F;
+        state.instruction = words[0] >> 8 & 0xFFFF;
+        state.flags = words[0] >> 24 & 0x0F;
+        state.x = words[1];
+        state.y = words[2];
+        state.osr = words[3];
+        return state;
+    }
+};
+
+struct Event {
+    uint64_t cycle;
+    unsigned sm;
+    uint8_t changed; // Field mask
+    State state; // Full state after this record
+};
+
+namespace detail {
+
+inline void put_varint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint32_t zigzag(uint32_t delta) {
+    return (delta << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(delta) >> 31);
+}
+
+inline uint32_t unzigzag(uint32_t value) {
+    return (value >> 1) ^ (0u - (value & 1));
+}
+
+} // namespace detail
+
+class Writer {
+public:
+    Writer(const std::string &path, unsigned sm_count) : sm_count_(sm_count) {
+        if (sm_count == 0 || sm_count > kMaxStateMachines) throw std::invalid_argument("bad state machine count");
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) throw std::runtime_error("can't open " + path);
+
+        Header header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.sm_count = sm_count;
+        std::fwrite(&header, sizeof(header), 1, file_);
+        buffer_.reserve(kFlushSize + 64);
+    }
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    ~Writer() {
+        if (!file_) return;
+        detail::put_varint(buffer_, cycle_ - last_cycle_);
+        buffer_.push_back(kEndOfTrace);
+        buffer_.push_back(0);
+        flush();
+        std::fclose(file_);
+    }
+
+    void sample(uint64_t cycle, unsigned sm, const State &state) {
+        cycle_ = cycle;
+        State &last = last_[sm];
+        uint8_t mask = 0;
+        if (state.pc != last.pc) mask |= kPc;
+        if (state.instruction != last.instruction) mask |= kInstruction;
+        if (state.flags != last.flags) mask |= kFlags;
+        if (state.x != last.x) mask |= kX;
+        if (state.y != last.y) mask |= kY;
+        if (state.osr != last.osr) mask |= kOsr;
+        if (!mask) return;
+
+        detail::put_varint(buffer_, cycle - last_cycle_);
+        buffer_.push_back(static_cast<uint8_t>(sm));
+        buffer_.push_back(mask);
+        if (mask & kPc) buffer_.push_back(state.pc);
+        if (mask & kInstruction) {
+            buffer_.push_back(state.instruction & 0xFF);
+            buffer_.push_back(state.instruction >> 8);
+        }
+        if (mask & kFlags) buffer_.push_back(state.flags);
+        if (mask & kX) detail::put_varint(buffer_, detail::zigzag(state.x - last.x));
+        if (mask & kY) detail::put_varint(buffer_, detail::zigzag(state.y - last.y));
+        if (mask & kOsr) detail::put_varint(buffer_, state.osr ^ last.osr);
+
+        last = state;
+        last_cycle_ = cycle;
+        if (buffer_.size() >= kFlushSize) flush();
+    }
+
+    // Ends the trace on the last cycle of a `cycles` long run, for runs that
+    // stopped sampling early because nothing more could change
+    void finish(uint64_t cycles) {
+        if (cycles) cycle_ = std::max(cycle_, cycles - 1);
+    }
+
+    unsigned sm_count() const { return sm_count_; }
+
+private:
+    static constexpr std::size_t kFlushSize = 1 << 16;
+
+    void flush() {
+        std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+        buffer_.clear();
+    }
+
+    std::FILE *file_ = nullptr;
+    unsigned sm_count_;
+    uint64_t cycle_ = 0;
+    uint64_t last_cycle_ = 0;
+    State last_[kMaxStateMachines]{};
+    std::vector<uint8_t> buffer_;
+};
+
+class Reader {
+public:
+    explicit Reader(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("can't open " + path);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+            ::close(fd);
+            throw std::runtime_error(path + " is not a PIO trace");
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        void *map = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) throw std::runtime_error("can't map " + path);
+        data_ = static_cast<const uint8_t *>(map);
+
+        Header header;
+        std::memcpy(&header, data_, sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+            header.sm_count == 0 || header.sm_count > kMaxStateMachines) {
+            ::munmap(const_cast<uint8_t *>(data_), size_);
+            throw std::runtime_error(path + " is not a PIO trace");
+        }
+        sm_count_ = header.sm_count;
+        pos_ = sizeof(Header);
+    }
+
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+
+    ~Reader() { ::munmap(const_cast<uint8_t *>(data_), size_); }
+
+    // Decodes the next record, false at the end of the trace
+    bool next(Event &event) {
+        if (done_) return false;
+        cycle_ += varint();
+        unsigned sm = byte();
+        uint8_t mask = byte();
+        if (sm == kEndOfTrace) {
+            done_ = true;
+            return false;
+        }
+        if (sm >= sm_count_) throw std::runtime_error("corrupt trace: bad state machine index");
+
+        State &state = states_[sm];
+        if (mask & kPc) state.pc = byte();
+        if (mask & kInstruction) {
+            state.instruction = byte();
+            state.instruction |= static_cast<uint16_t>(byte()) << 8;
+        }
+        if (mask & kFlags) state.flags = byte();
+        if (mask & kX) state.x += detail::unzigzag(static_cast<uint32_t>(varint()));
+        if (mask & kY) state.y += detail::unzigzag(static_cast<uint32_t>(varint()));
+        if (mask & kOsr) state.osr ^= static_cast<uint32_t>(varint());
+
+        event.cycle = cycle_;
+        event.sm = sm;
+        event.changed = mask;
+        event.state = state;
+        return true;
+    }
+
+    unsigned sm_count() const { return sm_count_; }
+
+    // Cycle of the last record read, the final cycle once next() returns false
+    uint64_t cycle() const { return cycle_; }
+
+private:
+    uint8_t byte() {
+        if (pos_ >= size_) throw std::runtime_error("corrupt trace: truncated record");
+        return data_[pos_++];
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return value;
+        }
+        throw std::runtime_error("corrupt trace: bad varint");
+    }
+
+    const uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t pos_ = 0;
+    unsigned sm_count_ = 0;
+    uint64_t cycle_ = 0;
+    bool done_ = false;
+    State states_[kMaxStateMachines]{};
+};
+
+} // namespace pio_trace
+
+#endif // PIO_TRACE_H
@@ -0,0 +1,56 @@
+// piocov - merges and reports functional coverage saved by the sim or benches
+//
+//     piocov [-o merged.cov] [--all] <coverage>...
+//
+// Prints how many bins were hit in each group and lists the ones nothing
+// reached, or every bin with its count with --all. -o also saves the merged
+// counts, so shards can be merged in stages.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "pio_coverage.h"
+
+namespace {
+
+void usage() {
+    std::fprintf(stderr, "usage: piocov [-o merged.cov] [--all] <coverage>...\n");
+    std::exit(2);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const char *out_path = nullptr;
+    bool all = false;
+    std::vector<const char *> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-o") && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--all")) {
+            all = true;
+        } else if (argv[i][0] == '-') {
+            usage();
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (inputs.empty()) usage();
+
+    pio_coverage::Coverage coverage;
+    try {
+        for (const char *path : inputs) coverage.merge(path);
+        if (out_path) coverage.save(out_path);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "piocov: %s\n", e.what());
+        return 1;
+    }
+
+    coverage.report(stdout, all);
+    return 0;
+}
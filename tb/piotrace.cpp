@@ -0,0 +1,135 @@
+// piotrace - reads an instruction trace written by the sim
+//
+//     piotrace <trace> [--sm N] [--hot N] [--side-set BITS[opt]] [--quiet]
+//
+// Prints every instruction issue as disassembly with the registers it
+// changed, then a per-SM summary of the PCs that took the most cycles.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "pio_disasm.h"
+#include "pio_trace.h"
+
+namespace {
+
+struct PcStats {
+    uint64_t cycles = 0;
+    uint64_t stalls = 0;
+};
+
+void usage() {
+    std::fprintf(stderr, "usage: piotrace <trace> [--sm N] [--hot N] [--side-set BITS[opt]] [--quiet]\n");
+    std::exit(2);
+}
+
+std::string stall_reason(uint8_t flags) {
+    std::string out;
+    if (flags & pio_trace::kTxStall) out += " tx";
+    if (flags & pio_trace::kRxStall) out += " rx";
+    if (flags & pio_trace::kWaitStall) out += " wait";
+    return out.empty() ? out : " stall:" + out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) usage();
+
+    const char *path = nullptr;
+    int only_sm = -1;
+    unsigned hot = 8;
+    uint8_t sideset_bits = 0;
+    bool sideset_opt = false;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--sm") && i + 1 < argc) {
+            only_sm = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--hot") && i + 1 < argc) {
+            hot = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--side-set") && i + 1 < argc) {
+            sideset_bits = std::atoi(argv[++i]);
+            sideset_opt = std::strstr(argv[i], "opt") != nullptr;
+        } else if (!std::strcmp(argv[i], "--quiet")) {
+            quiet = true;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage();
+        }
+    }
+    if (!path) usage();
+
+    try {
+        pio_trace::Reader reader(path);
+        const unsigned sm_count = reader.sm_count();
+
+        std::vector<std::vector<PcStats>> stats(sm_count, std::vector<PcStats>(32));
+        std::vector<pio_trace::State> state(sm_count);
+        std::vector<uint64_t> since(sm_count, 0);
+
+        // Charges the cycles an SM spent in its previous state up to `cycle`
+        auto account = [&](unsigned sm, uint64_t cycle) {
+            PcStats &pc = stats[sm][state[sm].pc];
+            pc.cycles += cycle - since[sm];
+            if (state[sm].flags & (pio_trace::kTxStall | pio_trace::kRxStall | pio_trace::kWaitStall)) {
+                pc.stalls += cycle - since[sm];
+            }
+            since[sm] = cycle;
+        };
+
+        pio_trace::Event event;
+        while (reader.next(event)) {
+            account(event.sm, event.cycle);
+            const pio_trace::State &prev = state[event.sm];
+            const pio_trace::State &now = event.state;
+
+            if (!quiet && (only_sm < 0 || static_cast<unsigned>(only_sm) == event.sm)) {
+                std::string line = pio_asm::disassemble(now.instruction, sideset_bits, sideset_opt);
+                std::printf("%10" PRIu64 "  sm%-2u  %2u: %04x  %-28s", event.cycle, event.sm, now.pc,
+                    now.instruction, line.c_str());
+                if (event.changed & pio_trace::kX) std::printf(" x=%08x", now.x);
+                if (event.changed & pio_trace::kY) std::printf(" y=%08x", now.y);
+                if (event.changed & pio_trace::kOsr) std::printf(" osr=%08x", now.osr);
+                if ((now.flags ^ prev.flags) & ~pio_trace::kRetired) {
+                    std::printf("%s", stall_reason(now.flags).c_str());
+                }
+                std::printf("\n");
+            }
+            state[event.sm] = now;
+        }
+
+        const uint64_t end = reader.cycle();
+        std::printf("\n%" PRIu64 " cycles\n", end);
+        for (unsigned sm = 0; sm < sm_count; sm++) {
+            if (only_sm >= 0 && static_cast<unsigned>(only_sm) != sm) continue;
+            account(sm, end);
+
+            std::vector<unsigned> order;
+            for (unsigned pc = 0; pc < 32; pc++) {
+                if (stats[sm][pc].cycles) order.push_back(pc);
+            }
+            if (order.empty()) continue;
+            std::sort(order.begin(), order.end(),
+                [&](unsigned a, unsigned b) { return stats[sm][a].cycles > stats[sm][b].cycles; });
+            if (order.size() > hot) order.resize(hot);
+
+            std::printf("\nsm%u hot PCs\n", sm);
+            for (unsigned pc : order) {
+                std::printf("  %2u  %10" PRIu64 " cycles  %5.1f%%  %10" PRIu64 " stalled\n", pc,
+                    stats[sm][pc].cycles, end ? 100.0 * stats[sm][pc].cycles / end : 0.0, stats[sm][pc].stalls);
+            }
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "piotrace: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
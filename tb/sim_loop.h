@@ -0,0 +1,118 @@
+#ifndef SIM_LOOP_H
+#define SIM_LOOP_H
+
+// The sim driver's clock loop
+//
+// Clocks a verilated pio_chip for a fixed number of cycles, feeding it
+// stimulus and handing each cycle to whichever recorders are attached. While
+// the chip is quiescent nothing can change until the stimulus does, so the
+// loop jumps straight to the next stimulus change (or the end of the run).
+// The recorders are told where the run ended, so a skipped tail leaves them
+// the same length as a full run.
+//
+// Lives in a header so the tests can check a skipping run against one that
+// simulates every cycle.
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Vpio_chip.h"
+#include "Vpio_chip___024root.h"
+#include "verilated_vcd_c.h"
+
+#include "gpio_capture.h"
+#include "gpio_stimulus.h"
+#include "pio_bus.h"
+#include "pio_coverage.h"
+#include "pio_trace.h"
+
+namespace sim_loop {
+
+struct Options {
+    uint64_t cycles = 10;
+    // Jump over cycles where the chip is quiescent. Ignored with coverage,
+    // which counts every stalled cycle.
+    bool skip = true;
+    // Everything below is optional
+    gpio_stimulus::Stimulus *stimulus = nullptr;
+    VerilatedVcdC *vcd = nullptr;
+    pio_trace::Writer *itrace = nullptr;
+    gpio_capture::Capture *capture = nullptr;
+    pio_coverage::Coverage *coverage = nullptr;
+};
+
+// The trace isn't one of pio_chip's ports, the driver reads it through
+// verilator public_flat_rd
+inline pio_trace::State trace_state(Vpio_chip &chip, unsigned sm) {
+    return pio_trace::State::from_words(chip.rootp->pio_chip__DOT__trace[sm].data());
+}
+
+// Returns the number of cycles that were actually evaluated
+inline uint64_t run(Vpio_chip &chip, const Options &options) {
+    const bool skip = options.skip && !options.coverage;
+    uint64_t time = 0;
+    uint64_t evaluated = 0;
+    bool skipped_tail = false;
+
+    for (uint64_t cycle = 0; cycle < options.cycles; cycle++) {
+        // Inputs change while the clock is low, ahead of the rising edge that samples them
+        if (options.stimulus) options.stimulus->apply(cycle, chip.gpio);
+
+        chip.clk = 1;                    // Rising edge
+        chip.eval();                     // Evaluate the design
+        if (options.vcd) options.vcd->dump(time); // Dump signal states
+        time += 5;                       // Increment simulation time
+        evaluated++;
+
+        if (options.itrace) {
+            for (unsigned sm = 0; sm < pio_trace::kMaxStateMachines; sm++) {
+                options.itrace->sample(cycle, sm, trace_state(chip, sm));
+            }
+        }
+        if (options.coverage) {
+            for (unsigned sm = 0; sm < pio_trace::kMaxStateMachines; sm++) {
+                options.coverage->sample(trace_state(chip, sm));
+            }
+            // FIFO levels come from FLEVEL, the sim doesn't use the register bus otherwise
+            for (unsigned core = 0; core < 4; core++) {
+                chip.reg_read_addr = pio_regs::chip_addr(core, pio_regs::kFlevel);
+                chip.eval();
+                for (unsigned sm = 0; sm < 4; sm++) {
+                    options.coverage->sample_levels(pio_regs::flevel_tx(chip.reg_data_out, sm),
+                        pio_regs::flevel_rx(chip.reg_data_out, sm));
+                }
+            }
+        }
+        if (options.capture) {
+            options.capture->sample(cycle, chip.gpio, chip.rootp->pio_chip__DOT__out_data,
+                chip.rootp->pio_chip__DOT__dir);
+        }
+
+        chip.clk = 0;                    // Falling edge
+        chip.eval();
+        if (options.vcd) options.vcd->dump(time);
+        time += 5;
+
+        // Nothing changes until the stimulus does, so move straight to it.
+        // The recorders only store changes, so the skipped cycles need no
+        // samples; the stall counters are credited with them.
+        if (skip && chip.quiescent) {
+            const uint64_t next = options.stimulus ? std::min(options.stimulus->next_change(cycle), options.cycles)
+                                                   : options.cycles;
+            skipped_tail = next == options.cycles && next > cycle + 1;
+            credit_stalls(chip, next - cycle - 1);
+            time += 10 * (next - cycle - 1);
+            cycle = next - 1;
+        }
+    }
+
+    // A skipped tail wasn't sampled, so say where the run really ended
+    if (options.itrace) options.itrace->finish(options.cycles);
+    if (options.capture) options.capture->finish(options.cycles);
+    if (options.vcd && skipped_tail) options.vcd->dump(time - 5);
+    return evaluated;
+}
+
+} // namespace sim_loop
+
+#endif // SIM_LOOP_H
@@ -1,30 +1,97 @@
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
 #include "Vpio_chip.h"
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 
+#include "gpio_capture.h"
+#include "gpio_stimulus.h"
+#include "pio_coverage.h"
+#include "pio_trace.h"
+#include "sim_loop.h"
+
 int main(int argc, char **argv) {
     Verilated::commandArgs(argc, argv);
     Verilated::traceEverOn(true);
 
+    uint64_t cycles = 10;
+    bool cycles_set = false;
+    bool vcd = true;
+    // Jump over cycles where the chip is quiescent, --no-skip simulates them
+    // all. Coverage always simulates them all, see sim_loop.h.
+    bool skip = true;
+    // --itrace <file> also writes an instruction trace, see pio_trace.h
+    std::unique_ptr<pio_trace::Writer> itrace;
+    // --capture <file> records GPIO edges, as a sigrok session if it ends in .sr
+    std::unique_ptr<gpio_capture::Capture> capture;
+    std::string capture_path;
+    uint64_t samplerate = 125000000;
+    // --stimulus <file> replays recorded pin values into gpio, see gpio_stimulus.h
+    std::unique_ptr<gpio_stimulus::Stimulus> stimulus;
+    // --coverage <file> saves functional coverage, merge and report with piocov.
+    // Stalled cycles are coverage bins, so this turns off skipping.
+    std::unique_ptr<pio_coverage::Coverage> coverage;
+    std::string coverage_path;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--no-vcd")) {
+            vcd = false;
+        } else if (!std::strcmp(argv[i], "--no-skip")) {
+            skip = false;
+        } else if (i + 1 == argc) {
+            break;
+        } else if (!std::strcmp(argv[i], "--cycles")) {
+            cycles = std::strtoull(argv[++i], nullptr, 0);
+            cycles_set = true;
+        } else if (!std::strcmp(argv[i], "--itrace")) {
+            itrace = std::make_unique<pio_trace::Writer>(argv[++i], pio_trace::kMaxStateMachines);
+        } else if (!std::strcmp(argv[i], "--capture")) {
+            capture = std::make_unique<gpio_capture::Capture>();
+            capture_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--samplerate")) {
+            samplerate = std::strtoull(argv[++i], nullptr, 0);
+        } else if (!std::strcmp(argv[i], "--stimulus")) {
+            stimulus = std::make_unique<gpio_stimulus::Stimulus>(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--coverage")) {
+            coverage = std::make_unique<pio_coverage::Coverage>();
+            coverage_path = argv[++i];
+        }
+    }
+    // Run the whole recording unless told otherwise
+    if (stimulus && !cycles_set) cycles = stimulus->cycles();
+
     Vpio_chip* pio_chip = new Vpio_chip;
 
     // Initialize trace dump
-    VerilatedVcdC* tfp = new VerilatedVcdC();
-    pio_chip->trace(tfp, 99); // Trace depth
-    tfp->open("wave.vcd");
+    VerilatedVcdC* tfp = nullptr;
+    if (vcd) {
+        tfp = new VerilatedVcdC();
+        pio_chip->trace(tfp, 99); // Trace depth
+        tfp->open("wave.vcd");
+    }
 
-    // Clock generation
-    vluint64_t time = 0;
+    sim_loop::Options options;
+    options.cycles = cycles;
+    options.skip = skip;
+    options.stimulus = stimulus.get();
+    options.vcd = tfp;
+    options.itrace = itrace.get();
+    options.capture = capture.get();
+    options.coverage = coverage.get();
     pio_chip->clk = false;
+    sim_loop::run(*pio_chip, options);
 
-    while (time < 100) {                 // Simulate 100 cycles
-        pio_chip->clk = !pio_chip->clk;       // Toggle clock signal
-        pio_chip->eval();                     // Evaluate the design
-        tfp->dump(time);                 // Dump signal states
-        time += 5;                       // Increment simulation time
+    if (tfp) tfp->close();
+    if (coverage) coverage->save(coverage_path);
+    if (capture) {
+        if (capture_path.ends_with(".sr")) {
+            capture->export_sigrok(capture_path, samplerate);
+        } else {
+            capture->save(capture_path);
+        }
     }
-
-    tfp->close();
     delete pio_chip;
     delete tfp;
 
@@ -0,0 +1,259 @@
+#include "test_utils.h"
+
+class ControlRegfileTests : public VerilatorTestFixture {
+protected:
+    // Bit positions of each event group in perf_reg_in_t
+    static constexpr int kRetired = 16;
+    static constexpr int kTxStall = 12;
+    static constexpr int kRxStall = 8;
+    static constexpr int kWaitStall = 4;
+    static constexpr int kJumpTaken = 0;
+
+    static constexpr uint16_t kFstat = 0x004;
+    static constexpr uint16_t kFdebug = 0x008;
+    static constexpr uint16_t kFlevel = 0x00C;
+    static constexpr uint16_t kIrq = 0x030;
+    static constexpr uint16_t kIrqForce = 0x034;
+    static constexpr uint16_t kPerfCtrl = 0x144;
+    static constexpr uint16_t kInstrBank = 0x198;
+    static constexpr uint16_t kShiftctrl0 = 0x0D0; // SMx_SHIFTCTRL is 0x18 apart
+    static constexpr uint32_t kFjoinRxGet = 1u << 14;
+    static constexpr uint32_t kFjoinRxPut = 1u << 15;
+
+    void SetUp() override {
+        VerilatorTestFixture::SetUp();
+
+        uut->cr_data_in = 0;
+        uut->cr_write_addr = 0;
+        uut->cr_read_addr = 0;
+        uut->cr_write_en = 0;
+        uut->cr_fstat_in = 0;
+        uut->cr_fdebug_in = 0;
+        uut->cr_flevel_in = 0;
+        uut->cr_perf_in = 0;
+        uut->cr_irq_in = 0;
+        uut->cr_instr_bank_active = 0;
+        uut->cr_instr_bank_swap = 0;
+        for (int sm = 0; sm < 4; sm++) {
+            for (int i = 0; i < 4; i++) uut->cr_rx_entries[sm][i] = 0;
+        }
+        uut->eval();
+    }
+
+    void WriteReg(uint16_t addr, uint32_t data) {
+        uut->cr_write_addr = addr;
+        uut->cr_data_in = data;
+        uut->cr_write_en = 1;
+        AdvanceOneCycle();
+        uut->cr_write_en = 0;
+    }
+
+    uint32_t ReadReg(uint16_t addr) {
+        uut->cr_read_addr = addr;
+        uut->eval();
+        return uut->cr_data_out;
+    }
+
+    // RXFx_PUTGETy, entry y of SM x's RX FIFO
+    static uint16_t RxfPutget(int sm, int index) {
+        return 0x19C + sm * 0x10 + index * 4;
+    }
+
+    // SMx_PERF_* registers, counter 0-4 in the order documented in control_regfile.sv
+    static uint16_t PerfAddr(int sm, int counter) {
+        return 0x148 + sm * 0x14 + counter * 4;
+    }
+};
+
+TEST_F(ControlRegfileTests, PerfCountersReadZeroAfterReset) {
+    for (int sm = 0; sm < 4; sm++) {
+        for (int counter = 0; counter < 5; counter++) {
+            EXPECT_EQ(ReadReg(PerfAddr(sm, counter)), 0);
+        }
+    }
+}
+
+TEST_F(ControlRegfileTests, SnapshotLatchesAllCounters) {
+    // SM0 retires every cycle, SM1 stalls on TX, SM2 stalls on RX,
+    // SM3 waits and takes jumps
+    uut->cr_perf_in = (0b0001 << kRetired) | (0b0010 << kTxStall) | (0b0100 << kRxStall)
+        | (0b1000 << kWaitStall) | (0b1000 << kJumpTaken);
+    for (int i = 0; i < 10; i++) {
+        AdvanceOneCycle();
+    }
+    uut->cr_perf_in = 0;
+
+    // Nothing is visible until a snapshot is taken
+    EXPECT_EQ(ReadReg(PerfAddr(0, 0)), 0);
+
+    WriteReg(kPerfCtrl, 0x1);
+
+    EXPECT_EQ(ReadReg(PerfAddr(0, 0)), 10);
+    EXPECT_EQ(ReadReg(PerfAddr(1, 1)), 10);
+    EXPECT_EQ(ReadReg(PerfAddr(2, 2)), 10);
+    EXPECT_EQ(ReadReg(PerfAddr(3, 3)), 10);
+    EXPECT_EQ(ReadReg(PerfAddr(3, 4)), 10);
+
+    // Counters that saw no events stay at zero
+    EXPECT_EQ(ReadReg(PerfAddr(0, 1)), 0);
+    EXPECT_EQ(ReadReg(PerfAddr(1, 0)), 0);
+    EXPECT_EQ(ReadReg(PerfAddr(2, 4)), 0);
+}
+
+TEST_F(ControlRegfileTests, SnapshotHoldsWhileCountersRun) {
+    uut->cr_perf_in = 0b0001 << kRetired;
+    for (int i = 0; i < 5; i++) {
+        AdvanceOneCycle();
+    }
+
+    // Counters keep running during and after the snapshot write
+    WriteReg(kPerfCtrl, 0x1);
+    for (int i = 0; i < 5; i++) {
+        AdvanceOneCycle();
+        EXPECT_EQ(ReadReg(PerfAddr(0, 0)), 5);
+    }
+
+    // 5 before, 1 during the snapshot write, 5 after
+    WriteReg(kPerfCtrl, 0x1);
+    EXPECT_EQ(ReadReg(PerfAddr(0, 0)), 11);
+}
+
+TEST_F(ControlRegfileTests, ClearOnlyAffectsSelectedStateMachine) {
+    uut->cr_perf_in = (0b0101 << kRetired);
+    for (int i = 0; i < 8; i++) {
+        AdvanceOneCycle();
+    }
+    uut->cr_perf_in = 0;
+
+    // Clear SM0, then snapshot
+    WriteReg(kPerfCtrl, 0x1 << 8);
+    WriteReg(kPerfCtrl, 0x1);
+
+    EXPECT_EQ(ReadReg(PerfAddr(0, 0)), 0);
+    EXPECT_EQ(ReadReg(PerfAddr(2, 0)), 8);
+}
+
+TEST_F(ControlRegfileTests, FstatFollowsFifoStatus) {
+    // fstat_reg_in_t: tx_empty, tx_full, rx_empty, rx_full, 4 bits each
+    uut->cr_fstat_in = (0b1111 << 12) | (0b0000 << 8) | (0b1110 << 4) | 0b0001;
+    EXPECT_EQ(ReadReg(kFstat), 0x0F000E01);
+
+    // Live value, no clock needed
+    uut->cr_fstat_in = (0b0101 << 12) | (0b1010 << 8);
+    EXPECT_EQ(ReadReg(kFstat), 0x050A0000);
+}
+
+TEST_F(ControlRegfileTests, FlevelReportsEveryFifoInOneRead) {
+    // flevel_reg_in_t: rx[3:0] then tx[3:0], 4 bits each
+    uint32_t rx = (4 << 12) | (3 << 8) | (2 << 4) | 1;
+    uint32_t tx = (0 << 12) | (1 << 8) | (2 << 4) | 3;
+    uut->cr_flevel_in = (rx << 16) | tx;
+
+    // RX3 TX3 RX2 TX2 RX1 TX1 RX0 TX0
+    EXPECT_EQ(ReadReg(kFlevel), 0x40312213);
+}
+
+TEST_F(ControlRegfileTests, FdebugIsStickyAndWriteOneToClear) {
+    // fdebug_reg_in_t: tx_stall, tx_over, rx_under, rx_stall, 4 bits each
+    uut->cr_fdebug_in = (0b0001 << 12) | (0b0010 << 8) | (0b0100 << 4) | 0b1000;
+    AdvanceOneCycle();
+    uut->cr_fdebug_in = 0;
+    AdvanceOneCycle();
+
+    // Events stay set after they go away
+    EXPECT_EQ(ReadReg(kFdebug), 0x01020408);
+
+    // Clearing one bit leaves the others alone
+    WriteReg(kFdebug, 0x00020000);
+    EXPECT_EQ(ReadReg(kFdebug), 0x01000408);
+
+    WriteReg(kFdebug, 0xFFFFFFFF);
+    EXPECT_EQ(ReadReg(kFdebug), 0x00000000);
+}
+
+TEST_F(ControlRegfileTests, IrqFlagsSetByStateMachinesAndForcedOrClearedByHost) {
+    // irq_reg_in_t: irq_set [15:8], irq_clr [7:0]
+    uut->cr_irq_in = 0b00100001 << 8;
+    AdvanceOneCycle();
+    uut->cr_irq_in = 0;
+    EXPECT_EQ(ReadReg(kIrq), 0b00100001u);
+    EXPECT_EQ(uut->cr_irq_flags, 0b00100001u);
+
+    WriteReg(kIrqForce, 0b10000000);
+    EXPECT_EQ(ReadReg(kIrq), 0b10100001u);
+
+    // Writing a 1 clears, and FDEBUG writes no longer touch the flags
+    WriteReg(kIrq, 0b00000001);
+    WriteReg(kFdebug, 0xFFFFFFFF);
+    EXPECT_EQ(ReadReg(kIrq), 0b10100000u);
+
+    // A clear wins over a set on the same cycle
+    uut->cr_irq_in = (0b00000110 << 8) | 0b00100100;
+    AdvanceOneCycle();
+    uut->cr_irq_in = 0;
+    EXPECT_EQ(ReadReg(kIrq), 0b10000010u);
+}
+
+TEST_F(ControlRegfileTests, InstrBankSwapStaysPendingUntilTaken) {
+    // SHADOW_WRITE, swap when SM 2 wraps, SWAP_IRQ 5, and SWAP
+    const uint32_t config = 1u << 4 | 1u << 8 | 2u << 12 | 5u << 16;
+    WriteReg(kInstrBank, 1u << 31 | config);
+    EXPECT_EQ(ReadReg(kInstrBank), config | 1u << 1);
+    // instr_bank_out_t: shadow_write [8], swap_pending [7], swap_sel [6:5], swap_sm [4:3], swap_irq [2:0]
+    EXPECT_EQ(uut->cr_instr_bank_out, 1u << 8 | 1u << 7 | 1u << 5 | 2u << 3 | 5u);
+
+    for (int i = 0; i < 4; i++) AdvanceOneCycle();
+    EXPECT_EQ(ReadReg(kInstrBank), config | 1u << 1);
+
+    uut->cr_instr_bank_swap = 1;
+    AdvanceOneCycle();
+    uut->cr_instr_bank_swap = 0;
+    uut->cr_instr_bank_active = 1;
+    EXPECT_EQ(ReadReg(kInstrBank), config | 1u << 0);
+
+    // A write without SWAP cancels a pending swap
+    WriteReg(kInstrBank, 1u << 31);
+    EXPECT_EQ(ReadReg(kInstrBank), 1u << 1 | 1u << 0);
+    WriteReg(kInstrBank, 0);
+    EXPECT_EQ(ReadReg(kInstrBank), 1u << 0);
+}
+
+TEST_F(ControlRegfileTests, RxfPutgetNeedsExactlyOneJoinMode) {
+    uut->cr_rx_entries[1][2] = 0x12345678;
+    EXPECT_EQ(ReadReg(RxfPutget(1, 2)), 0);
+
+    // FJOIN_RX_PUT: the host reads what SM 1 puts
+    WriteReg(kShiftctrl0 + 0x18, 0x000C0000 | kFjoinRxPut);
+    EXPECT_EQ(ReadReg(kShiftctrl0 + 0x18), 0x000C0000 | kFjoinRxPut);
+    EXPECT_EQ(ReadReg(RxfPutget(1, 2)), 0x12345678);
+    EXPECT_EQ(ReadReg(RxfPutget(0, 2)), 0);
+
+    // Writes go to the FIFO, which owns the storage
+    uut->cr_write_addr = RxfPutget(1, 3);
+    uut->cr_data_in = 0xCAFEF00D;
+    uut->cr_write_en = 1;
+    uut->eval();
+    EXPECT_EQ(uut->cr_rxf_put_en, 0b0010);
+    EXPECT_EQ(uut->cr_rxf_put_index, 3);
+
+    // Both modes: the entries are the SM's own
+    WriteReg(kShiftctrl0 + 0x18, 0x000C0000 | kFjoinRxPut | kFjoinRxGet);
+    EXPECT_EQ(ReadReg(RxfPutget(1, 2)), 0);
+    uut->cr_write_addr = RxfPutget(1, 3);
+    uut->cr_write_en = 1;
+    uut->eval();
+    EXPECT_EQ(uut->cr_rxf_put_en, 0);
+
+    // FJOIN_RX_GET: the host writes what SM 0 gets
+    uut->cr_write_en = 0;
+    WriteReg(kShiftctrl0, 0x000C0000 | kFjoinRxGet);
+    uut->cr_write_addr = RxfPutget(0, 1);
+    uut->cr_write_en = 1;
+    uut->eval();
+    EXPECT_EQ(uut->cr_rxf_put_en, 0b0001);
+    EXPECT_EQ(uut->cr_rxf_put_index, 1);
+    AdvanceOneCycle();
+    uut->cr_write_en = 0;
+    uut->eval();
+    EXPECT_EQ(uut->cr_rxf_put_en, 0);
+}
@@ -1,3 +1,4 @@
+#include <random>
 #include "test_utils.h"
 
 class OutputArbitrator : public VerilatorTestFixture {
@@ -5,15 +6,22 @@ protected:
     void SetUp() override {
         VerilatorTestFixture::SetUp();
 
-        for (int i = 0; i < 32; i++) {
-            uut->core_select[i] = 0b00;
-        }
-
         for (int i = 0; i < 4; i++) {
+            uut->core_select[i] = 0x00000000;
             uut->core_output[i] = 0x00000000;
             uut->core_drive[i] = 0x00000000;
         }
     }
+
+    // Converts a per-pin core index into the one-hot masks the arbitrator takes
+    void SelectCores(const int select[32]) {
+        for (int c = 0; c < 4; c++) {
+            uut->core_select[c] = 0x00000000;
+        }
+        for (int i = 0; i < 32; i++) {
+            uut->core_select[select[i]] |= 1u << i;
+        }
+    }
 };
 
 TEST_F(OutputArbitrator, CoreSelectMuxWorksProperly) {
@@ -23,9 +31,11 @@ TEST_F(OutputArbitrator, CoreSelectMuxWorksProperly) {
     uut->core_output[1] = 0xAAAAAAAA;
     uut->core_drive[1] = 0x99999999;
 
+    int select[32];
     for (int i = 0; i < 32; i++) {
-        uut->core_select[i] = 1;
+        select[i] = 1;
     }
+    SelectCores(select);
 
     uut->eval();
 
@@ -46,14 +56,46 @@ TEST_F(OutputArbitrator, CoreSelectMuxMultipleSources) {
     uut->core_output[3] = 0x0D15EA5E;
     uut->core_drive[3] = 0x88888888;
 
+    int select[32];
     for (int i = 31; i >= 0; i--) {
         // Switch core select every 4 bits
-        int select = (i / 4) % 4;
-        uut->core_select[i] = select;
+        select[i] = (i / 4) % 4;
     }
+    SelectCores(select);
 
     uut->eval();
 
     EXPECT_EQ(uut->gpio_output, 0x0050E0E0);
     EXPECT_EQ(uut->gpio_drive, 0x8F1F8F1F);
 }
+
+TEST_F(OutputArbitrator, MatchesPerBitMuxOnRandomInputs) {
+    // Reference is the original per-bit formulation:
+    // gpio_output[i] = core_output[core_select[i]][i]
+    std::mt19937 rng(0xC0FFEE);
+
+    for (int n = 0; n < 1000; n++) {
+        int select[32];
+        for (int i = 0; i < 32; i++) {
+            select[i] = rng() % 4;
+        }
+        SelectCores(select);
+
+        for (int c = 0; c < 4; c++) {
+            uut->core_output[c] = rng();
+            uut->core_drive[c] = rng();
+        }
+
+        uut->eval();
+
+        uint32_t expected_output = 0;
+        uint32_t expected_drive = 0;
+        for (int i = 0; i < 32; i++) {
+            expected_output |= ((uut->core_output[select[i]] >> i) & 1u) << i;
+            expected_drive |= ((uut->core_drive[select[i]] >> i) & 1u) << i;
+        }
+
+        ASSERT_EQ(uut->gpio_output, expected_output);
+        ASSERT_EQ(uut->gpio_drive, expected_drive);
+    }
+}
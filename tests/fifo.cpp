@@ -8,6 +8,7 @@ protected:
         uut->fifo_in = 0x00000000;
         uut->push_en = 0;
         uut->pop_en = 0;
+        uut->fifo_put_en = 0;
     }
 };
 
@@ -357,3 +358,155 @@ TEST_F(Fifo, PopKeepsFifoFromBeingFull) {
     EXPECT_EQ(uut->full, 0);
     EXPECT_EQ(uut->fifo_count, 3);
 }
+
+TEST_F(Fifo, PushIntoFullFifoWhilePopping) {
+    uut->push_en = 1;
+    for (int i = 0; i < 4; i++) {
+        uut->fifo_in = i + 1;
+        AdvanceOneCycle();
+    }
+    EXPECT_EQ(uut->full, 1);
+
+    // The pop frees the entry the push goes into
+    uut->pop_en = 1;
+    uut->fifo_in = 5;
+    AdvanceOneCycle();
+    uut->push_en = 0;
+    EXPECT_EQ(uut->fifo_out, 1);
+    EXPECT_EQ(uut->fifo_count, 4);
+    EXPECT_EQ(uut->fifo_memory[0], 5);
+
+    for (int i = 2; i <= 5; i++) {
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->fifo_out, i);
+    }
+    EXPECT_EQ(uut->empty, 1);
+}
+
+TEST_F(Fifo, PutOverwritesAnEntryInPlace) {
+    uut->push_en = 1;
+    uut->fifo_in = 0x11111111;
+    AdvanceOneCycle();
+    uut->fifo_in = 0x22222222;
+    AdvanceOneCycle();
+    uut->push_en = 0;
+
+    // Random access goes by physical entry, not queue position
+    uut->fifo_put_en = 1;
+    uut->fifo_put_index = 3;
+    uut->fifo_put_data = 0xAAAAAAAA;
+    AdvanceOneCycle();
+    uut->fifo_put_index = 0;
+    uut->fifo_put_data = 0xBBBBBBBB;
+    AdvanceOneCycle();
+    uut->fifo_put_en = 0;
+
+    EXPECT_EQ(uut->fifo_memory[0], 0xBBBBBBBB);
+    EXPECT_EQ(uut->fifo_memory[1], 0x22222222);
+    EXPECT_EQ(uut->fifo_memory[3], 0xAAAAAAAA);
+
+    // The pointers and count don't move
+    EXPECT_EQ(uut->fifo_count, 2);
+    EXPECT_EQ(uut->fifo_head, 2);
+    EXPECT_EQ(uut->fifo_tail, 0);
+}
+
+TEST_F(Fifo, PutWinsOverPushToTheSameEntry) {
+    uut->push_en = 1;
+    uut->fifo_in = 0x33333333;
+    uut->fifo_put_en = 1;
+    uut->fifo_put_index = 0;
+    uut->fifo_put_data = 0xCCCCCCCC;
+    AdvanceOneCycle();
+
+    EXPECT_EQ(uut->fifo_memory[0], 0xCCCCCCCC);
+    EXPECT_EQ(uut->fifo_count, 1);
+    EXPECT_EQ(uut->fifo_head, 1);
+}
+
+// The FWFT FIFO shares its inputs with the registered FIFO above
+class FwftFifo : public Fifo {};
+
+TEST_F(FwftFifo, HeadWordVisibleWithoutPop) {
+    EXPECT_EQ(uut->fwft_data_valid, 0);
+
+    uut->push_en = 1;
+    uut->fifo_in = 0xCAFEF00D;
+    AdvanceOneCycle();
+    uut->push_en = 0;
+    uut->eval();
+
+    // No pop has happened, but the head word is already on the output
+    EXPECT_EQ(uut->fwft_fifo_out, 0xCAFEF00D);
+    EXPECT_EQ(uut->fwft_data_valid, 1);
+    EXPECT_EQ(uut->fwft_fifo_count, 1);
+
+    // Holds until popped
+    for (int i = 0; i < 4; i++) {
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->fwft_fifo_out, 0xCAFEF00D);
+        EXPECT_EQ(uut->fwft_fifo_count, 1);
+    }
+}
+
+TEST_F(FwftFifo, PopAdvancesToNextWord) {
+    uut->push_en = 1;
+    for (int i = 0; i < 4; i++) {
+        uut->fifo_in = 0xDEADBEE0 + i;
+        AdvanceOneCycle();
+    }
+    uut->push_en = 0;
+    uut->eval();
+    EXPECT_EQ(uut->fwft_fifo_count, 4);
+
+    // Each word is visible on the cycle it is popped
+    uut->pop_en = 1;
+    for (int i = 0; i < 4; i++) {
+        uut->eval();
+        EXPECT_EQ(uut->fwft_data_valid, 1);
+        EXPECT_EQ(uut->fwft_fifo_out, 0xDEADBEE0 + i);
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->fwft_fifo_count, 4 - i - 1);
+    }
+
+    EXPECT_EQ(uut->fwft_data_valid, 0);
+}
+
+TEST_F(FwftFifo, PushToEmptyBypassesOnPop) {
+    uut->push_en = 1;
+    uut->pop_en = 1;
+
+    for (int i = 0; i < 8; i++) {
+        uut->fifo_in = 0x1000 + i;
+        uut->eval();
+
+        // Word being pushed is popped on the same cycle
+        EXPECT_EQ(uut->fwft_data_valid, 1);
+        EXPECT_EQ(uut->fwft_fifo_out, 0x1000 + i);
+
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->fwft_fifo_count, 0);
+    }
+
+    uut->push_en = 0;
+    uut->eval();
+    EXPECT_EQ(uut->fwft_data_valid, 0);
+}
+
+TEST_F(FwftFifo, PutToTheHeadShowsOnTheOutput) {
+    uut->push_en = 1;
+    uut->fifo_in = 0x12345678;
+    AdvanceOneCycle();
+    uut->push_en = 0;
+
+    uut->fifo_put_en = 1;
+    uut->fifo_put_index = 0;
+    uut->fifo_put_data = 0x87654321;
+    AdvanceOneCycle();
+    uut->fifo_put_en = 0;
+    uut->eval();
+
+    EXPECT_EQ(uut->fwft_data_valid, 1);
+    EXPECT_EQ(uut->fwft_fifo_out, 0x87654321);
+    EXPECT_EQ(uut->fwft_fifo_count, 1);
+}
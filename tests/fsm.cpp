@@ -6,11 +6,37 @@ protected:
         VerilatorTestFixture::SetUp();
 
         uut->instruction = pio_encode_nop();
+        uut->fsm_enable = 1;
         uut->out_shiftdir = 1; // Right shift
         uut->autopull = 0;
         uut->pull_thresh = 0; // Encoding for 32 bits
+        uut->fsm_execctrl = kExecctrlReset;
+        uut->fsm_rx_put = 0;
+        uut->fsm_rx_get = 0;
+        uut->external_put_en = 0;
         uut->eval();
     }
+
+    // Host write to TXF
+    void PushTx(uint32_t data) {
+        uut->external_push_en = 1;
+        uut->external_data_in = data;
+        AdvanceOneCycle();
+        uut->external_push_en = 0;
+    }
+
+    // EXECCTRL after reset: wrap from 31 back to 0, STATUS_N 0
+    static constexpr uint32_t kExecctrlReset = 0x0001F000;
+
+    // IRQ index modes, or'd into an IRQ or WAIT IRQ encoding
+    static constexpr uint16_t kIrqPrev = 1u << 3;
+    static constexpr uint16_t kIrqNext = 3u << 3;
+
+    // RP2350 RX FIFO random access, mov rxfifo[y], isr and mov osr, rxfifo[y].
+    // Or in kRxfifoIndex | n for a fixed entry instead of Y.
+    static constexpr uint16_t kMovToRxfifo = 0x8010;
+    static constexpr uint16_t kMovFromRxfifo = 0x8090;
+    static constexpr uint16_t kRxfifoIndex = 0x0008;
 };
 
 TEST_F(FsmTests, TestJumpUnconditionalInstruction) {
@@ -133,6 +159,53 @@ TEST_F(FsmTests, TestJumpXNotEqualY) {
     EXPECT_EQ(uut->fsm_pc, 0b00000); // Verify jump was taken
 }
 
+TEST_F(FsmTests, TestJumpPin) {
+    uut->fsm_execctrl = kExecctrlReset | 9u << 24; // JMP_PIN = 9
+    uut->fsm_gpio_input = ~(1u << 9);
+
+    uut->instruction = pio_encode_jmp_pin(0b10101);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+
+    // Every pin but the selected one is high
+    EXPECT_NE(uut->fsm_pc, 0b10101);
+
+    uut->fsm_gpio_input = 1u << 9;
+    uut->instruction = pio_encode_jmp_pin(0b10101);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+
+    EXPECT_EQ(uut->fsm_pc, 0b10101);
+}
+
+TEST_F(FsmTests, TestWrap) {
+    // WRAP_BOTTOM (the target) = 4, WRAP_TOP = 6
+    uut->fsm_execctrl = 6u << 12 | 4u << 7;
+    Reset();
+    EXPECT_EQ(uut->fsm_pc, 4);
+
+    // The first cycle after reset only enables the pc
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 4);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 5);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 6);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 4);
+
+    // Jumps still go anywhere
+    uut->instruction = pio_encode_jmp(20);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 20);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 21);
+}
+
 TEST_F(FsmTests, TestJumpOSRNotEmpty) {
     // Expect OSR to not be empty
     EXPECT_EQ(uut->osr_empty, 0);
@@ -214,7 +287,22 @@ TEST_F(FsmTests, TestOutY) {
 }
 
 TEST_F(FsmTests, TestOutAutopullOneCycle) {
+    uut->autopull = 1;
 
+    // The OSR starts out full, of zeros
+    PushTx(0x11111111);
+    PushTx(0x22222222);
+
+    // The OUT that empties the OSR also refills it
+    uut->instruction = pio_encode_out(pio_x, 32);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->x, 0);
+    EXPECT_EQ(uut->osr_data, 0x11111111);
+    EXPECT_EQ(uut->out_shift_counter, 0);
+
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->x, 0x11111111);
+    EXPECT_EQ(uut->osr_data, 0x22222222);
 }
 
 TEST_F(FsmTests, TestOutAutopullMultiCycle) {
@@ -222,22 +310,340 @@ TEST_F(FsmTests, TestOutAutopullMultiCycle) {
     // but only if the fifo is not empty.
     // We are testing autpull where the fifo is empty on the first cycle,
     // but filled on a later cycle.
+    uut->autopull = 1;
+    uut->pull_thresh = 16;
+
+    // Empty the OSR with nothing to refill it from
+    uut->instruction = pio_encode_out(pio_null, 32);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->osr_empty, 1);
+
+    uut->instruction = pio_encode_out(pio_x, 8);
+    for (int i = 0; i < 3; i++) {
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->x, 0);
+    }
+
+    // The word pushed into the empty FIFO refills the OSR and its first byte
+    // goes out on the same edge
+    PushTx(0x1234ABCD);
+    EXPECT_EQ(uut->x, 0xCD);
+    EXPECT_EQ(uut->out_shift_counter, 8);
+
+    // Threshold reached with nothing to refill from
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->x, 0xAB);
+    EXPECT_EQ(uut->osr_empty, 1);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->x, 0xAB);
+
+    // This time the next word is there when the threshold is reached
+    PushTx(0x5678EF01);
+    EXPECT_EQ(uut->x, 0x01);
+    PushTx(0x9ABC2345);
+    EXPECT_EQ(uut->x, 0xEF);
+    EXPECT_EQ(uut->osr_data, 0x9ABC2345);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->x, 0x45);
 }
 
 TEST_F(FsmTests, TestOutAutopullStallOnEmpty) {
+    constexpr uint8_t tx_stall = 1 << 3;
+    uut->autopull = 1;
+
+    uut->instruction = pio_encode_out(pio_null, 32);
+    AdvanceOneCycle();
+
+    // Nothing to refill from, so the OUT stalls and X is left alone
+    uut->instruction = pio_encode_out(pio_x, 32);
+    for (int i = 0; i < 4; i++) {
+        uut->eval();
+        EXPECT_EQ(uut->fsm_events & tx_stall, tx_stall);
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->x, 0);
+    }
 
+    // A push ends the stall on the same edge
+    uut->external_push_en = 1;
+    uut->external_data_in = 0xFEEDFACE;
+    uut->eval();
+    EXPECT_EQ(uut->fsm_events & tx_stall, 0);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->x, 0xFEEDFACE);
+    EXPECT_EQ(uut->fsm_tx_count, 0);
+}
+
+TEST_F(FsmTests, TestOutAutopullStreamsOneWordPerCycle) {
+    constexpr uint8_t tx_stall = 1 << 3;
+    uut->autopull = 1;
+
+    uut->instruction = pio_encode_out(pio_null, 32);
+    AdvanceOneCycle();
+
+    // Three words queued while disabled, then the host pushes one a cycle
+    uut->fsm_enable = 0;
+    for (uint32_t i = 1; i <= 3; i++) PushTx(i);
+    uut->fsm_enable = 1;
+
+    // 16 words in 16 cycles, not one lost to refilling the OSR
+    uut->instruction = pio_encode_out(pio_x, 32);
+    for (uint32_t cycle = 1; cycle <= 16; cycle++) {
+        uut->external_push_en = cycle <= 13;
+        uut->external_data_in = cycle + 3;
+        uut->eval();
+        EXPECT_EQ(uut->fsm_events & tx_stall, 0) << "cycle " << cycle;
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->x, cycle) << "cycle " << cycle;
+    }
+    uut->external_push_en = 0;
+    EXPECT_EQ(uut->fsm_tx_count, 0);
+
+    // After running dry, the first word back goes out on the clock it's pushed
+    for (int i = 0; i < 3; i++) {
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->x, 16);
+    }
+    PushTx(17);
+    EXPECT_EQ(uut->x, 17);
 }
 
 TEST_F(FsmTests, TestPullNormal) {
+    // Host pushes a word into the TX FIFO
+    uut->external_push_en = 1;
+    uut->external_data_in = 0xDEADBEEF;
+    AdvanceOneCycle();
+    uut->external_push_en = 0;
+
+    // The head word is already visible, so PULL loads it on this edge
+    uut->instruction = pio_encode_pull(false, true);
+    AdvanceOneCycle();
 
+    EXPECT_EQ(uut->osr_data, 0xDEADBEEF);
+    EXPECT_EQ(uut->out_shift_counter, 0);
+}
+
+TEST_F(FsmTests, TestPullSameCycleAsHostPush) {
+    // Word pushed into an empty TX FIFO falls straight through to the OSR
+    uut->external_push_en = 1;
+    uut->external_data_in = 0x0BADCAFE;
+    uut->instruction = pio_encode_pull(false, true);
+    AdvanceOneCycle();
+    uut->external_push_en = 0;
+
+    EXPECT_EQ(uut->osr_data, 0x0BADCAFE);
+
+    // The word was consumed, so a second PULL noblock copies X instead
+    uut->instruction = pio_encode_pull(false, false);
+    AdvanceOneCycle();
+
+    EXPECT_EQ(uut->osr_data, 0);
 }
 
 TEST_F(FsmTests, TestPullBlockStall) {
+    uut->instruction = pio_encode_mov(pio_osr, pio_null);
+    AdvanceOneCycle();
+
+    // Blocking PULL on an empty FIFO leaves the OSR alone
+    uut->instruction = pio_encode_pull(false, true);
+    for (int i = 0; i < 4; i++) {
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->osr_data, 0);
+    }
+
+    // Once the host pushes, the stalled PULL completes on the same edge
+    uut->external_push_en = 1;
+    uut->external_data_in = 0x13579BDF;
+    AdvanceOneCycle();
+    uut->external_push_en = 0;
+
+    EXPECT_EQ(uut->osr_data, 0x13579BDF);
+}
+
+TEST_F(FsmTests, TestEventsTrackStallsAndJumps) {
+    // fsm_events bits: retired, tx_stall, rx_stall, wait_stall, jump_taken
+    constexpr uint8_t retired = 1 << 4;
+    constexpr uint8_t tx_stall = 1 << 3;
+    constexpr uint8_t jump_taken = 1 << 0;
+
+    // Blocking PULL on an empty FIFO stalls on TX every cycle
+    uut->instruction = pio_encode_pull(false, true);
+    for (int i = 0; i < 3; i++) {
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->fsm_events, tx_stall);
+    }
+
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_events, retired);
+
+    uut->instruction = pio_encode_jmp(0b00100);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_events, retired | jump_taken);
+}
+
+TEST_F(FsmTests, TestEventsFlagHostOverflowAndUnderflow) {
+    constexpr uint8_t tx_over = 1 << 6;
+    constexpr uint8_t rx_under = 1 << 5;
+
+    // Reading an empty RX FIFO is an underflow
+    uut->external_pop_en = 1;
+    uut->eval();
+    EXPECT_EQ(uut->fsm_events & rx_under, rx_under);
+    uut->external_pop_en = 0;
+
+    // Fill the TX FIFO, the fifth write overflows
+    uut->external_push_en = 1;
+    for (int i = 0; i < 4; i++) {
+        uut->external_data_in = i;
+        uut->eval();
+        EXPECT_EQ(uut->fsm_events & tx_over, 0);
+        AdvanceOneCycle();
+    }
+    uut->eval();
+    EXPECT_EQ(uut->fsm_events & tx_over, tx_over);
+}
+
+TEST_F(FsmTests, TestEventsFlagWrap) {
+    constexpr uint8_t wrapped = 1 << 7;
+
+    // Wrap from 1 back to 0
+    uut->fsm_execctrl = 1u << 12;
+    Reset();
+
+    int wraps = 0;
+    for (int i = 0; i < 12; i++) {
+        const bool wrap = uut->fsm_events & wrapped;
+        if (wrap) EXPECT_EQ(uut->fsm_pc, 1);
+        AdvanceOneCycle();
+        if (wrap) {
+            EXPECT_EQ(uut->fsm_pc, 0);
+            wraps++;
+        }
+    }
+    EXPECT_GE(wraps, 5);
+
+    // A jump from the wrap point isn't a wrap
+    uut->instruction = pio_encode_jmp(1);
+    for (int i = 0; i < 6; i++) {
+        AdvanceOneCycle();
+        EXPECT_EQ(uut->fsm_events & wrapped, 0) << "cycle " << i;
+    }
+}
+
+TEST_F(FsmTests, TestTracePort) {
+    // fsm_trace words: {flags, instruction, pc}, x, y, osr
+    uut->instruction = pio_encode_set(pio_x, 21);
+    uut->eval();
+    EXPECT_EQ(uut->fsm_trace[0] >> 8 & 0xFFFF, pio_encode_set(pio_x, 21));
+
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_trace[1], 21);
+
+    // Blocking PULL on an empty FIFO, flags bit 0 is tx_stall
+    uut->instruction = pio_encode_pull(false, true);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_trace[0] >> 24, 1);
+}
+
+TEST_F(FsmTests, TestQuiescent) {
+    AdvanceOneCycle();
+    EXPECT_FALSE(uut->fsm_quiescent);
+
+    // Blocking PULL on an empty FIFO. The first stalled cycle could still have
+    // moved the pc, so it takes a second one to settle.
+    uut->instruction = pio_encode_pull(false, true);
+    AdvanceOneCycle();
+    EXPECT_FALSE(uut->fsm_quiescent);
+    AdvanceOneCycle();
+    EXPECT_TRUE(uut->fsm_quiescent);
+    AdvanceOneCycle();
+    EXPECT_TRUE(uut->fsm_quiescent);
+
+    // A push wakes it up straight away
+    uut->external_data_in = 0xCAFE;
+    uut->external_push_en = 1;
+    uut->eval();
+    EXPECT_FALSE(uut->fsm_quiescent);
+    AdvanceOneCycle();
+    uut->external_push_en = 0;
+    EXPECT_EQ(uut->osr_data, 0xCAFE);
+}
+
+TEST_F(FsmTests, TestDisabledHolds) {
+    uut->instruction = pio_encode_set(pio_x, 5);
+    AdvanceOneCycle();
+    AdvanceOneCycle();
+    const uint8_t pc = uut->fsm_pc;
+
+    uut->fsm_enable = 0;
+    uut->instruction = pio_encode_pull(false, false);
+    uut->external_data_in = 0xBEEF;
+    uut->external_push_en = 1;
+    AdvanceOneCycle();
+    uut->external_push_en = 0;
+    uut->instruction = pio_encode_set(pio_x, 9);
+    for (int i = 0; i < 4; i++) AdvanceOneCycle();
+
+    // The host can still fill the TX FIFO, but nothing runs
+    EXPECT_EQ(uut->x, 5);
+    EXPECT_EQ(uut->fsm_pc, pc);
+    EXPECT_EQ(uut->fsm_tx_count, 1);
+    EXPECT_EQ(uut->fsm_events, 0);
+    EXPECT_TRUE(uut->fsm_quiescent);
+
+    uut->fsm_enable = 1;
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->x, 9);
+}
+
+TEST_F(FsmTests, TestRestart) {
+    uut->instruction = pio_encode_set(pio_x, 5);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_mov(pio_y, pio_x);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_mov(pio_isr, pio_x);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_out(pio_null, 8);
+    AdvanceOneCycle();
+
+    uut->external_data_in = 0xF00D;
+    uut->external_push_en = 1;
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+    uut->external_push_en = 0;
+    ASSERT_EQ(uut->out_shift_counter, 8);
+
+    // WRAP_BOTTOM = 3, where a restart starts from
+    uut->fsm_execctrl = kExecctrlReset | 3u << 7;
+    uut->fsm_restart = 1;
+    AdvanceOneCycle();
+    uut->fsm_restart = 0;
+
+    EXPECT_EQ(uut->fsm_pc, 3);
+    EXPECT_EQ(uut->x, 0);
+    EXPECT_EQ(uut->y, 0);
+    EXPECT_EQ(uut->fsm_isr, 0);
+    EXPECT_EQ(uut->out_shift_counter, 0);
+    // The FIFOs keep their contents
+    EXPECT_EQ(uut->fsm_tx_count, 1);
+    EXPECT_EQ(uut->fsm_tx_memory[uut->fsm_tx_tail], 0xF00D);
 
+    // Same pipeline start as after reset
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 3);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 4);
 }
 
 TEST_F(FsmTests, TestPullBlockXToOSR) {
+    uut->instruction = pio_encode_set(pio_x, 23);
+    AdvanceOneCycle();
+
+    // Non-blocking PULL on an empty FIFO copies X to the OSR
+    uut->instruction = pio_encode_pull(false, false);
+    AdvanceOneCycle();
 
+    EXPECT_EQ(uut->osr_data, 23);
 }
 
 TEST_F(FsmTests, TestPullUnderThresholdDoNothing) {
@@ -378,6 +784,339 @@ TEST_F(FsmTests, TestMovOSRNull) {
 
 }
 
+TEST_F(FsmTests, TestMovStatus) {
+    // STATUS_SEL = 0, STATUS_N = 1: all-ones while the TX FIFO is empty
+    uut->fsm_execctrl = kExecctrlReset | 1;
+    uut->instruction = pio_encode_mov(pio_x, pio_status);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->x, 0xFFFFFFFF);
+
+    uut->external_data_in = 0x1234;
+    uut->external_push_en = 1;
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+    uut->external_push_en = 0;
+
+    uut->instruction = pio_encode_mov(pio_y, pio_status);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->y, 0);
+
+    // STATUS_SEL = 1 compares the RX FIFO, which is still empty
+    uut->fsm_execctrl = kExecctrlReset | 1u << 4 | 1;
+    uut->instruction = pio_encode_mov(pio_osr, pio_status);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->osr_data, 0xFFFFFFFF);
+
+    // STATUS_N = 0 is never satisfied
+    uut->fsm_execctrl = kExecctrlReset;
+    uut->instruction = pio_encode_mov(pio_x, pio_status);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->x, 0);
+}
+
+TEST_F(FsmTests, TestMovInvertAndReverse) {
+    uut->instruction = pio_encode_set(pio_x, 0b00011);
+    AdvanceOneCycle();
+
+    uut->instruction = pio_encode_mov_not(pio_y, pio_x);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->y, 0xFFFFFFFC);
+
+    uut->instruction = pio_encode_mov_reverse(pio_x, pio_y);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->x, 0x3FFFFFFF);
+
+    // Both apply on the way into the OSR as well
+    uut->instruction = pio_encode_mov_reverse(pio_osr, pio_null);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->osr_data, 0);
+    uut->instruction = pio_encode_mov_not(pio_osr, pio_osr);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->osr_data, 0xFFFFFFFF);
+}
+
+TEST_F(FsmTests, TestMovFromPins) {
+    // IN_BASE = 8, so pin 8 lands in bit 0
+    uut->fsm_pinctrl = 8u << 15;
+    uut->fsm_gpio_input = 0x12345678;
+    uut->instruction = pio_encode_mov(pio_x, pio_pins);
+    AdvanceOneCycle();
+
+    EXPECT_EQ(uut->x, 0x78123456);
+}
+
+TEST_F(FsmTests, TestMovToPins) {
+    // OUT_BASE = 30, OUT_COUNT = 4: pins 30, 31, 0 and 1
+    uut->fsm_pinctrl = 4u << 20 | 30;
+    uut->instruction = pio_encode_set(pio_x, 0b11011);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_mov(pio_pins, pio_x);
+    AdvanceOneCycle();
+
+    EXPECT_EQ(uut->fsm_pin_output, 0xC0000002);
+}
+
+TEST_F(FsmTests, TestMovToISRAndPush) {
+    uut->instruction = pio_encode_set(pio_x, 21);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_mov_not(pio_isr, pio_x);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_isr, ~21u);
+
+    // PUSH hands the ISR to the RX FIFO and clears it
+    uut->instruction = pio_encode_push(false, false);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_rx_count, 1);
+    EXPECT_EQ(uut->external_data_out, ~21u);
+    EXPECT_EQ(uut->fsm_isr, 0);
+
+    uut->instruction = pio_encode_mov(pio_y, pio_isr);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->y, 0);
+}
+
+TEST_F(FsmTests, TestBlockingPushIntoFullRxFifoWhilePopped) {
+    // Fill the RX FIFO with 1 to 4
+    for (uint32_t i = 1; i <= 4; i++) {
+        uut->instruction = pio_encode_set(pio_x, i);
+        AdvanceOneCycle();
+        uut->instruction = pio_encode_mov(pio_isr, pio_x);
+        AdvanceOneCycle();
+        uut->instruction = pio_encode_push(false, true);
+        AdvanceOneCycle();
+    }
+    ASSERT_EQ(uut->fsm_rx_count, 4);
+    uut->instruction = pio_encode_set(pio_x, 5);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_mov(pio_isr, pio_x);
+    AdvanceOneCycle();
+
+    // The host pops on the same cycle, so the PUSH doesn't stall and its word
+    // goes into the entry the pop frees
+    uut->instruction = pio_encode_push(false, true);
+    uut->external_pop_en = 1;
+    uut->eval();
+    EXPECT_EQ(uut->external_data_out, 1);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_events & 0x04, 0); // No rx_stall
+    uut->external_pop_en = 0;
+    uut->instruction = pio_encode_nop();
+    EXPECT_EQ(uut->fsm_isr, 0);
+    EXPECT_EQ(uut->fsm_rx_count, 4);
+
+    // Nothing was dropped
+    for (uint32_t i = 2; i <= 5; i++) {
+        uut->external_pop_en = 1;
+        uut->eval();
+        EXPECT_EQ(uut->external_data_out, i);
+        AdvanceOneCycle();
+    }
+    uut->external_pop_en = 0;
+    EXPECT_EQ(uut->fsm_rx_count, 0);
+}
+
+TEST_F(FsmTests, TestMovToRxfifo) {
+    uut->fsm_rx_put = 1;
+    uut->instruction = pio_encode_set(pio_y, 2);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_mov_not(pio_isr, pio_null);
+    AdvanceOneCycle();
+
+    // Entry Y, the ISR is left alone and nothing is queued
+    uut->instruction = kMovToRxfifo;
+    uut->eval();
+    EXPECT_EQ(uut->fsm_events & 0x04, 0); // No rx_stall
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_rx_memory[2], 0xFFFFFFFF);
+    EXPECT_EQ(uut->fsm_isr, 0xFFFFFFFF);
+    EXPECT_EQ(uut->fsm_rx_count, 0);
+
+    // Fixed entry
+    uut->instruction = pio_encode_mov(pio_isr, pio_y);
+    AdvanceOneCycle();
+    uut->instruction = kMovToRxfifo | kRxfifoIndex | 1;
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_rx_memory[1], 2);
+
+    // A put from the SM wins over one from the host
+    uut->external_put_en = 1;
+    uut->external_put_index = 2;
+    uut->external_data_in = 0x12345678;
+    uut->instruction = kMovToRxfifo;
+    AdvanceOneCycle();
+    uut->external_put_en = 0;
+    EXPECT_EQ(uut->fsm_rx_memory[2], 2);
+
+    // Without FJOIN_RX_PUT it's a no-op
+    uut->fsm_rx_put = 0;
+    uut->instruction = kMovToRxfifo | kRxfifoIndex | 0;
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_rx_memory[0], 0);
+}
+
+TEST_F(FsmTests, TestMovFromRxfifo) {
+    uut->fsm_rx_get = 1;
+
+    // Host writes through RXFx_PUTGETy
+    uut->external_put_en = 1;
+    uut->external_put_index = 3;
+    uut->external_data_in = 0xCAFEF00D;
+    AdvanceOneCycle();
+    uut->external_put_index = 1;
+    uut->external_data_in = 0x0000BEEF;
+    AdvanceOneCycle();
+    uut->external_put_en = 0;
+    EXPECT_EQ(uut->fsm_rx_count, 0);
+
+    // The OSR comes back full
+    uut->instruction = kMovFromRxfifo | kRxfifoIndex | 3;
+    uut->eval();
+    EXPECT_EQ(uut->fsm_events & 0x08, 0); // No tx_stall
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->osr_data, 0xCAFEF00D);
+    EXPECT_EQ(uut->out_shift_counter, 0);
+
+    uut->instruction = pio_encode_set(pio_y, 1);
+    AdvanceOneCycle();
+    uut->instruction = kMovFromRxfifo;
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->osr_data, 0x0000BEEF);
+
+    // Without FJOIN_RX_GET it's a no-op
+    uut->fsm_rx_get = 0;
+    uut->instruction = kMovFromRxfifo | kRxfifoIndex | 3;
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->osr_data, 0x0000BEEF);
+}
+
+TEST_F(FsmTests, TestMovToPC) {
+    uut->instruction = pio_encode_set(pio_x, 0b10110);
+    AdvanceOneCycle();
+
+    // Same delay as a JMP
+    uut->instruction = pio_encode_mov(pio_pc, pio_x);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+
+    EXPECT_EQ(uut->fsm_pc, 0b10110);
+}
+
+TEST_F(FsmTests, TestMovToExec) {
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+
+    uut->fsm_gpio_input = pio_encode_set(pio_y, 19);
+    uut->instruction = pio_encode_mov(pio_exec_mov, pio_pins);
+    AdvanceOneCycle();
+    const uint8_t pc = uut->fsm_pc;
+
+    // The moved instruction runs instead of the one at pc, which waits for it
+    uut->instruction = pio_encode_set(pio_y, 7);
+    uut->eval();
+    EXPECT_EQ(uut->fsm_trace[0] >> 8 & 0xFFFF, pio_encode_set(pio_y, 19));
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->y, 19);
+    EXPECT_EQ(uut->fsm_pc, pc);
+
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->y, 7);
+}
+
+TEST_F(FsmTests, TestIrqSetAndClear) {
+    // fsm_irq_set/clr: this core [7:0], previous core [15:8], next core [23:16]
+    uut->fsm_sm_index = 2;
+    uut->instruction = pio_encode_irq_set(false, 5);
+    uut->eval();
+    EXPECT_EQ(uut->fsm_irq_set, 1u << 5);
+    EXPECT_EQ(uut->fsm_irq_clr, 0u);
+
+    // REL adds the SM number to the low two bits: 7 -> 4 + (3 + 2) % 4
+    uut->instruction = pio_encode_irq_clear(true, 7);
+    uut->eval();
+    EXPECT_EQ(uut->fsm_irq_set, 0u);
+    EXPECT_EQ(uut->fsm_irq_clr, 1u << 5);
+
+    uut->instruction = pio_encode_irq_set(false, 3) | kIrqPrev;
+    uut->eval();
+    EXPECT_EQ(uut->fsm_irq_set, 1u << 11);
+
+    uut->instruction = pio_encode_irq_clear(false, 6) | kIrqNext;
+    uut->eval();
+    EXPECT_EQ(uut->fsm_irq_clr, 1u << 22);
+
+    // IRQ doesn't stall
+    AdvanceOneCycle();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 1);
+
+    uut->fsm_enable = 0;
+    uut->instruction = pio_encode_irq_set(false, 0);
+    uut->eval();
+    EXPECT_EQ(uut->fsm_irq_set, 0u);
+}
+
+TEST_F(FsmTests, TestWaitIrq) {
+    uut->instruction = pio_encode_wait_irq(true, false, 4) | kIrqNext;
+    AdvanceOneCycle();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 0);
+    EXPECT_EQ(uut->fsm_events & 0b10, 0b10); // wait_stall
+    EXPECT_EQ(uut->fsm_irq_clr, 0u);
+
+    // Once the flag is up the WAIT clears it and moves on
+    uut->fsm_irq_flags = 1u << 20;
+    uut->eval();
+    EXPECT_EQ(uut->fsm_irq_clr, 1u << 20);
+    AdvanceOneCycle();
+    uut->fsm_irq_flags = 0;
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 1);
+
+    // Polarity 0 waits for the flag to clear and leaves it alone
+    uut->fsm_irq_flags = 1u << 2;
+    uut->instruction = pio_encode_wait_irq(false, false, 2);
+    AdvanceOneCycle();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 2);
+    uut->fsm_irq_flags = 0;
+    uut->eval();
+    EXPECT_EQ(uut->fsm_irq_clr, 0u);
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 3);
+}
+
+TEST_F(FsmTests, TestIrqWait) {
+    uut->instruction = pio_encode_irq_wait(false, 1);
+    uut->eval();
+    EXPECT_EQ(uut->fsm_irq_set, 1u << 1);
+    AdvanceOneCycle();
+
+    // Sets the flag once, then waits for something else to clear it
+    uut->fsm_irq_flags = 1u << 1;
+    for (int i = 0; i < 3; i++) {
+        uut->eval();
+        EXPECT_EQ(uut->fsm_irq_set, 0u);
+        AdvanceOneCycle();
+    }
+    EXPECT_EQ(uut->fsm_pc, 0);
+
+    uut->fsm_irq_flags = 0;
+    AdvanceOneCycle();
+    uut->instruction = pio_encode_nop();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->fsm_pc, 1);
+}
+
 TEST_F(FsmTests, TestSetImmediateXY) {
     uut->instruction = 0b1110'0000'0011'0101;
     AdvanceOneCycle();
@@ -0,0 +1,252 @@
+#include <initializer_list>
+#include <vector>
+#include "test_utils.h"
+#include "fsm_diff.h"
+
+class FsmModelTests : public VerilatorTestFixture {
+protected:
+    // FsmDiff input, see tb/fsm_diff.h
+    struct Input {
+        std::vector<uint8_t> bytes;
+
+        // `exec` and `pinctrl` are the packed EXECCTRL and PINCTRL fields, by
+        // default wrap 0..31 and no output pins
+        Input(bool autopull, bool shift_right, unsigned pull_thresh, std::initializer_list<uint16_t> program,
+            uint32_t exec = 31u << 5, uint16_t pinctrl = 0) {
+            bytes.push_back(static_cast<uint8_t>(autopull | shift_right << 1 | (pull_thresh & 0x1F) << 2));
+            for (int i = 0; i < 3; i++) bytes.push_back(exec >> 8 * i & 0xFF);
+            bytes.push_back(pinctrl & 0xFF);
+            bytes.push_back(pinctrl >> 8);
+            bytes.push_back(static_cast<uint8_t>(program.size() - 1));
+            for (uint16_t instr : program) {
+                bytes.push_back(instr & 0xFF);
+                bytes.push_back(instr >> 8);
+            }
+        }
+
+        Input &idle(unsigned cycles) {
+            bytes.insert(bytes.end(), cycles, 0);
+            return *this;
+        }
+
+        Input &push(uint32_t data) {
+            bytes.push_back(1);
+            for (int i = 0; i < 4; i++) bytes.push_back(data >> 8 * i & 0xFF);
+            return *this;
+        }
+
+        // RXFx_PUTGETy write
+        Input &put(unsigned index, uint32_t data) {
+            bytes.push_back(64);
+            for (int i = 0; i < 4; i++) bytes.push_back(data >> 8 * i & 0xFF);
+            bytes.push_back(static_cast<uint8_t>(index));
+            return *this;
+        }
+
+        Input &pop() {
+            bytes.push_back(2);
+            return *this;
+        }
+
+        Input &disabled(unsigned cycles) {
+            bytes.insert(bytes.end(), cycles, 8);
+            return *this;
+        }
+
+        Input &restart() {
+            bytes.push_back(16);
+            return *this;
+        }
+
+        Input &pins(uint32_t value) {
+            bytes.push_back(4);
+            for (int i = 0; i < 4; i++) bytes.push_back(value >> 8 * i & 0xFF);
+            return *this;
+        }
+
+        // This core's flags in [7:0], the previous core's in [15:8], the next's in [23:16]
+        Input &irqs(uint32_t flags) {
+            bytes.push_back(32);
+            for (int i = 0; i < 3; i++) bytes.push_back(flags >> 8 * i & 0xFF);
+            return *this;
+        }
+    };
+
+    std::string Run(const Input &in) {
+        FsmDiff<Vtest_wrapper> diff(*uut);
+        return diff.run(in.bytes.data(), in.bytes.size());
+    }
+};
+
+TEST_F(FsmModelTests, Out32WithPullThreshZero) {
+    Input in(true, true, 0, {pio_encode_out(pio_x, 32), pio_encode_out(pio_y, 32)});
+    in.idle(4).push(0x12345678).push(0x9ABCDEF0).push(0x0F0F0F0F).idle(16);
+    EXPECT_EQ(Run(in), "");
+
+    Input left(true, false, 0, {pio_encode_out(pio_x, 32)});
+    left.push(0xDEADBEEF).push(0xCAFEF00D).idle(12);
+    EXPECT_EQ(Run(left), "");
+}
+
+TEST_F(FsmModelTests, PartialOutsRefillAtThreshold) {
+    Input in(true, true, 8, {pio_encode_out(pio_x, 3), pio_encode_out(pio_y, 5), pio_encode_out(pio_null, 8)});
+    for (uint32_t i = 0; i < 8; i++) in.push(0xA5A5A5A5 ^ i).idle(3);
+    EXPECT_EQ(Run(in), "");
+}
+
+TEST_F(FsmModelTests, PullIfEmptyAndBlockCombinations) {
+    Input in(false, true, 16, {
+        pio_encode_set(pio_x, 7),
+        pio_encode_pull(true, true),
+        pio_encode_pull(true, false),
+        pio_encode_pull(false, false),
+        pio_encode_out(pio_y, 16),
+        pio_encode_pull(false, true),
+        pio_encode_out(pio_x, 20),
+        pio_encode_pull(true, true),
+    });
+    in.idle(10).push(1).idle(5).push(2).push(3).idle(20).push(4).idle(10);
+    EXPECT_EQ(Run(in), "");
+}
+
+TEST_F(FsmModelTests, PushStallsOnFullRxFifo) {
+    Input in(false, true, 0, {pio_encode_push(false, true), pio_encode_push(false, false)});
+    in.idle(12).pop().idle(2).pop().pop().idle(6);
+    EXPECT_EQ(Run(in), "");
+}
+
+TEST_F(FsmModelTests, PushIntoFullRxFifoWhilePopped) {
+    // Every word is different, so one dropped on a full FIFO shows up
+    Input in(false, true, 0, {
+        pio_encode_mov(pio_isr, pio_x),
+        pio_encode_push(false, true),
+        pio_encode_jmp_x_dec(0),
+    });
+    in.idle(16).pop().idle(3).pop().idle(1).pop().pop().idle(8);
+    EXPECT_EQ(Run(in), "");
+}
+
+TEST_F(FsmModelTests, JumpConditionsAndMov) {
+    Input in(false, true, 0, {
+        pio_encode_set(pio_x, 3),
+        pio_encode_jmp_x_dec(1),
+        pio_encode_mov(pio_y, pio_x),
+        pio_encode_jmp_x_ne_y(0),
+        pio_encode_jmp_not_osre(6),
+        pio_encode_mov(pio_osr, pio_y),
+        pio_encode_jmp_not_y(9),
+        pio_encode_jmp_y_dec(7),
+        pio_encode_mov(pio_x, pio_osr),
+        pio_encode_out(pio_x, 1),
+    });
+    in.idle(100);
+    EXPECT_EQ(Run(in), "");
+}
+
+TEST_F(FsmModelTests, WrapJmpPinAndStatus) {
+    // wrap_target 1, wrap 5, jmp_pin 3, STATUS_SEL TX, STATUS_N 2
+    const uint32_t exec = 1 | 5u << 5 | 3u << 10 | 2u << 16;
+    Input in(false, true, 0, {
+        pio_encode_set(pio_y, 9),
+        pio_encode_mov(pio_x, pio_status),
+        pio_encode_jmp_pin(4),
+        pio_encode_mov(pio_osr, pio_status),
+        pio_encode_pull(false, false),
+        pio_encode_jmp_x_dec(1),
+    }, exec);
+    in.idle(10).push(1).push(2).idle(10).pins(1u << 3).idle(10).pins(0).push(3).idle(20);
+    EXPECT_EQ(Run(in), "");
+}
+
+TEST_F(FsmModelTests, MovMatrix) {
+    // in_base 4, out_base 30, out_count 5
+    const uint16_t pinctrl = 4 | 30u << 5 | 5u << 10;
+    Input in(false, true, 0, {
+        pio_encode_mov(pio_x, pio_pins),
+        pio_encode_mov_reverse(pio_y, pio_x),
+        pio_encode_mov_not(pio_isr, pio_y),
+        pio_encode_push(false, false),
+        pio_encode_mov_reverse(pio_pins, pio_x),
+        pio_encode_mov_not(pio_osr, pio_isr),
+        pio_encode_pull(false, true),
+        pio_encode_mov(pio_exec_mov, pio_osr),
+        pio_encode_set(pio_x, 12),
+        pio_encode_mov(pio_pc, pio_x),
+        pio_encode_mov(pio_isr, pio_osr),
+        pio_encode_mov_reverse(pio_x, pio_isr),
+        pio_encode_jmp(0),
+    }, 31u << 5, pinctrl);
+    in.push(pio_encode_set(pio_y, 21)).pins(0x12345678).idle(20).pop().pins(0xF00F0FF0);
+    in.push(pio_encode_jmp(3)).idle(30).pop().idle(10);
+    EXPECT_EQ(Run(in), "");
+}
+
+TEST_F(FsmModelTests, EnableAndRestart) {
+    Input in(true, true, 8, {
+        pio_encode_set(pio_x, 31),
+        pio_encode_mov_not(pio_isr, pio_x),
+        pio_encode_out(pio_y, 4),
+        pio_encode_jmp_x_dec(2),
+        pio_encode_push(false, true),
+    }, 1 | 4u << 5);
+    in.push(0x11111111).idle(6).disabled(3).push(0x22222222).disabled(2).idle(4);
+    in.restart().push(0x33333333).idle(8).restart().disabled(4).restart().idle(10);
+    EXPECT_EQ(Run(in), "");
+}
+
+TEST_F(FsmModelTests, IrqAndWaitIrq) {
+    constexpr uint16_t kPrev = 1u << 3, kNext = 3u << 3;
+    // SM 3, so REL indices wrap
+    const uint32_t exec = 31u << 5 | 3u << 20;
+    Input in(false, true, 0, {
+        pio_encode_irq_set(true, 2),
+        pio_encode_wait_irq(true, false, 6) | kNext,
+        pio_encode_irq_wait(false, 3) | kPrev,
+        pio_encode_wait_irq(false, true, 0),
+        pio_encode_irq_clear(true, 5),
+        pio_encode_jmp(0),
+    }, exec);
+    in.idle(6).irqs(1u << 22).idle(6).irqs(1u << 11).idle(5).irqs(1u << 3).idle(4).irqs(0).idle(40);
+    EXPECT_EQ(Run(in), "");
+}
+
+TEST_F(FsmModelTests, RxFifoRandomAccess) {
+    // mov rxfifo[y], isr and mov osr, rxfifo[y], or'd with kIndex | n for entry n
+    constexpr uint16_t kMovToRxfifo = 0x8010, kMovFromRxfifo = 0x8090, kIndex = 0x08;
+    const std::initializer_list<uint16_t> program = {
+        pio_encode_set(pio_y, 1),
+        pio_encode_mov_not(pio_isr, pio_y),
+        kMovToRxfifo,
+        kMovToRxfifo | kIndex | 3,
+        pio_encode_in(pio_y, 4),
+        pio_encode_push(false, false),
+        kMovFromRxfifo | kIndex | 0,
+        pio_encode_out(pio_x, 8),
+        kMovFromRxfifo,
+        pio_encode_mov(pio_isr, pio_osr),
+        pio_encode_jmp_y_dec(2),
+    };
+
+    // GET, PUT, both, and neither
+    for (uint32_t modes = 0; modes < 4; modes++) {
+        Input in(false, true, 0, program, 31u << 5 | modes << 22);
+        in.idle(6).put(0, 0xCAFEF00D).idle(3).put(1, 0x12345678).put(2, 0xAAAA5555).pop().idle(10);
+        in.push(0x0F0F0F0F).put(3, 0xDEADBEEF).pop().pop().idle(20);
+        EXPECT_EQ(Run(in), "") << "modes " << modes;
+    }
+}
+
+// A fixed sweep of random inputs, so the model and RTL are compared on every
+// unit test run and not only when someone runs the fuzzer
+TEST_F(FsmModelTests, RandomInputs) {
+    uint32_t state = 1;
+    std::vector<uint8_t> bytes(256);
+    for (int i = 0; i < 200; i++) {
+        for (uint8_t &b : bytes) {
+            state = state * 1103515245u + 12345u;
+            b = state >> 16 & 0xFF;
+        }
+        FsmDiff<Vtest_wrapper> diff(*uut);
+        ASSERT_EQ(diff.run(bytes.data(), bytes.size()), "") << "input " << i;
+    }
+}
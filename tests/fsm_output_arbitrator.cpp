@@ -1,3 +1,4 @@
+#include <random>
 #include "test_utils.h"
 
 class FsmOutputArbitrator : public VerilatorTestFixture {
@@ -5,11 +6,8 @@ protected:
     void SetUp() override {
         VerilatorTestFixture::SetUp();
 
-        for (int i = 0; i < 32; i++) {
-            uut->core_select[i] = 0b00;
-        }
-
         for (int i = 0; i < 4; i++) {
+            uut->core_select[i] = 0x00000000;
             uut->fsm_output[i] = 0x00000000;
             uut->fsm_drive[i] = 0x00000000;
         }
@@ -41,3 +39,33 @@ TEST_F(FsmOutputArbitrator, LowestIndexedFSMGetsPriorityDuringConflict) {
     EXPECT_EQ(uut->fsm_core_drive, 0xFFFFFFF0);
     EXPECT_EQ(uut->fsm_core_output, 0xDEADFEE0);
 }
+
+TEST_F(FsmOutputArbitrator, MatchesPerBitPriorityChainOnRandomInputs) {
+    // Reference is the original per-bit if/else chain
+    std::mt19937 rng(0xBEEF);
+
+    for (int n = 0; n < 1000; n++) {
+        for (int i = 0; i < 4; i++) {
+            uut->fsm_output[i] = rng();
+            // AND two words together so conflicts and undriven bits are both common
+            uut->fsm_drive[i] = rng() & rng();
+        }
+
+        uut->eval();
+
+        uint32_t expected_output = 0;
+        uint32_t expected_drive = 0;
+        for (int bit = 0; bit < 32; bit++) {
+            for (int i = 0; i < 4; i++) {
+                if ((uut->fsm_drive[i] >> bit) & 1u) {
+                    expected_drive |= 1u << bit;
+                    expected_output |= ((uut->fsm_output[i] >> bit) & 1u) << bit;
+                    break;
+                }
+            }
+        }
+
+        ASSERT_EQ(uut->fsm_core_drive, expected_drive);
+        ASSERT_EQ(uut->fsm_core_output, expected_output);
+    }
+}
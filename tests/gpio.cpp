@@ -8,6 +8,8 @@ protected:
         uut->out_data = 0x00000000;
         uut->sync_bypass = 0x00000000;
         uut->dir = 0x00000000;
+        uut->pde = 0x00000000;
+        uut->pue = 0x00000000;
     }
 };
 
@@ -60,4 +62,47 @@ TEST_F(GpioTests, TestPinsSetToDifferentDirections) {
     uut->eval();
 
     EXPECT_EQ(uut->gpio, 0x55555555);   // 0101 repeating
-}
\ No newline at end of file
+}
+
+// The pull resistors are driven inside the model, so they give us a
+// reliable way to change what the input path sees.
+
+TEST_F(GpioTests, SynchronizedInputTakesTwoCycles) {
+    uut->pde = 0xFFFFFFFF;
+    uut->pue = 0x00000000;
+    AdvanceOneCycle();
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->in_data, 0x00000000);
+
+    uut->pde = 0x00000000;
+    uut->pue = 0xFFFFFFFF;
+    uut->eval();
+    EXPECT_EQ(uut->in_data, 0x00000000);
+
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->in_data, 0x00000000);
+
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->in_data, 0xFFFFFFFF);
+}
+
+TEST_F(GpioTests, BypassedInputIsImmediate) {
+    uut->sync_bypass = 0x0000FFFF;
+    uut->pde = 0xFFFFFFFF;
+    uut->pue = 0x00000000;
+    AdvanceOneCycle();
+    AdvanceOneCycle();
+
+    uut->pde = 0x00000000;
+    uut->pue = 0xFFFFFFFF;
+    uut->eval();
+
+    // Only the bypassed half has seen the change
+    EXPECT_EQ(uut->in_data, 0x0000FFFF);
+
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->in_data, 0x0000FFFF);
+
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->in_data, 0xFFFFFFFF);
+}
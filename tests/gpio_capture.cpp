@@ -0,0 +1,73 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "gtest/gtest.h"
+#include "gpio_capture.h"
+
+TEST(GpioCapture, StoresOnlyEdges) {
+    gpio_capture::Capture capture;
+    for (uint64_t cycle = 0; cycle < 1000; cycle++) {
+        // Pin 0 toggles every 100 cycles
+        capture.sample(cycle, 0, (cycle / 100) & 1, 1);
+    }
+
+    ASSERT_EQ(capture.edges().size(), 10u);
+    EXPECT_EQ(capture.cycles(), 1000u);
+    EXPECT_EQ(capture.edges()[3].cycle, 300u);
+    EXPECT_EQ(capture.edges()[3].level(), 1u);
+}
+
+TEST(GpioCapture, LevelFollowsDrive) {
+    // Driven pins show the chip's output, the rest show the pad
+    gpio_capture::Edge edge{0, 0xF0F0F0F0, 0x0000FFFF, 0x000000FF, 0};
+    EXPECT_EQ(edge.level(), 0xF0F0F0FF);
+}
+
+TEST(GpioCapture, SavesCaptureFile) {
+    const std::string path = testing::TempDir() + "gpio_capture.bin";
+    gpio_capture::Capture capture;
+    capture.sample(0, 1, 0, 0);
+    capture.sample(1, 1, 0, 0);
+    capture.sample(2, 2, 0, 0);
+    capture.save(path);
+
+    std::ifstream file(path, std::ios::binary);
+    gpio_capture::CaptureHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    EXPECT_EQ(std::string(header.magic), "PIOGPIO");
+    EXPECT_EQ(header.cycles, 3u);
+    ASSERT_EQ(header.edge_count, 2u);
+
+    gpio_capture::Edge edges[2];
+    file.read(reinterpret_cast<char *>(edges), sizeof(edges));
+    EXPECT_EQ(edges[1].cycle, 2u);
+    EXPECT_EQ(edges[1].gpio, 2u);
+
+    std::remove(path.c_str());
+}
+
+TEST(GpioCapture, ExportsSigrokSession) {
+    const std::string path = testing::TempDir() + "gpio_capture.sr";
+    gpio_capture::Capture capture;
+    capture.sample(2, 0, 1, 1);
+    capture.sample(3, 0, 0, 1);
+    capture.sample(5, 0, 0, 1);
+    capture.export_sigrok(path, 1000000);
+
+    std::ifstream file(path, std::ios::binary);
+    std::string zip((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(zip.substr(0, 4), "PK\x03\x04");
+    EXPECT_NE(zip.find("samplerate=1000000 Hz"), std::string::npos);
+    EXPECT_NE(zip.find("unitsize=4"), std::string::npos);
+    EXPECT_NE(zip.find("probe32=GPIO31"), std::string::npos);
+
+    // Stored uncompressed, so the samples appear as-is: 0, 0, 1, 0, 0, 0 as 32-bit words
+    const std::string samples("\0\0\0\0\0\0\0\0\1\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 24);
+    const std::size_t data = zip.find("logic-1-1");
+    ASSERT_NE(data, std::string::npos);
+    EXPECT_EQ(zip.substr(data + 9, 24), samples);
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,74 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "gtest/gtest.h"
+#include "gpio_capture.h"
+#include "gpio_stimulus.h"
+
+TEST(GpioStimulus, ReplaysCapture) {
+    const std::string path = testing::TempDir() + "gpio_stimulus.bin";
+    gpio_capture::Capture capture;
+    capture.sample(0, 0x1, 0, 0);
+    capture.sample(4, 0x2, 0, 0);
+    capture.sample(10, 0x3, 0xFF, 0xFF); // The chip's own output isn't replayed
+    capture.sample(11, 0x3, 0, 0);
+    capture.save(path);
+
+    gpio_stimulus::Stimulus stimulus(path);
+    EXPECT_EQ(stimulus.cycles(), 12u);
+    EXPECT_EQ(stimulus.at(0), 0x1u);
+    EXPECT_EQ(stimulus.at(3), 0x1u);
+    EXPECT_EQ(stimulus.at(4), 0x2u);
+    EXPECT_EQ(stimulus.at(10), 0x3u);
+    // Held after the end
+    EXPECT_EQ(stimulus.at(1000), 0x3u);
+
+    std::remove(path.c_str());
+}
+
+TEST(GpioStimulus, ReplaysRawSamples) {
+    const std::string path = testing::TempDir() + "gpio_stimulus.raw";
+    const uint32_t samples[] = {5, 6, 7};
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    std::fwrite(samples, sizeof(samples[0]), 3, file);
+    std::fclose(file);
+
+    gpio_stimulus::Stimulus stimulus(path);
+    EXPECT_EQ(stimulus.cycles(), 3u);
+    EXPECT_EQ(stimulus.at(1), 6u);
+    EXPECT_EQ(stimulus.at(2), 7u);
+    EXPECT_EQ(stimulus.at(3), 7u);
+
+    std::remove(path.c_str());
+}
+
+TEST(GpioStimulus, ApplyOnlyTouchesMaskedPins) {
+    const std::string path = testing::TempDir() + "gpio_stimulus_mask.raw";
+    const uint32_t sample = 0xFFFFFFFF;
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    std::fwrite(&sample, sizeof(sample), 1, file);
+    std::fclose(file);
+
+    gpio_stimulus::Stimulus stimulus(path);
+    uint32_t pins = 0x12340000;
+    stimulus.apply(0, pins, 0x000000FF);
+    EXPECT_EQ(pins, 0x123400FFu);
+
+    std::remove(path.c_str());
+}
+
+TEST(GpioStimulus, NextChange) {
+    const std::string path = testing::TempDir() + "gpio_stimulus_next.bin";
+    gpio_capture::Capture capture;
+    capture.sample(0, 0x1, 0, 0);
+    capture.sample(4, 0x1, 0xFF, 0xFF); // Only the output changed
+    capture.sample(9, 0x2, 0, 0);
+    capture.save(path);
+
+    gpio_stimulus::Stimulus stimulus(path);
+    EXPECT_EQ(stimulus.next_change(0), 9u);
+    EXPECT_EQ(stimulus.next_change(5), 9u);
+    EXPECT_EQ(stimulus.next_change(9), UINT64_MAX);
+
+    std::remove(path.c_str());
+}
@@ -9,6 +9,8 @@ protected:
         uut->write_addr = 0b00000;
         uut->write_en = 0;
         uut->read_addr = 0b00000;
+        uut->instr_shadow_write = 0;
+        uut->instr_swap = 0;
     }
 };
 
@@ -87,4 +89,44 @@ TEST_F(InstructionRegfileTests, TestWriteEnableFalse) {
         uut->clk = 0;
         uut->eval();
     }
-}
\ No newline at end of file
+}
+
+TEST_F(InstructionRegfileTests, TestShadowBankSwap) {
+    // The same address in the active bank, then in the shadow bank
+    uut->write_en = 1;
+    uut->write_addr = 0b00011;
+    uut->instr_in = 0x1111;
+    AdvanceOneCycle();
+    uut->instr_shadow_write = 1;
+    uut->instr_in = 0x2222;
+    AdvanceOneCycle();
+    uut->write_en = 0;
+
+    // Reads only ever see the active bank
+    uut->read_addr = 0b00011;
+    uut->eval();
+    EXPECT_EQ(uut->instr_out, 0x1111);
+    EXPECT_EQ(uut->instr_active, 0);
+
+    // The swap lands on the clock it's requested for
+    uut->instr_swap = 1;
+    AdvanceOneCycle();
+    uut->instr_swap = 0;
+    EXPECT_EQ(uut->instr_out, 0x2222);
+    EXPECT_EQ(uut->instr_active, 1);
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->instr_out, 0x2222);
+
+    // The old program is now the shadow bank, and is what shadow writes replace
+    uut->write_en = 1;
+    uut->instr_in = 0x3333;
+    AdvanceOneCycle();
+    uut->write_en = 0;
+    EXPECT_EQ(uut->instr_out, 0x2222);
+
+    uut->instr_swap = 1;
+    AdvanceOneCycle();
+    uut->instr_swap = 0;
+    EXPECT_EQ(uut->instr_out, 0x3333);
+    EXPECT_EQ(uut->instr_active, 0);
+}
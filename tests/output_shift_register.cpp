@@ -8,6 +8,7 @@ protected:
         uut->osr_data_in = 0x00000000;
         uut->osr_load = 0;
         uut->osr_shift_en = 0;
+        uut->osr_refill = 0;
         uut->osr_shiftdir = 0; // Left shift
         uut->osr_shift_count = 0b100000; // 32
 
@@ -195,3 +196,28 @@ TEST_F(OutputShiftRegisterTests, OutShiftsZerosAfterEmpty) {
         EXPECT_EQ(uut->osr_shift_out, 0x00000000);
     }
 }
+
+TEST_F(OutputShiftRegisterTests, RefillShiftsOutOfTheNewWord) {
+    // Whatever is left in the OSR is ignored
+    uut->osr_data_in = 0xFFFFFFFF;
+    uut->osr_load = 1;
+    AdvanceOneCycle();
+
+    // Right shift 8 bits straight out of data_in
+    uut->osr_load = 0;
+    uut->osr_shift_en = 1;
+    uut->osr_refill = 1;
+    uut->osr_shiftdir = 1;
+    uut->osr_shift_count = 8;
+    uut->osr_data_in = 0x12345678;
+    uut->eval();
+    EXPECT_EQ(uut->osr_shift_out, 0x00000078);
+
+    AdvanceOneCycle();
+    EXPECT_EQ(uut->osr, 0x00123456);
+
+    // Then on from the OSR as usual
+    uut->osr_refill = 0;
+    uut->eval();
+    EXPECT_EQ(uut->osr_shift_out, 0x00000056);
+}
@@ -0,0 +1,171 @@
+#include <cstdint>
+#include "gtest/gtest.h"
+#include "hardware/pio_instructions.h"
+#include "pio_asm.h"
+
+// The assembler is checked against the pico-sdk encoders the other tests use
+
+TEST(PioAsm, EncodesEveryInstructionLikePicoSdk) {
+    constexpr auto program = pio_asm::assemble<R"(
+        jmp 7
+        jmp !x 1
+        jmp x--, 2
+        jmp !y 3
+        jmp y-- 4
+        jmp x!=y 5
+        jmp pin 6
+        jmp !osre 31
+        wait 1 gpio 4
+        wait 0 pin 9
+        wait 1 irq 2 rel
+        in pins, 32
+        in x, 5
+        out null, 32
+        out y, 8
+        push
+        push iffull noblock
+        pull
+        pull ifempty noblock
+        mov x, y
+        mov osr, !x
+        mov isr, :: osr
+        irq 3
+        irq wait 1 rel
+        irq clear 2
+        set x, 31
+        set pindirs, 1
+        nop
+    )">();
+
+    const uint16_t expected[] = {
+        static_cast<uint16_t>(pio_encode_jmp(7)),
+        static_cast<uint16_t>(pio_encode_jmp_not_x(1)),
+        static_cast<uint16_t>(pio_encode_jmp_x_dec(2)),
+        static_cast<uint16_t>(pio_encode_jmp_not_y(3)),
+        static_cast<uint16_t>(pio_encode_jmp_y_dec(4)),
+        static_cast<uint16_t>(pio_encode_jmp_x_ne_y(5)),
+        static_cast<uint16_t>(pio_encode_jmp_pin(6)),
+        static_cast<uint16_t>(pio_encode_jmp_not_osre(31)),
+        static_cast<uint16_t>(pio_encode_wait_gpio(true, 4)),
+        static_cast<uint16_t>(pio_encode_wait_pin(false, 9)),
+        static_cast<uint16_t>(pio_encode_wait_irq(true, true, 2)),
+        static_cast<uint16_t>(pio_encode_in(pio_pins, 32)),
+        static_cast<uint16_t>(pio_encode_in(pio_x, 5)),
+        static_cast<uint16_t>(pio_encode_out(pio_null, 32)),
+        static_cast<uint16_t>(pio_encode_out(pio_y, 8)),
+        static_cast<uint16_t>(pio_encode_push(false, true)),
+        static_cast<uint16_t>(pio_encode_push(true, false)),
+        static_cast<uint16_t>(pio_encode_pull(false, true)),
+        static_cast<uint16_t>(pio_encode_pull(true, false)),
+        static_cast<uint16_t>(pio_encode_mov(pio_x, pio_y)),
+        static_cast<uint16_t>(pio_encode_mov_not(pio_osr, pio_x)),
+        static_cast<uint16_t>(pio_encode_mov_reverse(pio_isr, pio_osr)),
+        static_cast<uint16_t>(pio_encode_irq_set(false, 3)),
+        static_cast<uint16_t>(pio_encode_irq_wait(true, 1)),
+        static_cast<uint16_t>(pio_encode_irq_clear(false, 2)),
+        static_cast<uint16_t>(pio_encode_set(pio_x, 31)),
+        static_cast<uint16_t>(pio_encode_set(pio_pindirs, 1)),
+        static_cast<uint16_t>(pio_encode_nop()),
+    };
+
+    ASSERT_EQ(program.length(), std::size(expected));
+    for (std::size_t i = 0; i < program.length(); i++) {
+        EXPECT_EQ(program.instructions[i], expected[i]) << "instruction " << i;
+    }
+}
+
+TEST(PioAsm, LabelsWrapAndDefines) {
+    constexpr auto program = pio_asm::assemble<R"(
+    .program labels
+    .define PIN 3
+        set x, PIN
+    .wrap_target
+    loop:
+        jmp x-- loop    ; backward reference
+        jmp done        // forward reference
+        nop
+    done:
+        set y, 0
+    .wrap
+        jmp loop
+    )">();
+
+    static_assert(program.length() == 6);
+    static_assert(program.wrap_target == 1);
+    static_assert(program.wrap == 4);
+    static_assert(program.origin == -1);
+
+    EXPECT_EQ(program.instructions[0], pio_encode_set(pio_x, 3));
+    EXPECT_EQ(program.instructions[1], pio_encode_jmp_x_dec(1));
+    EXPECT_EQ(program.instructions[2], pio_encode_jmp(4));
+    EXPECT_EQ(program.instructions[5], pio_encode_jmp(1));
+}
+
+TEST(PioAsm, DelayAndSideSet) {
+    constexpr auto optional = pio_asm::assemble<R"(
+    .side_set 2 opt
+        nop side 3 [1]
+        nop [3]
+    )">();
+
+    static_assert(optional.sideset_bits == 2 && optional.sideset_opt);
+    EXPECT_EQ(optional.instructions[0], pio_encode_nop() | pio_encode_sideset_opt(2, 3) | pio_encode_delay(1));
+    EXPECT_EQ(optional.instructions[1], pio_encode_nop() | pio_encode_delay(3));
+
+    constexpr auto mandatory = pio_asm::assemble<R"(
+    .side_set 1
+        set pins, 1 side 0 [15]
+        set pins, 0 side 1
+    )">();
+
+    EXPECT_EQ(mandatory.instructions[0], pio_encode_set(pio_pins, 1) | pio_encode_sideset(1, 0) | pio_encode_delay(15));
+    EXPECT_EQ(mandatory.instructions[1], pio_encode_set(pio_pins, 0) | pio_encode_sideset(1, 1));
+}
+
+TEST(PioAsm, IrqPrevAndNext) {
+    // RP2350 index modes, bits [4:3] of the index: 01 prev, 11 next
+    constexpr auto program = pio_asm::assemble<R"(
+        irq next 5
+        irq prev wait 2
+        irq clear next 1
+        wait 1 irq prev 3
+    )">();
+    EXPECT_EQ(program.instructions[0], pio_encode_irq_set(false, 5) | 0x18);
+    EXPECT_EQ(program.instructions[1], pio_encode_irq_wait(false, 2) | 0x08);
+    EXPECT_EQ(program.instructions[2], pio_encode_irq_clear(false, 1) | 0x18);
+    EXPECT_EQ(program.instructions[3], pio_encode_wait_irq(true, false, 3) | 0x08);
+
+    EXPECT_THROW(pio_asm::detail::parse("irq next 1 rel"), pio_asm::assembler_error);
+    EXPECT_THROW(pio_asm::detail::parse("irq prev next 1"), pio_asm::assembler_error);
+}
+
+TEST(PioAsm, RxFifoRandomAccess) {
+    // RP2350 mov to and from rxfifo[], encoded as push and pull with bit 4 set
+    // and bit 3 picking a fixed entry over Y
+    constexpr auto program = pio_asm::assemble<R"(
+        mov rxfifo[y], isr
+        mov rxfifo[ 2 ], isr
+        mov osr, rxfifo[y]
+        mov osr, rxfifo[3] [1]
+    )">();
+    EXPECT_EQ(program.instructions[0], 0x8010);
+    EXPECT_EQ(program.instructions[1], 0x801A);
+    EXPECT_EQ(program.instructions[2], 0x8090);
+    EXPECT_EQ(program.instructions[3], 0x809B | pio_encode_delay(1));
+
+    EXPECT_THROW(pio_asm::detail::parse("mov rxfifo[4], isr"), pio_asm::assembler_error);
+    EXPECT_THROW(pio_asm::detail::parse("mov rxfifo[y], x"), pio_asm::assembler_error);
+    EXPECT_THROW(pio_asm::detail::parse("mov x, rxfifo[y]"), pio_asm::assembler_error);
+}
+
+TEST(PioAsm, RuntimeParseReportsErrors) {
+    // The same checks that make assemble<>() fail to compile
+    EXPECT_THROW(pio_asm::detail::parse("jmp nowhere"), pio_asm::assembler_error);
+    EXPECT_THROW(pio_asm::detail::parse("set x, 32"), pio_asm::assembler_error);
+    EXPECT_THROW(pio_asm::detail::parse("out x, 0"), pio_asm::assembler_error);
+    EXPECT_THROW(pio_asm::detail::parse("mov x, bogus"), pio_asm::assembler_error);
+    EXPECT_THROW(pio_asm::detail::parse(".side_set 1\nnop"), pio_asm::assembler_error);
+    EXPECT_THROW(pio_asm::detail::parse(".side_set 3\nnop side 0 [4]"), pio_asm::assembler_error);
+    EXPECT_THROW(pio_asm::detail::parse("a:\na:\nnop"), pio_asm::assembler_error);
+    EXPECT_THROW(pio_asm::detail::parse("; only a comment"), pio_asm::assembler_error);
+}
@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <string>
+#include "gtest/gtest.h"
+#include "hardware/pio_instructions.h"
+#include "pio_coverage.h"
+
+TEST(PioCoverage, BinsFollowTheEncoding) {
+    pio_coverage::Coverage coverage;
+    // 8 jmp, 6 wait, 6 in, 8 out, 8 push/pull, 2 mov rxfifo, 7 x 7 x 3 mov, 3 irq, 4 set
+    EXPECT_EQ(coverage.instruction_bins(), 192u);
+    EXPECT_EQ(coverage.bins(), 192u + 3 + 10);
+}
+
+TEST(PioCoverage, IgnoresOperandsDelayAndSideSet) {
+    pio_coverage::Coverage coverage;
+    coverage.sample_instruction(pio_encode_jmp_x_dec(3));
+    coverage.sample_instruction(pio_encode_jmp_x_dec(17) | pio_encode_delay(7));
+    coverage.sample_instruction(pio_encode_out(pio_x, 32));
+    coverage.sample_instruction(pio_encode_mov_not(pio_osr, pio_y));
+    coverage.sample_instruction(pio_encode_pull(true, false));
+
+    EXPECT_EQ(coverage.count("jmp x--"), 2u);
+    EXPECT_EQ(coverage.count("out x"), 1u);
+    EXPECT_EQ(coverage.count("mov osr, !y"), 1u);
+    EXPECT_EQ(coverage.count("pull ifempty noblock"), 1u);
+    EXPECT_EQ(coverage.covered(), 4u);
+}
+
+TEST(PioCoverage, ReservedEncodingsHaveNoBin) {
+    pio_coverage::Coverage coverage;
+    coverage.sample_instruction(0xA018); // mov pins, <op 3> pins
+    coverage.sample_instruction(0xE060); // set <3>, 0
+    coverage.sample_instruction(0x4080); // in <4>, 32
+    EXPECT_EQ(coverage.covered(), 0u);
+}
+
+TEST(PioCoverage, RxFifoRandomAccess) {
+    pio_coverage::Coverage coverage;
+    coverage.sample_instruction(0x8010); // mov rxfifo[y], isr
+    coverage.sample_instruction(0x801B); // mov rxfifo[3], isr
+    coverage.sample_instruction(0x8098); // mov osr, rxfifo[0]
+    coverage.sample_instruction(0x8014); // Bit 2 is reserved
+    EXPECT_EQ(coverage.count("mov rxfifo[], isr"), 2u);
+    EXPECT_EQ(coverage.count("mov osr, rxfifo[]"), 1u);
+    EXPECT_EQ(coverage.covered(), 2u);
+}
+
+TEST(PioCoverage, StallsAndLevels) {
+    pio_coverage::Coverage coverage;
+    coverage.sample_stalls(pio_trace::kTxStall | pio_trace::kRxStall);
+    coverage.sample_levels(4, 0);
+    EXPECT_EQ(coverage.count("stall tx"), 1u);
+    EXPECT_EQ(coverage.count("stall rx"), 1u);
+    EXPECT_EQ(coverage.count("stall wait"), 0u);
+    EXPECT_EQ(coverage.count("tx level 4"), 1u);
+    EXPECT_EQ(coverage.count("rx level 0"), 1u);
+}
+
+TEST(PioCoverage, ShardsMerge) {
+    const std::string a = testing::TempDir() + "pio_coverage_a.cov";
+    const std::string b = testing::TempDir() + "pio_coverage_b.cov";
+
+    pio_coverage::Coverage shard;
+    shard.sample_instruction(pio_encode_set(pio_x, 1));
+    shard.save(a);
+    shard.sample_instruction(pio_encode_in(pio_osr, 8));
+    shard.save(b);
+
+    pio_coverage::Coverage merged;
+    merged.merge(a);
+    merged.merge(b);
+    EXPECT_EQ(merged.count("set x"), 2u);
+    EXPECT_EQ(merged.count("in osr"), 1u);
+
+    std::remove(a.c_str());
+    std::remove(b.c_str());
+}
@@ -0,0 +1,136 @@
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+#include "Vpio_chip.h"
+#include "hardware/pio_instructions.h"
+#include "pio_asm.h"
+#include "pio_bus.h"
+#include "pio_loader.h"
+
+namespace {
+
+// Has to sit at 0, and only loops through the wrap
+constexpr auto kFixed = pio_asm::assemble<R"(
+.origin 0
+    set x, 1
+    nop
+)">();
+
+// Loops back both with a JMP and through the wrap, so it needs both
+// relocated. The NOP fills the slot after the JMP, which runs whether or not
+// it's taken.
+constexpr auto kCountdown = pio_asm::assemble<R"(
+.wrap_target
+    set y, 3
+loop:
+    jmp y--, loop
+    nop
+.wrap
+)">();
+
+} // namespace
+
+class PioLoaderTests : public ::testing::Test {
+protected:
+    using Running = std::pair<unsigned, pio_loader::Placement>; // SM and its program
+
+    Vpio_chip chip;
+    PioBus<Vpio_chip> bus{chip};
+    pio_loader::Loader<Vpio_chip> loader{bus};
+
+    void SetUp() override { bus.reset(); }
+
+    // Points `sm` at a loaded program and enables it. SM_RESTART starts it
+    // at the wrap target, on the clock after the CTRL write.
+    void Start(unsigned core, unsigned sm, const pio_loader::Placement &placement) {
+        bus.write(core, pio_regs::sm_reg(sm, pio_regs::kSmExecctrl), placement.execctrl());
+        const uint32_t ctrl = bus.read(core, pio_regs::kCtrl) & 0xF;
+        bus.write(core, pio_regs::kCtrl, ctrl | 1u << sm | 1u << (4 + sm));
+        bus.tick();
+    }
+
+    // Every SM stays inside its own program and gets round all of it
+    void ExpectEachRunsItsOwn(unsigned core, const std::vector<Running> &running) {
+        std::vector<uint32_t> visited(running.size());
+        for (int cycle = 0; cycle < 32; cycle++) {
+            for (std::size_t i = 0; i < running.size(); i++) {
+                const auto &[sm, placement] = running[i];
+                const uint32_t pc = bus.read(core, pio_regs::sm_reg(sm, pio_regs::kSmAddr));
+                EXPECT_GE(pc, placement.offset) << "SM " << sm << " cycle " << cycle;
+                EXPECT_LT(pc, placement.offset + placement.length) << "SM " << sm << " cycle " << cycle;
+                visited[i] |= 1u << pc;
+            }
+            bus.tick();
+        }
+        for (std::size_t i = 0; i < running.size(); i++) {
+            const auto &[sm, placement] = running[i];
+            EXPECT_EQ(visited[i], pio_loader::slot_mask(placement.length, placement.offset)) << "SM " << sm;
+        }
+    }
+};
+
+TEST_F(PioLoaderTests, PlacesProgramsLikeTheSdk) {
+    EXPECT_EQ(pio_loader::find_offset(0, 4, -1), 28);
+    EXPECT_EQ(pio_loader::find_offset(0xF0000000, 4, -1), 24);
+    EXPECT_EQ(pio_loader::find_offset(0xF0000000, 4, 26), -1);
+    EXPECT_EQ(pio_loader::find_offset(0xF0000000, 4, 20), 20);
+    EXPECT_EQ(pio_loader::find_offset(0, 32, -1), 0);
+    EXPECT_EQ(pio_loader::find_offset(1, 32, -1), -1);
+    // Free space split around a program doesn't add up
+    EXPECT_EQ(pio_loader::find_offset(0x0000FF00, 20, -1), -1);
+    EXPECT_EQ(pio_loader::find_offset(0x0000FF00, 16, -1), 16);
+
+    // Only JMP targets move, and the rest of the JMP is kept
+    EXPECT_EQ(pio_loader::relocate(pio_encode_jmp_x_dec(3) | pio_encode_delay(5), 8),
+        pio_encode_jmp_x_dec(11) | pio_encode_delay(5));
+    EXPECT_EQ(pio_loader::relocate(pio_encode_set(pio_x, 3), 8), pio_encode_set(pio_x, 3));
+}
+
+TEST_F(PioLoaderTests, CoHostsProgramsOnOneCore) {
+    const auto fixed = loader.add(0, kFixed);
+    const auto first = loader.add(0, kCountdown);
+    const auto second = loader.add(0, kCountdown);
+    ASSERT_TRUE(fixed && first && second);
+    EXPECT_EQ(fixed->offset, 0u);
+    EXPECT_EQ(first->offset, 29u);
+    EXPECT_EQ(second->offset, 26u);
+    EXPECT_EQ(first->wrap_target, 29);
+    EXPECT_EQ(first->wrap, 31);
+    EXPECT_EQ(second->wrap_target, 26);
+    EXPECT_EQ(second->wrap, 28);
+    EXPECT_EQ(loader.used(0), 0xFC000003u);
+
+    // Three SMs, the two countdowns on separate copies
+    Start(0, 0, *fixed);
+    Start(0, 1, *first);
+    Start(0, 2, *second);
+    ExpectEachRunsItsOwn(0, {{0, *fixed}, {1, *first}, {2, *second}});
+}
+
+TEST_F(PioLoaderTests, RemovedProgramsFreeTheirSpace) {
+    pio_loader::Placement placed[10];
+    for (auto &placement : placed) {
+        const auto added = loader.add(1, kCountdown);
+        ASSERT_TRUE(added);
+        placement = *added;
+    }
+    EXPECT_EQ(placed[9].offset, 2u);
+    EXPECT_FALSE(loader.add(1, kCountdown)); // 0-1 are free, but too short
+    EXPECT_TRUE(loader.add(1, kFixed));
+    EXPECT_EQ(loader.used(1), 0xFFFFFFFFu);
+
+    // The gap is reused, and the copy loaded into it runs
+    loader.remove(1, placed[4]);
+    EXPECT_FALSE(loader.add(1, kFixed));
+    const auto reloaded = loader.add(1, kCountdown);
+    ASSERT_TRUE(reloaded);
+    EXPECT_EQ(reloaded->offset, placed[4].offset);
+    Start(1, 3, *reloaded);
+    ExpectEachRunsItsOwn(1, {{3, *reloaded}});
+
+    // Every core has its own memory
+    const auto elsewhere = loader.add(2, kCountdown);
+    ASSERT_TRUE(elsewhere);
+    EXPECT_EQ(elsewhere->offset, 29u);
+}
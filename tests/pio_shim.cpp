@@ -0,0 +1,469 @@
+#include <cstdint>
+#include "gtest/gtest.h"
+#include "Vpio_chip.h"
+#include "hardware/pio.h"
+#include "pio_shim.h"
+
+class PioShimTests : public ::testing::Test {
+protected:
+    Vpio_chip *chip;
+
+    void SetUp() override {
+        chip = new Vpio_chip;
+        pio_shim_attach(chip);
+    }
+
+    void TearDown() override {
+        pio_shim_detach();
+        delete chip;
+    }
+
+    uint32_t ReadReg(unsigned core, uint16_t addr) {
+        chip->reg_read_addr = core << 9 | addr;
+        chip->eval();
+        return chip->reg_data_out;
+    }
+
+    uint32_t ReadCtrl(unsigned core) { return ReadReg(core, 0x000); }
+
+    // SMx_INSTR, the instruction the SM is executing
+    uint16_t CurrentInstr(PIO pio, unsigned sm) {
+        return static_cast<uint16_t>(ReadReg(pio_get_index(pio), 0x0D8 + 0x18 * sm));
+    }
+};
+
+TEST_F(PioShimTests, DefaultConfigMatchesSdk) {
+    pio_sm_config c = pio_get_default_sm_config();
+    EXPECT_EQ(c.clkdiv, 0x00010000u);
+    EXPECT_EQ(c.execctrl, 0x0001F000u); // Wrap 0..31
+    EXPECT_EQ(c.shiftctrl, 0x000C0000u); // Both shift right, 32-bit thresholds
+    EXPECT_EQ(c.pinctrl, 0u);
+
+    sm_config_set_out_shift(&c, false, true, 8);
+    sm_config_set_sideset(&c, 2, true, false);
+    sm_config_set_sideset_pins(&c, 3);
+    EXPECT_EQ(c.shiftctrl, 0x10060000u);
+    EXPECT_EQ(c.pinctrl, 0x40000C00u);
+    EXPECT_EQ(c.execctrl, 0x4001F000u);
+}
+
+TEST_F(PioShimTests, AddProgramPacksFromTheTop) {
+    const uint16_t instructions[] = {pio_encode_nop(), pio_encode_nop(), pio_encode_nop(), pio_encode_nop()};
+    const pio_program_t program = {instructions, 4, -1, 0};
+
+    EXPECT_EQ(pio_add_program(pio0, &program), 28);
+    EXPECT_EQ(pio_add_program(pio0, &program), 24);
+
+    const pio_program_t fixed = {instructions, 4, 26, 0};
+    EXPECT_FALSE(pio_can_add_program(pio0, &fixed));
+
+    pio_remove_program(pio0, &program, 24);
+    EXPECT_FALSE(pio_can_add_program(pio0, &fixed)); // Still overlaps 28
+    pio_remove_program(pio0, &program, 28);
+    EXPECT_EQ(pio_add_program(pio0, &fixed), 26);
+
+    // Each core has its own instruction memory
+    EXPECT_EQ(pio_add_program(pio1, &program), 28);
+}
+
+TEST_F(PioShimTests, AddProgramRelocatesJumps) {
+    // Memory resets to zeroes (jmp 0), so the state machines start out at 0.
+    // Both slots jump, so the instruction after each jmp lands in the loop too.
+    const uint16_t trampoline[] = {pio_encode_jmp(8), pio_encode_jmp(8)};
+    const pio_program_t to_8 = {trampoline, 2, 0, 0};
+    ASSERT_EQ(pio_add_program(pio0, &to_8), 0);
+
+    // Stays at 8-9 only if the jmp 0s became jmp 8s
+    const uint16_t loop[] = {pio_encode_jmp(0), pio_encode_jmp(0)};
+    const pio_program_t looping = {loop, 2, -1, 0};
+    ASSERT_EQ(pio_add_program_at_offset(pio0, &looping, 8), 8);
+
+    pio_sm_set_enabled(pio0, 0, true);
+    pio_shim_run(6);
+    for (int i = 0; i < 8; i++) {
+        uint8_t pc = pio_sm_get_pc(pio0, 0);
+        EXPECT_TRUE(pc == 8 || pc == 9) << "pc " << int(pc);
+        pio_shim_run(1);
+    }
+}
+
+TEST_F(PioShimTests, PutBlockingClocksUntilThereIsSpace) {
+    // Nothing pulls yet, so four writes fill the TX FIFO
+    for (uint32_t i = 0; i < 4; i++) {
+        pio_sm_put(pio0, 0, i);
+    }
+    EXPECT_TRUE(pio_sm_is_tx_fifo_full(pio0, 0));
+    EXPECT_EQ(pio_sm_get_tx_fifo_level(pio0, 0), 4u);
+
+    const uint16_t pull[] = {pio_encode_pull(false, true)};
+    const pio_program_t program = {pull, 1, 0, 0};
+    pio_add_program(pio0, &program);
+    pio_sm_set_enabled(pio0, 0, true);
+
+    const uint64_t start = pio_shim_cycles();
+    for (uint32_t i = 0; i < 8; i++) {
+        pio_sm_put_blocking(pio0, 0, i);
+    }
+    EXPECT_GE(pio_shim_cycles() - start, 8u);
+}
+
+TEST_F(PioShimTests, GetBlockingGivesUpAfterTimeout) {
+    // Running, if only jmp 0, so the wait can't be cut short
+    pio_sm_set_enabled(pio0, 0, true);
+    pio_shim_set_timeout(100);
+    EXPECT_DEATH(pio_sm_get_blocking(pio0, 0), "still blocked after 100 cycles");
+    pio_shim_set_timeout(100'000'000);
+}
+
+TEST_F(PioShimTests, RunSkipsWhileEverythingIsStalled) {
+    // Every SM on every core blocks on its empty TX FIFO
+    uint16_t pulls[PIO_INSTRUCTION_COUNT];
+    for (uint16_t &instr : pulls) instr = pio_encode_pull(false, true);
+    const pio_program_t program = {pulls, PIO_INSTRUCTION_COUNT, 0, 0};
+    for (PIO pio : {pio0, pio1, pio2, pio3}) {
+        ASSERT_EQ(pio_add_program(pio, &program), 0);
+        pio_set_sm_mask_enabled(pio, 0xF, true);
+    }
+
+    pio_shim_run(4);
+    ASSERT_TRUE(chip->quiescent);
+
+    // Far too long to simulate cycle by cycle
+    const uint64_t start = pio_shim_cycles();
+    pio_shim_run(1'000'000'000'000);
+    EXPECT_EQ(pio_shim_cycles() - start, 1'000'000'000'000u);
+
+    // Nothing could ever fill the RX FIFO
+    EXPECT_DEATH(pio_sm_get_blocking(pio0, 0), "every state machine stalled or disabled");
+
+    pio_sm_put(pio2, 1, 7);
+    EXPECT_FALSE(chip->quiescent);
+}
+
+TEST_F(PioShimTests, PendingSwapStopsRunSkipping) {
+    // Every SM blocks on its empty TX FIFO, with the same in the shadow bank
+    uint16_t pulls[PIO_INSTRUCTION_COUNT];
+    for (uint16_t &instr : pulls) instr = pio_encode_pull(false, true);
+    const pio_program_t program = {pulls, PIO_INSTRUCTION_COUNT, 0, 0};
+    for (PIO pio : {pio0, pio1, pio2, pio3}) {
+        ASSERT_EQ(pio_add_program(pio, &program), 0);
+        pio_set_sm_mask_enabled(pio, 0xF, true);
+    }
+    pio_shim_load_shadow(pio1, &program, 0);
+    pio_shim_run(4);
+    ASSERT_TRUE(chip->quiescent);
+    const uint32_t bank = ReadReg(1, 0x198) & 1;
+
+    // A swap that's due has to happen before time is skipped
+    pio_shim_swap_now(pio1);
+    pio_shim_run(1'000'000);
+    EXPECT_FALSE(pio_shim_swap_pending(pio1));
+    EXPECT_EQ(ReadReg(1, 0x198) & 1, bank ^ 1);
+
+    // So does one waiting on an IRQ flag that's already set
+    pio_interrupt_force(pio1, 2);
+    pio_shim_swap_on_irq(pio1, 2);
+    pio_shim_run(1'000'000);
+    EXPECT_FALSE(pio_shim_swap_pending(pio1));
+    EXPECT_EQ(ReadReg(1, 0x198) & 1, bank);
+    EXPECT_TRUE(chip->quiescent);
+}
+
+TEST_F(PioShimTests, SetEnabledWritesCtrl) {
+    pio_sm_set_enabled(pio2, 1, true);
+    pio_sm_set_enabled(pio2, 3, true);
+    EXPECT_EQ(ReadCtrl(2) & 0xF, 0b1010u);
+
+    pio_sm_set_enabled(pio2, 1, false);
+    EXPECT_EQ(ReadCtrl(2) & 0xF, 0b1000u);
+    EXPECT_EQ(ReadCtrl(0) & 0xF, 0u);
+}
+
+TEST_F(PioShimTests, DisabledStateMachinesDontRun) {
+    const uint16_t count[] = {pio_encode_jmp_x_dec(0), pio_encode_jmp(0)};
+    const pio_program_t program = {count, 2, 0, 0};
+    ASSERT_EQ(pio_add_program(pio1, &program), 0);
+
+    pio_shim_run(20);
+    EXPECT_EQ(pio_sm_get_pc(pio1, 2), 0);
+    EXPECT_TRUE(chip->quiescent);
+}
+
+TEST_F(PioShimTests, RestartRearmsWithoutReloading) {
+    // Stops at the blocking PULL once the TX FIFO runs dry
+    const uint16_t program_words[] = {pio_encode_pull(false, true), pio_encode_out(pio_null, 32)};
+    const pio_program_t program = {program_words, 2, 0, 0};
+    ASSERT_EQ(pio_add_program(pio0, &program), 0);
+    pio_sm_set_enabled(pio0, 1, true);
+    pio_sm_put(pio0, 1, 1);
+    pio_shim_run(20);
+    EXPECT_TRUE(pio_sm_is_tx_fifo_empty(pio0, 1));
+
+    // Park it, queue the next burst and restart: the program, configuration
+    // and queued words all survive
+    pio_sm_set_enabled(pio0, 1, false);
+    pio_sm_put(pio0, 1, 2);
+    pio_sm_put(pio0, 1, 3);
+    pio_sm_restart(pio0, 1);
+    pio_shim_run(1);
+    EXPECT_EQ(pio_sm_get_pc(pio0, 1), 0);
+    EXPECT_EQ(pio_sm_get_tx_fifo_level(pio0, 1), 2u);
+
+    pio_sm_set_enabled(pio0, 1, true);
+    pio_shim_run(20);
+    EXPECT_TRUE(pio_sm_is_tx_fifo_empty(pio0, 1));
+}
+
+TEST_F(PioShimTests, SyncStartHasNoSkewAcrossCores) {
+    // Every pc counts 0..31, so two SMs started together read the same pc forever
+    uint16_t nops[32];
+    for (uint16_t &nop : nops) nop = pio_encode_nop();
+    const pio_program_t program = {nops, 32, 0, 0};
+    PIO pios[] = {pio0, pio1, pio2, pio3};
+    for (PIO pio : pios) ASSERT_EQ(pio_add_program(pio, &program), 0);
+
+    // Enabling one core at a time leaves them a CTRL write apart
+    pio_sm_set_enabled(pio0, 0, true);
+    pio_sm_set_enabled(pio1, 1, true);
+    pio_shim_run(5);
+    EXPECT_EQ((pio_sm_get_pc(pio0, 0) + 32 - pio_sm_get_pc(pio1, 1)) % 32, 1);
+
+    // SM x of core x, with core 1's SM already running from somewhere else
+    const uint16_t mask = 1u << 0 | 1u << 5 | 1u << 10 | 1u << 15;
+    pio_shim_start_in_sync(mask);
+    chip->reg_read_addr = 3u << 9 | 0x1F8;
+    chip->eval();
+    EXPECT_EQ(chip->reg_data_out, mask);
+    for (unsigned core = 0; core < 4; core++) EXPECT_EQ(ReadCtrl(core) & 0xF, 1u << core);
+
+    for (int cycle = 0; cycle < 40; cycle++) {
+        pio_shim_run(1);
+        const uint8_t pc = pio_sm_get_pc(pio0, 0);
+        for (unsigned core = 1; core < 4; core++) EXPECT_EQ(pio_sm_get_pc(pios[core], core), pc) << "cycle " << cycle;
+    }
+
+    pio_shim_stop_in_sync(mask);
+    const uint8_t stopped = pio_sm_get_pc(pio0, 0);
+    pio_shim_run(5);
+    for (unsigned core = 0; core < 4; core++) {
+        EXPECT_EQ(pio_sm_get_pc(pios[core], core), stopped);
+        EXPECT_EQ(ReadCtrl(core) & 0xF, 0u);
+    }
+}
+
+TEST_F(PioShimTests, EnableMaskInSyncStartsTogether) {
+    const uint16_t count[] = {pio_encode_nop(), pio_encode_nop(), pio_encode_nop(), pio_encode_jmp(0)};
+    const pio_program_t program = {count, 4, 0, 0};
+    ASSERT_EQ(pio_add_program(pio2, &program), 0);
+
+    pio_enable_sm_mask_in_sync(pio2, 0b0101);
+    EXPECT_EQ(ReadCtrl(2) & 0xF, 0b0101u);
+    for (int cycle = 0; cycle < 12; cycle++) {
+        pio_shim_run(1);
+        EXPECT_EQ(pio_sm_get_pc(pio2, 0), pio_sm_get_pc(pio2, 2));
+    }
+}
+
+TEST_F(PioShimTests, IrqReachesNeighbouringCoresOnTheSameCycle) {
+    constexpr uint16_t kPrev = 1u << 3, kNext = 3u << 3; // IRQ index modes
+
+    // Core 0 raises IRQ 5 on core 1 while core 1 raises its own IRQ 6. The
+    // nop soaks up the double issue after restart and the jmps park the SM.
+    const uint16_t raise_next[] = {pio_encode_nop(), pio_encode_irq_set(false, 5) | kNext, pio_encode_jmp(2), pio_encode_jmp(2)};
+    const uint16_t raise_own[] = {pio_encode_nop(), pio_encode_irq_set(false, 6), pio_encode_jmp(2), pio_encode_jmp(2)};
+    const pio_program_t next_program = {raise_next, 4, 0, 0};
+    const pio_program_t own_program = {raise_own, 4, 0, 0};
+    ASSERT_EQ(pio_add_program(pio0, &next_program), 0);
+    ASSERT_EQ(pio_add_program(pio1, &own_program), 0);
+
+    // Core 2 consumes IRQ 5 on core 1, the core before it. Both slots wait,
+    // so whichever one the stall holds on is a WAIT.
+    const uint16_t wait_prev = pio_encode_wait_irq(true, false, 5) | kPrev;
+    const uint16_t consume[] = {wait_prev, wait_prev};
+    const pio_program_t consume_program = {consume, 2, 0, 0};
+    ASSERT_EQ(pio_add_program(pio2, &consume_program), 0);
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, 0, 1);
+    pio_sm_init(pio2, 0, 0, &c);
+    pio_sm_set_enabled(pio2, 0, true);
+
+    pio_shim_start_in_sync(1u << 0 | 1u << 4);
+    bool raised = false;
+    for (int cycle = 0; cycle < 10 && !raised; cycle++) {
+        pio_shim_run(1);
+        raised = pio_interrupt_get(pio1, 5) || pio_interrupt_get(pio1, 6);
+    }
+    ASSERT_TRUE(raised);
+    EXPECT_TRUE(pio_interrupt_get(pio1, 5));
+    EXPECT_TRUE(pio_interrupt_get(pio1, 6));
+    EXPECT_FALSE(pio_interrupt_get(pio0, 5));
+
+    // IRQ_ALL shows every core's flags at once
+    chip->reg_read_addr = 0x1F4;
+    chip->eval();
+    EXPECT_EQ(chip->reg_data_out, 0x60u << 8);
+
+    // The WAIT on core 2 takes IRQ 5 the cycle it appears
+    pio_shim_run(1);
+    EXPECT_FALSE(pio_interrupt_get(pio1, 5));
+    EXPECT_TRUE(pio_interrupt_get(pio1, 6));
+
+    // The host can raise it again for the waiter, and clear the rest
+    pio_interrupt_force(pio1, 5);
+    pio_shim_run(1);
+    EXPECT_FALSE(pio_interrupt_get(pio1, 5));
+    pio_interrupt_clear(pio1, 6);
+    EXPECT_FALSE(pio_interrupt_get(pio1, 6));
+}
+
+TEST_F(PioShimTests, ShadowProgramSwapsInAtTheWrap) {
+    // Two four-instruction loops, told apart by what they SET
+    uint16_t a[4], b[4];
+    for (unsigned i = 0; i < 4; i++) {
+        a[i] = pio_encode_set(pio_x, i);
+        b[i] = pio_encode_set(pio_y, i);
+    }
+    const pio_program_t program_a = {a, 4, 0, 0};
+    const pio_program_t program_b = {b, 4, 0, 0};
+    ASSERT_EQ(pio_add_program(pio1, &program_a), 0);
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, 0, 3);
+    pio_sm_init(pio1, 2, 0, &c);
+    pio_sm_set_enabled(pio1, 2, true);
+
+    // B goes in behind A while A keeps running
+    pio_shim_load_shadow(pio1, &program_b, 0);
+    for (int cycle = 0; cycle < 6; cycle++) {
+        EXPECT_EQ(CurrentInstr(pio1, 2), a[pio_sm_get_pc(pio1, 2)]);
+        pio_shim_run(1);
+    }
+
+    // Every cycle runs one program or the other, and B starts at the top
+    // on the clock after A's last instruction
+    pio_shim_swap_at_wrap(pio1, 2);
+    bool swapped = false;
+    for (int cycle = 0; cycle < 12; cycle++) {
+        const uint8_t pc = pio_sm_get_pc(pio1, 2);
+        const uint16_t instr = CurrentInstr(pio1, 2);
+        if (!swapped && instr == b[pc]) {
+            EXPECT_EQ(pc, 0) << "cycle " << cycle;
+            swapped = true;
+        }
+        EXPECT_EQ(instr, swapped ? b[pc] : a[pc]) << "cycle " << cycle;
+        pio_shim_run(1);
+    }
+    EXPECT_TRUE(swapped);
+    EXPECT_FALSE(pio_shim_swap_pending(pio1));
+
+    // A is still there to swap back to
+    pio_shim_swap_now(pio1);
+    pio_shim_run(1);
+    EXPECT_EQ(CurrentInstr(pio1, 2), a[pio_sm_get_pc(pio1, 2)]);
+}
+
+TEST_F(PioShimTests, ProgramHandsOverWithAnIrq) {
+    // A raises IRQ 3 when it's done and parks, B loops over its SETs
+    const uint16_t a[] = {pio_encode_nop(), pio_encode_irq_set(false, 3), pio_encode_jmp(2), pio_encode_jmp(2)};
+    const uint16_t b[] = {pio_encode_set(pio_y, 0), pio_encode_set(pio_y, 1), pio_encode_set(pio_y, 2),
+        pio_encode_set(pio_y, 3)};
+    const pio_program_t program_a = {a, 4, 0, 0};
+    const pio_program_t program_b = {b, 4, 0, 0};
+    ASSERT_EQ(pio_add_program(pio3, &program_a), 0);
+    pio_shim_load_shadow(pio3, &program_b, 0);
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, 0, 3);
+    pio_sm_init(pio3, 0, 0, &c);
+
+    pio_shim_swap_on_irq(pio3, 3);
+    pio_sm_set_enabled(pio3, 0, true);
+    for (int cycle = 0; cycle < 20 && pio_shim_swap_pending(pio3); cycle++) pio_shim_run(1);
+    ASSERT_FALSE(pio_shim_swap_pending(pio3));
+
+    // The swap took the flag
+    EXPECT_FALSE(pio_interrupt_get(pio3, 3));
+    for (int cycle = 0; cycle < 8; cycle++) {
+        EXPECT_EQ(CurrentInstr(pio3, 0), b[pio_sm_get_pc(pio3, 0)]) << "cycle " << cycle;
+        pio_shim_run(1);
+    }
+}
+
+TEST_F(PioShimTests, RxFifoEntriesAsStatusRegisters) {
+    // mov rxfifo[3], isr: a running count the host can read without draining
+    const uint16_t counter[] = {pio_encode_jmp_x_dec(1), pio_encode_mov(pio_isr, pio_x), 0x801B};
+    const pio_program_t program = {counter, 3, -1, 0};
+    const uint offset = pio_add_program(pio2, &program);
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset, offset + 2);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RXPUT);
+    pio_sm_init(pio2, 1, offset, &c);
+    pio_sm_set_enabled(pio2, 1, true);
+
+    pio_shim_run(10);
+    const uint32_t first = pio_shim_rxf_putget_read(pio2, 1, 3);
+    EXPECT_NE(first, 0u);
+    pio_shim_run(30);
+    EXPECT_EQ(pio_shim_rxf_putget_read(pio2, 1, 3), first - 10);
+    EXPECT_EQ(pio_sm_get_rx_fifo_level(pio2, 1), 0u);
+}
+
+TEST_F(PioShimTests, RxFifoEntriesAsConfigRegisters) {
+    // mov osr, rxfifo[0]: spins until the host writes a non-zero entry 0
+    const uint16_t poll[] = {0x8098, pio_encode_mov(pio_x, pio_osr), pio_encode_jmp_not_x(0), pio_encode_jmp(3)};
+    const pio_program_t program = {poll, 4, 0, 0};
+    ASSERT_EQ(pio_add_program(pio2, &program), 0);
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RXGET);
+    pio_sm_init(pio2, 0, 0, &c);
+    pio_sm_set_enabled(pio2, 0, true);
+
+    pio_shim_run(12);
+    EXPECT_LT(pio_sm_get_pc(pio2, 0), 3u);
+    pio_shim_rxf_putget_write(pio2, 0, 0, 1);
+    pio_shim_run(6);
+    EXPECT_EQ(pio_sm_get_pc(pio2, 0), 3u);
+
+    // Without a join mode the registers aren't there
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_NONE);
+    pio_sm_set_config(pio2, 0, &c);
+    EXPECT_EQ(pio_shim_rxf_putget_read(pio2, 0, 0), 0u);
+}
+
+TEST_F(PioShimTests, ClaimsStateMachines) {
+    pio_sm_claim(pio0, 0);
+    EXPECT_TRUE(pio_sm_is_claimed(pio0, 0));
+    EXPECT_EQ(pio_claim_unused_sm(pio0, true), 1);
+    pio_sm_unclaim(pio0, 0);
+    EXPECT_EQ(pio_claim_unused_sm(pio0, false), 0);
+    EXPECT_EQ(pio_claim_unused_sm(pio0, false), 2);
+    EXPECT_EQ(pio_claim_unused_sm(pio0, false), 3);
+    EXPECT_EQ(pio_claim_unused_sm(pio0, false), -1);
+}
+
+TEST_F(PioShimTests, InitStartsAtInitialPc) {
+    // The entry point comes after the wrap target, like pico-examples' i2c
+    const uint16_t words[] = {pio_encode_set(pio_x, 1), pio_encode_set(pio_y, 1),
+        pio_encode_pull(false, true), pio_encode_pull(false, true)};
+    const pio_program_t program = {words, 4, 0, 0};
+    ASSERT_EQ(pio_add_program(pio1, &program), 0);
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, 0, 3);
+
+    pio_sm_init(pio1, 0, 2, &c);
+    EXPECT_EQ(pio_sm_get_pc(pio1, 0), 2u);
+    pio_sm_set_enabled(pio1, 0, true);
+    pio_shim_run(10);
+    EXPECT_EQ(pio_sm_get_pc(pio1, 0), 2u);
+
+    // Neither SET ran. Written instructions run on a stalled SM too.
+    for (const pio_src_dest reg : {pio_x, pio_y}) {
+        pio_sm_exec(pio1, 0, pio_encode_mov(pio_isr, reg));
+        pio_sm_exec(pio1, 0, pio_encode_push(false, true));
+        EXPECT_EQ(pio_sm_get_blocking(pio1, 0), 0u);
+    }
+    EXPECT_EQ(pio_sm_get_pc(pio1, 0), 2u);
+
+    // A written jump moves a running SM
+    pio_sm_exec(pio1, 0, pio_encode_jmp(3));
+    pio_shim_run(10);
+    EXPECT_EQ(pio_sm_get_pc(pio1, 0), 3u);
+}
@@ -0,0 +1,92 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "gtest/gtest.h"
+#include "pio_asm.h"
+#include "pio_disasm.h"
+#include "pio_trace.h"
+
+TEST(PioDisasm, RoundTripsThroughTheAssembler) {
+    const char *lines[] = {
+        "jmp 7", "jmp x--, 2", "jmp !osre, 31", "wait 1 gpio 4", "wait 1 irq 2 rel", "in pins, 32", "out y, 8",
+        "push iffull noblock", "pull block", "mov osr, !x", "mov isr, ::osr", "irq wait 1 rel", "irq clear 2",
+        "set pindirs, 1", "nop", "set x, 3 [7]", "wait 0 irq prev 5", "irq next 2", "irq wait prev 1",
+    };
+    for (const char *line : lines) {
+        auto parsed = pio_asm::detail::parse(line);
+        EXPECT_EQ(pio_asm::disassemble(parsed.instructions[0]), line);
+    }
+}
+
+TEST(PioDisasm, SplitsSideSetFromDelay) {
+    constexpr auto program = pio_asm::assemble<R"(
+        .side_set 1 opt
+        set pins, 1 side 1 [7]
+        nop [3]
+    )">();
+    EXPECT_EQ(pio_asm::disassemble(program.instructions[0], 1, true), "set pins, 1 side 1 [7]");
+    EXPECT_EQ(pio_asm::disassemble(program.instructions[1], 1, true), "nop [3]");
+}
+
+TEST(PioTrace, WriterAndReaderRoundTrip) {
+    const std::string path = testing::TempDir() + "pio_trace_round_trip.ptrace";
+
+    pio_trace::State a;
+    a.pc = 3;
+    a.instruction = 0x0045;
+    a.x = 10;
+    pio_trace::State b = a;
+    b.x = 9; // x-- is a one-byte delta
+    b.flags = pio_trace::kRetired;
+    pio_trace::State c = b;
+    c.osr = 0xDEADBEEF;
+    c.flags = pio_trace::kTxStall;
+
+    {
+        pio_trace::Writer writer(path, 2);
+        writer.sample(0, 0, a);
+        writer.sample(0, 1, c);
+        writer.sample(1, 0, a); // Unchanged, no record
+        writer.sample(5, 0, b);
+        writer.sample(9, 1, c); // Unchanged, but the end of trace lands on cycle 9
+    }
+
+    pio_trace::Reader reader(path);
+    EXPECT_EQ(reader.sm_count(), 2u);
+
+    pio_trace::Event event;
+    ASSERT_TRUE(reader.next(event));
+    EXPECT_EQ(event.cycle, 0u);
+    EXPECT_EQ(event.sm, 0u);
+    EXPECT_EQ(event.changed, pio_trace::kPc | pio_trace::kInstruction | pio_trace::kX);
+    EXPECT_EQ(event.state.pc, 3);
+    EXPECT_EQ(event.state.x, 10u);
+
+    ASSERT_TRUE(reader.next(event));
+    EXPECT_EQ(event.sm, 1u);
+    EXPECT_EQ(event.state.osr, 0xDEADBEEF);
+    EXPECT_EQ(event.state.flags, pio_trace::kTxStall);
+
+    ASSERT_TRUE(reader.next(event));
+    EXPECT_EQ(event.cycle, 5u);
+    EXPECT_EQ(event.sm, 0u);
+    EXPECT_EQ(event.changed, pio_trace::kFlags | pio_trace::kX);
+    EXPECT_EQ(event.state.x, 9u);
+    EXPECT_EQ(event.state.instruction, 0x0045);
+
+    EXPECT_FALSE(reader.next(event));
+    EXPECT_EQ(reader.cycle(), 9u);
+
+    std::remove(path.c_str());
+}
+
+TEST(PioTrace, UnpacksTracePortWords) {
+    const uint32_t words[4] = {0x0A004512, 1, 2, 3};
+    pio_trace::State state = pio_trace::State::from_words(words);
+    EXPECT_EQ(state.pc, 0x12);
+    EXPECT_EQ(state.instruction, 0x0045);
+    EXPECT_EQ(state.flags, pio_trace::kRetired | pio_trace::kRxStall);
+    EXPECT_EQ(state.x, 1u);
+    EXPECT_EQ(state.y, 2u);
+    EXPECT_EQ(state.osr, 3u);
+}
@@ -7,6 +7,7 @@ protected:
 
         uut->clk = 0;
         uut->rst = 0;
+        uut->restart = 0;
         uut->wrap_top = 0b00000;
         uut->wrap_bottom = 0b11111;
         uut->jump = 0;
@@ -97,6 +98,23 @@ TEST_F(ProgramCounterTests, ResetSendsProgramCounterToWrapTop) {
     }
 }
 
+TEST_F(ProgramCounterTests, RestartSendsProgramCounterToWrapTopOnTheClock) {
+    uut->pc_en = 1;
+    uut->jump_en = 1;
+    uut->jump = 0b10001;
+    uut->wrap_top = 0b00100;
+    uut->restart = 1;
+
+    // Unlike rst, nothing happens until the clock edge
+    uut->eval();
+    EXPECT_EQ(uut->pc, 0b00000);
+
+    // And it wins over a jump
+    uut->clk = 1;
+    uut->eval();
+    EXPECT_EQ(uut->pc, 0b00100);
+}
+
 TEST_F(ProgramCounterTests, JumpEnableSendsProgramCounterToJumpAddr) {
     uut->pc_en = 1;
     uut->jump_en = 1;
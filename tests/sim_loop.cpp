@@ -0,0 +1,158 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "Vpio_chip.h"
+#include "hardware/pio_instructions.h"
+#include "pio_asm.h"
+#include "pio_bus.h"
+#include "pio_trace.h"
+#include "sim_loop.h"
+
+namespace {
+
+// Drives pin 0 and counts down, then the rest of memory is blocking PULLs
+// on an empty TX FIFO, so the chip goes quiescent for the rest of the run
+constexpr auto kCountThenStall = pio_asm::assemble<R"(
+    set pindirs, 1
+    set x, 7
+loop:
+    jmp x--, loop
+    set pins, 1
+)">();
+
+struct Recording {
+    uint64_t evaluated;
+    gpio_capture::Capture capture;
+    std::vector<pio_trace::Event> events;
+    uint64_t trace_end;
+};
+
+Recording Record(bool skip, uint64_t cycles) {
+    const std::string path = testing::TempDir() + (skip ? "sim_loop_skip.ptrace" : "sim_loop_no_skip.ptrace");
+    Recording recording{};
+
+    Vpio_chip chip;
+    PioBus<Vpio_chip> bus{chip};
+    bus.reset();
+    bus.load(0, 0, kCountThenStall.instructions.data(), kCountThenStall.length());
+    for (unsigned offset = kCountThenStall.length(); offset < 32; offset++) {
+        bus.write(0, pio_regs::kInstrMem0 + 4 * offset, pio_encode_pull(false, true));
+    }
+    bus.write(0, pio_regs::kCtrl, 1u << 0 | 1u << 4);
+
+    {
+        pio_trace::Writer itrace(path, pio_trace::kMaxStateMachines);
+        sim_loop::Options options;
+        options.cycles = cycles;
+        options.skip = skip;
+        options.itrace = &itrace;
+        options.capture = &recording.capture;
+        recording.evaluated = sim_loop::run(chip, options);
+    }
+
+    pio_trace::Reader reader(path);
+    pio_trace::Event event;
+    while (reader.next(event)) recording.events.push_back(event);
+    recording.trace_end = reader.cycle();
+    std::remove(path.c_str());
+    return recording;
+}
+
+// SM 0's counters after `cycles` with all of core 0's SMs stalled on blocking
+// PULLs, through PioBus::run or sim_loop::run
+struct Counters {
+    uint32_t tx_stall, retired;
+    uint64_t skipped;
+};
+
+Counters CountStalls(bool skip, bool through_sim_loop, uint64_t cycles) {
+    Vpio_chip chip;
+    PioBus<Vpio_chip> bus{chip};
+    bus.reset();
+    for (unsigned offset = 0; offset < 32; offset++) {
+        bus.write(0, pio_regs::kInstrMem0 + 4 * offset, pio_encode_pull(false, true));
+    }
+    bus.write(0, pio_regs::kCtrl, 0xF);
+
+    uint64_t skipped = 0;
+    if (through_sim_loop) {
+        sim_loop::Options options;
+        options.cycles = cycles;
+        options.skip = skip;
+        skipped = cycles - sim_loop::run(chip, options);
+    } else if (skip) {
+        bus.run(cycles);
+        skipped = bus.skipped();
+    } else {
+        for (uint64_t i = 0; i < cycles; i++) bus.tick();
+    }
+
+    bus.snapshot_perf(0);
+    return {bus.perf(0, 0, pio_regs::kTxStall), bus.perf(0, 0, pio_regs::kRetired), skipped};
+}
+
+} // namespace
+
+TEST(SimLoop, SkippedCyclesStillCountAsStalls) {
+    constexpr uint64_t kCycles = 10'000;
+    for (bool through_sim_loop : {false, true}) {
+        const Counters full = CountStalls(false, through_sim_loop, kCycles);
+        const Counters skipped = CountStalls(true, through_sim_loop, kCycles);
+        EXPECT_EQ(full.skipped, 0u);
+        EXPECT_GT(skipped.skipped, kCycles / 2);
+        EXPECT_GT(full.tx_stall, kCycles / 2);
+        EXPECT_EQ(skipped.tx_stall, full.tx_stall) << "through_sim_loop " << through_sim_loop;
+        EXPECT_EQ(skipped.retired, full.retired) << "through_sim_loop " << through_sim_loop;
+    }
+}
+
+TEST(SimLoop, SkippingKeepsTheRecordingsTheSameLength) {
+    constexpr uint64_t kCycles = 1000;
+    const Recording full = Record(false, kCycles);
+    const Recording skipped = Record(true, kCycles);
+
+    EXPECT_EQ(full.evaluated, kCycles);
+    EXPECT_LT(skipped.evaluated, 100u);
+
+    EXPECT_EQ(full.capture.cycles(), kCycles);
+    EXPECT_EQ(skipped.capture.cycles(), kCycles);
+    ASSERT_EQ(skipped.capture.edges().size(), full.capture.edges().size());
+    EXPECT_GT(full.capture.edges().size(), 1u);
+    for (std::size_t i = 0; i < full.capture.edges().size(); i++) {
+        const gpio_capture::Edge &a = full.capture.edges()[i];
+        const gpio_capture::Edge &b = skipped.capture.edges()[i];
+        EXPECT_EQ(b.cycle, a.cycle) << "edge " << i;
+        EXPECT_EQ(b.level(), a.level()) << "edge " << i;
+        EXPECT_EQ(b.drive, a.drive) << "edge " << i;
+    }
+
+    EXPECT_EQ(full.trace_end, kCycles - 1);
+    EXPECT_EQ(skipped.trace_end, kCycles - 1);
+    ASSERT_EQ(skipped.events.size(), full.events.size());
+    for (std::size_t i = 0; i < full.events.size(); i++) {
+        const pio_trace::Event &a = full.events[i];
+        const pio_trace::Event &b = skipped.events[i];
+        EXPECT_EQ(b.cycle, a.cycle) << "record " << i;
+        EXPECT_EQ(b.sm, a.sm) << "record " << i;
+        EXPECT_EQ(b.state.pc, a.state.pc) << "record " << i;
+        EXPECT_EQ(b.state.x, a.state.x) << "record " << i;
+    }
+}
+
+TEST(SimLoop, CoverageSimulatesEveryCycle) {
+    Vpio_chip chip;
+    PioBus<Vpio_chip> bus{chip};
+    bus.reset();
+
+    // Nothing is enabled, so the chip is quiescent from the start
+    pio_coverage::Coverage coverage;
+    sim_loop::Options options;
+    options.cycles = 50;
+    options.coverage = &coverage;
+    EXPECT_EQ(sim_loop::run(chip, options), 50u);
+
+    options.coverage = nullptr;
+    EXPECT_LT(sim_loop::run(chip, options), 50u);
+}